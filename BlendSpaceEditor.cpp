@@ -1,5 +1,8 @@
 ﻿#pragma comment(linker, "/SUBSYSTEM:windows /ENTRY:mainCRTStartup")
 #include "BlendSpaceEditor/Main.h"
+#include "BlendSpaceEditor/FrameScheduler.h"
+#include "BlendSpaceEditor/Profiler.h"
+#include "BlendSpaceEditor/AllocTracker.h"
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
 #include "imgui_impl_win32.h"
@@ -12,6 +15,7 @@
 #include <GL/wglext.h>
 #include <tchar.h>
 #include <thread>
+#include <cmath>
 
 // Data stored per platform window
 struct WGL_WindowData { HDC hDC; };
@@ -27,6 +31,7 @@ HWND             g_MainHWND;
 bool CreateDeviceWGL(HWND hWnd, WGL_WindowData* data);
 void CleanupDeviceWGL(HWND hWnd, WGL_WindowData* data);
 void ResetDeviceWGL();
+ImTextureID UpdateTextureWGL(ImTextureID texture, const void* pixels, int width, int height);
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 // Main code
@@ -62,61 +67,84 @@ int main(int argc, char** argv)
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+#ifdef BLENDGRAPH_TRACK_ALLOCATIONS
+    ImGui::SetAllocatorFunctions(AllocTracker::ImGuiAlloc, AllocTracker::ImGuiFree);
+#endif
     ImGui::CreateContext();
     ImGui_ImplWin32_InitForOpenGL(g_MainHWND);
     ImGui_ImplOpenGL3_Init();
 
     ImGuiIO& io = ImGui::GetIO();
     ImVec4 clear_color{ 0.0f, 0.0f, 0.0f, 1.0f };
+    Main::updateTexture = UpdateTextureWGL;
     Main::OnStart(io);
 
+    FrameScheduler::SteadyClock frameClock;
+    FrameScheduler frameScheduler{ frameClock };
+
     // Main loop
     bool done = false;
     while (!done)
     {
+        // Block until a message arrives or the scheduler wants another frame, so an idle editor doesn't redraw.
+        double waitTimeout = frameScheduler.GetWaitTimeout();
+        if (waitTimeout != 0.0)
+        {
+            DWORD waitMs = waitTimeout < 0.0 ? INFINITE : static_cast<DWORD>(std::ceil(waitTimeout * 1000.0));
+            ::MsgWaitForMultipleObjects(0, nullptr, FALSE, waitMs, QS_ALLINPUT);
+        }
+
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
-        MSG msg;
-        while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
         {
-            ::TranslateMessage(&msg);
-            ::DispatchMessage(&msg);
-            if (msg.message == WM_QUIT)
-                done = true;
+            TRACE_SCOPE("PumpMessages");
+            MSG msg;
+            while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
+            {
+                ::TranslateMessage(&msg);
+                ::DispatchMessage(&msg);
+                frameScheduler.NotifyActivity();
+                if (msg.message == WM_QUIT)
+                    done = true;
+            }
         }
         if (done)
             break;
         if (::IsIconic(g_MainHWND))
         {
-            ::Sleep(10);
+            ::WaitMessage();
             continue;
         }
-        if (::GetFocus() != g_MainHWND)
+        if (!frameScheduler.ShouldRender())
+            continue;
+
         {
-            ::Sleep(20);
-        }
+            PROFILE_SCOPE("Frame");
 
-        // Start the Dear ImGui frame
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplWin32_NewFrame();
+            // Start the Dear ImGui frame
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplWin32_NewFrame();
 
-        ImGui::NewFrame();
-        Main::OnFrame(io);
-        ImGui::EndFrame();
+            ImGui::NewFrame();
+            Main::OnFrame(io);
+            ImGui::EndFrame();
 
-        // Rendering
-        ImGui::Render();
-        //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glViewport(0, 0, g_Width, g_Height);
-        glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
-        glClear(GL_COLOR_BUFFER_BIT);
+            // Rendering
+            ImGui::Render();
+            //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glViewport(0, 0, g_Width, g_Height);
+            glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+            glClear(GL_COLOR_BUFFER_BIT);
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glFinish();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-        // Present
-        ::SwapBuffers(g_MainWindow.hDC);
+            // Present
+            ::SwapBuffers(g_MainWindow.hDC);
+        }
+        PROFILE_FRAME();
+        frameScheduler.OnFrameRendered();
+        frameScheduler.SetContinuous(Main::HasPendingWork());
     }
 
     Main::OnStop(io);
@@ -163,6 +191,30 @@ void CleanupDeviceWGL(HWND hWnd, WGL_WindowData* data)
     ::ReleaseDC(hWnd, data->hDC);
 }
 
+ImTextureID UpdateTextureWGL(ImTextureID texture, const void* pixels, int width, int height)
+{
+    GLuint textureId = static_cast<GLuint>(reinterpret_cast<intptr_t>(texture));
+    if (!pixels)
+    {
+        if (textureId)
+            glDeleteTextures(1, &textureId);
+        return nullptr;
+    }
+
+    if (!textureId)
+    {
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    return reinterpret_cast<ImTextureID>(static_cast<intptr_t>(textureId));
+}
+
 // Forward declare message handler from imgui_impl_win32.cpp
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
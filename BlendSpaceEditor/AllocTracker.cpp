@@ -0,0 +1,304 @@
+#include "AllocTracker.h"
+#ifdef BLENDGRAPH_TRACK_ALLOCATIONS
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <DbgHelp.h>
+#pragma comment(lib, "dbghelp.lib")
+#else
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+#include <cstdio>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ALLOC_TRACKER_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define ALLOC_TRACKER_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace
+{
+    constexpr int kStackDepth = 6;
+    constexpr size_t kCallSiteCapacity = 4096;
+
+    struct CallSiteSlot
+    {
+        uint64_t hash = 0;
+        void* frames[kStackDepth] = {};
+        int frameCount = 0;
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    std::atomic<uint64_t> g_Count{ 0 };
+    std::atomic<uint64_t> g_Bytes{ 0 };
+    thread_local uint64_t t_Count = 0;
+    thread_local uint64_t t_Bytes = 0;
+    // Set while this thread is inside the tracker, so allocations made by stack capture aren't recorded.
+    thread_local bool t_InTracker = false;
+
+    std::atomic<bool> g_TrackCallSites{ false };
+    std::mutex g_CallSitesMutex;
+    // Fixed open-addressing table, so recording a call site never allocates.
+    CallSiteSlot g_CallSites[kCallSiteCapacity];
+
+    // Captures the stack starting at caller, the return address of operator new, so the tracker's own
+    // frames are dropped however the compiler inlined them.
+    int CaptureStack(void* caller, void** frames)
+    {
+        constexpr int kMaxFrames = kStackDepth + 8;
+        void* buffer[kMaxFrames];
+#ifdef _WIN32
+        int count = RtlCaptureStackBackTrace(0, kMaxFrames, buffer, nullptr);
+#else
+        int count = backtrace(buffer, kMaxFrames);
+#endif
+        auto first = std::find(buffer, buffer + count, caller);
+        if (first == buffer + count) {
+            frames[0] = caller;
+            return 1;
+        }
+
+        int frameCount = std::min(static_cast<int>(buffer + count - first), kStackDepth);
+        std::copy_n(first, frameCount, frames);
+        return frameCount;
+    }
+
+    void RecordCallSite(void* caller, size_t size)
+    {
+        t_InTracker = true;
+        void* frames[kStackDepth];
+        int frameCount = CaptureStack(caller, frames);
+
+        uint64_t hash = 14695981039346656037ull;
+        for (int i = 0; i < frameCount; i++)
+            hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+        hash |= 1;
+
+        std::lock_guard lock{ g_CallSitesMutex };
+        for (size_t probe = 0; probe < kCallSiteCapacity; probe++) {
+            auto& slot = g_CallSites[(hash + probe) & (kCallSiteCapacity - 1)];
+            if (slot.hash == 0) {
+                slot.hash = hash;
+                slot.frameCount = frameCount;
+                std::copy_n(frames, frameCount, slot.frames);
+            }
+            if (slot.hash == hash) {
+                slot.count++;
+                slot.bytes += size;
+                break;
+            }
+        }
+        t_InTracker = false;
+    }
+
+    std::string Symbolize(void* address)
+    {
+#ifdef _WIN32
+        static bool initialized = SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+        alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+        auto symbol = reinterpret_cast<SYMBOL_INFO*>(buffer);
+        symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen = MAX_SYM_NAME;
+        if (initialized && SymFromAddr(GetCurrentProcess(), reinterpret_cast<DWORD64>(address), nullptr, symbol))
+            return symbol->Name;
+#else
+        Dl_info info{};
+        if (dladdr(address, &info) && info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+            std::free(demangled);
+            return name;
+        }
+#endif
+        char text[32];
+        std::snprintf(text, sizeof(text), "%p", address);
+        return text;
+    }
+}
+
+namespace
+{
+    void Count(size_t size, void* caller)
+    {
+        g_Count.fetch_add(1, std::memory_order_relaxed);
+        g_Bytes.fetch_add(size, std::memory_order_relaxed);
+        t_Count++;
+        t_Bytes += size;
+        if (g_TrackCallSites.load(std::memory_order_relaxed) && !t_InTracker)
+            RecordCallSite(caller, size);
+    }
+
+    void* Allocate(size_t size, void* caller)
+    {
+        Count(size, caller);
+        if (void* ptr = std::malloc(size ? size : 1))
+            return ptr;
+
+        throw std::bad_alloc{};
+    }
+
+    // The over-aligned forms, which std::pmr::new_delete_resource uses for every allocation.
+    void* AllocateAligned(size_t size, std::align_val_t alignment, void* caller)
+    {
+        Count(size, caller);
+        auto align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+        void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+        void* ptr = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+#endif
+        if (ptr)
+            return ptr;
+
+        throw std::bad_alloc{};
+    }
+
+    void FreeAligned(void* ptr)
+    {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+void* operator new(size_t size)
+{
+    return Allocate(size, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+void* operator new[](size_t size)
+{
+    return Allocate(size, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return AllocateAligned(size, alignment, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return AllocateAligned(size, alignment, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(ptr);
+}
+
+namespace AllocTracker
+{
+    Totals GetTotals()
+    {
+        return { g_Count.load(std::memory_order_relaxed), g_Bytes.load(std::memory_order_relaxed) };
+    }
+
+    Totals GetThreadTotals()
+    {
+        return { t_Count, t_Bytes };
+    }
+
+    void SetCallSiteTracking(bool enabled)
+    {
+        g_TrackCallSites.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsCallSiteTracking()
+    {
+        return g_TrackCallSites.load(std::memory_order_relaxed);
+    }
+
+    void ResetCallSites()
+    {
+        std::lock_guard lock{ g_CallSitesMutex };
+        std::fill(std::begin(g_CallSites), std::end(g_CallSites), CallSiteSlot{});
+    }
+
+    std::vector<CallSite> GetCallSites(size_t maxCount)
+    {
+        t_InTracker = true;
+        std::vector<CallSiteSlot> slots;
+        {
+            std::lock_guard lock{ g_CallSitesMutex };
+            for (auto& slot : g_CallSites) {
+                if (slot.hash != 0)
+                    slots.push_back(slot);
+            }
+        }
+
+        std::sort(slots.begin(), slots.end(), [](const CallSiteSlot& a, const CallSiteSlot& b) { return a.count > b.count; });
+        slots.resize(std::min(slots.size(), maxCount));
+
+        std::vector<CallSite> result;
+        for (auto& slot : slots) {
+            auto& site = result.emplace_back();
+            site.count = slot.count;
+            site.bytes = slot.bytes;
+            for (int i = 0; i < slot.frameCount; i++) {
+                if (i > 0)
+                    site.stack += " <- ";
+                site.stack += Symbolize(slot.frames[i]);
+            }
+        }
+        t_InTracker = false;
+        return result;
+    }
+
+    void* ImGuiAlloc(size_t size, void*)
+    {
+        return Allocate(size, ALLOC_TRACKER_RETURN_ADDRESS());
+    }
+
+    void ImGuiFree(void* ptr, void*)
+    {
+        std::free(ptr);
+    }
+}
+#endif
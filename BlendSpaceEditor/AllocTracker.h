@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Replaces the global operator new/delete to count heap allocations, optionally bucketed by call stack.
+// Only compiled in when BLENDGRAPH_TRACK_ALLOCATIONS is defined; callers guard their use with the same macro.
+namespace AllocTracker
+{
+    struct Totals
+    {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    struct CallSite
+    {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+        // Symbolized frames, innermost first, separated by " <- ".
+        std::string stack;
+    };
+
+    // Allocations made by all threads since startup.
+    Totals GetTotals();
+    // Allocations made by the calling thread since startup.
+    Totals GetThreadTotals();
+
+    // Capturing stacks is slow, so the call site histogram is off until enabled.
+    void SetCallSiteTracking(bool enabled);
+    bool IsCallSiteTracking();
+    void ResetCallSites();
+    // The busiest call sites by allocation count.
+    std::vector<CallSite> GetCallSites(size_t maxCount);
+
+    // For ImGui::SetAllocatorFunctions, so ImGui and node editor buffers are counted as well.
+    void* ImGuiAlloc(size_t size, void* userData);
+    void ImGuiFree(void* ptr, void* userData);
+}
@@ -0,0 +1,147 @@
+#include "AsyncGraphLoad.h"
+#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#undef min
+
+namespace
+{
+    constexpr size_t kReadBlockSize = 1 << 20;
+
+    // Share of the progress bar given to each stage.
+    constexpr float kReadingWeight = 0.2f;
+    constexpr float kParsingWeight = 0.4f;
+}
+
+AsyncGraphLoad::AsyncGraphLoad(std::filesystem::path path) : m_Path(std::move(path))
+{
+    m_Thread = std::thread(&AsyncGraphLoad::Run, this);
+}
+
+AsyncGraphLoad::~AsyncGraphLoad()
+{
+    Cancel();
+    m_Thread.join();
+}
+
+void AsyncGraphLoad::Cancel()
+{
+    m_Status.cancelRequested = true;
+}
+
+bool AsyncGraphLoad::IsDone() const
+{
+    return m_Stage.load(std::memory_order_acquire) == Stage::Done;
+}
+
+AsyncGraphLoad::Stage AsyncGraphLoad::GetStage() const
+{
+    return m_Stage.load(std::memory_order_acquire);
+}
+
+float AsyncGraphLoad::GetProgress() const
+{
+    switch (GetStage()) {
+    case Stage::Reading:
+    {
+        auto fileSize = m_FileSize.load(std::memory_order_relaxed);
+        return fileSize ? kReadingWeight * m_BytesRead.load(std::memory_order_relaxed) / fileSize : 0.0f;
+    }
+    case Stage::Parsing:
+        return kReadingWeight;
+    case Stage::Building:
+    {
+        auto nodeCount = m_Status.nodeCount.load(std::memory_order_relaxed);
+        float built = nodeCount ? static_cast<float>(m_Status.nodesParsed.load(std::memory_order_relaxed)) / nodeCount : 0.0f;
+        return kReadingWeight + kParsingWeight + (1.0f - kReadingWeight - kParsingWeight) * built;
+    }
+    default:
+        return 1.0f;
+    }
+}
+
+const std::filesystem::path& AsyncGraphLoad::GetPath() const
+{
+    return m_Path;
+}
+
+bool AsyncGraphLoad::WasCancelled() const
+{
+    return m_Cancelled;
+}
+
+const std::string& AsyncGraphLoad::GetError() const
+{
+    return m_Error;
+}
+
+GraphFile::Graph& AsyncGraphLoad::GetGraph()
+{
+    return m_Graph;
+}
+
+void AsyncGraphLoad::Run()
+{
+    Trace::SetThreadName("Loader");
+    TRACE_SCOPE("AsyncGraphLoad");
+
+    try {
+        std::string text;
+        {
+            TRACE_SCOPE("ReadFile");
+            std::ifstream inFile{ m_Path, std::ios::binary };
+            if (!inFile.is_open() || !inFile.good()) {
+                m_Error = "Failed to open file.";
+                m_Stage.store(Stage::Done, std::memory_order_release);
+                return;
+            }
+
+            inFile.seekg(0, std::ios::end);
+            auto fileSize = static_cast<uint64_t>(std::max<std::streamoff>(inFile.tellg(), 0));
+            inFile.seekg(0, std::ios::beg);
+            m_FileSize = fileSize;
+            text.resize(fileSize);
+
+            // Read in blocks so the progress bar moves and cancelling is quick on slow drives.
+            uint64_t offset = 0;
+            while (offset < fileSize && inFile) {
+                if (m_Status.cancelRequested)
+                    throw GraphFile::ParseCancelled{};
+
+                auto blockSize = std::min<uint64_t>(kReadBlockSize, fileSize - offset);
+                inFile.read(text.data() + offset, blockSize);
+                offset += inFile.gcount();
+                m_BytesRead = offset;
+            }
+            text.resize(offset);
+        }
+
+        m_Stage.store(Stage::Parsing, std::memory_order_release);
+        nlohmann::json obj;
+        try {
+            TRACE_SCOPE("ParseJson");
+            obj = nlohmann::json::parse(text);
+        }
+        catch (const std::exception& ex) {
+            m_Error = std::string{ "Failed to parse blend graph file. Error: " } + ex.what();
+            m_Stage.store(Stage::Done, std::memory_order_release);
+            return;
+        }
+        std::string{}.swap(text);
+
+        if (m_Status.cancelRequested)
+            throw GraphFile::ParseCancelled{};
+
+        m_Stage.store(Stage::Building, std::memory_order_release);
+        TRACE_SCOPE("BuildGraph");
+        GraphFile::Parse(obj, m_Graph, 0, &m_Status);
+    }
+    catch (const GraphFile::ParseCancelled&) {
+        m_Cancelled = true;
+    }
+    catch (const std::exception& ex) {
+        m_Error = std::string{ "Failed to load blend graph file. Error: " } + ex.what();
+    }
+
+    m_Stage.store(Stage::Done, std::memory_order_release);
+}
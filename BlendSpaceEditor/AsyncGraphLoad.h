@@ -0,0 +1,53 @@
+#pragma once
+#include "GraphFile.h"
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+// Reads, parses and builds a .bt file on a worker thread into a detached GraphFile::Graph, which the
+// UI thread hands to the editor with GraphFile::Apply once the load is done.
+class AsyncGraphLoad
+{
+public:
+    enum class Stage
+    {
+        Reading,
+        Parsing,
+        Building,
+        Done
+    };
+
+    explicit AsyncGraphLoad(std::filesystem::path path);
+    // Cancels and waits for the worker.
+    ~AsyncGraphLoad();
+
+    AsyncGraphLoad(const AsyncGraphLoad&) = delete;
+    AsyncGraphLoad& operator=(const AsyncGraphLoad&) = delete;
+
+    void Cancel();
+    bool IsDone() const;
+    Stage GetStage() const;
+    // Overall completion between 0 and 1.
+    float GetProgress() const;
+    const std::filesystem::path& GetPath() const;
+
+    // The following are only valid once IsDone().
+    bool WasCancelled() const;
+    // Empty when the load succeeded.
+    const std::string& GetError() const;
+    GraphFile::Graph& GetGraph();
+
+private:
+    void Run();
+
+    std::filesystem::path m_Path;
+    GraphFile::ParseStatus m_Status;
+    std::atomic<Stage> m_Stage{ Stage::Reading };
+    std::atomic<uint64_t> m_BytesRead{ 0 };
+    std::atomic<uint64_t> m_FileSize{ 0 };
+    bool m_Cancelled = false;
+    std::string m_Error;
+    GraphFile::Graph m_Graph;
+    std::thread m_Thread;
+};
@@ -0,0 +1,102 @@
+#include "AsyncGraphSaver.h"
+#include "FileUtil.h"
+#include "GraphHash.h"
+#include "Trace.h"
+
+AsyncGraphSaver::AsyncGraphSaver()
+{
+    m_Thread = std::thread(&AsyncGraphSaver::Run, this);
+}
+
+AsyncGraphSaver::~AsyncGraphSaver()
+{
+    {
+        std::lock_guard lock{ m_Mutex };
+        m_Stopping = true;
+    }
+    m_Wake.notify_one();
+    m_Thread.join();
+}
+
+void AsyncGraphSaver::Submit(std::filesystem::path path, GraphFile::Graph&& graph, uint64_t revision, bool deduplicate)
+{
+    {
+        std::lock_guard lock{ m_Mutex };
+        // Only a request of the same kind is superseded, so a save's result is never lost to an export and
+        // the other way round. The newer one goes to the back, so the file ends up with what was submitted last.
+        std::erase_if(m_Pending, [&](const Request& pending) { return pending.path == path && pending.deduplicate == deduplicate; });
+        m_Pending.push_back({ std::move(path), std::move(graph), revision, deduplicate });
+    }
+    m_Wake.notify_one();
+}
+
+bool AsyncGraphSaver::IsBusy() const
+{
+    std::lock_guard lock{ m_Mutex };
+    return m_Writing || !m_Pending.empty();
+}
+
+void AsyncGraphSaver::Finish()
+{
+    std::unique_lock lock{ m_Mutex };
+    m_Idle.wait(lock, [this] { return !m_Writing && m_Pending.empty(); });
+}
+
+std::vector<AsyncGraphSaver::Result> AsyncGraphSaver::TakeResults()
+{
+    std::lock_guard lock{ m_Mutex };
+    return std::move(m_Results);
+}
+
+void AsyncGraphSaver::Run()
+{
+    Trace::SetThreadName("Saver");
+
+    std::unique_lock lock{ m_Mutex };
+    while (true) {
+        m_Wake.wait(lock, [this] { return m_Stopping || !m_Pending.empty(); });
+        if (m_Pending.empty())
+            return;
+
+        Request request = std::move(m_Pending.front());
+        m_Pending.pop_front();
+        m_Writing = true;
+        lock.unlock();
+
+        Result result{ request.path, {}, request.deduplicate, 0, request.revision };
+        {
+            TRACE_SCOPE("AsyncGraphSave");
+            try {
+                if (request.deduplicate) {
+                    TRACE_SCOPE("DeduplicateGraph");
+                    result.mergedNodes = GraphHash::Deduplicate(request.graph);
+                }
+
+                nlohmann::json obj;
+                {
+                    TRACE_SCOPE("SerializeGraph");
+                    GraphFile::Serialize(request.graph, obj);
+                }
+
+                std::string text;
+                {
+                    TRACE_SCOPE("DumpJson");
+                    text = obj.dump();
+                }
+
+                TRACE_SCOPE("WriteFile");
+                if (!FileUtil_WriteAtomic(request.path, text, &result.error))
+                    result.error = "Failed to save file. " + result.error;
+            }
+            catch (const std::exception& ex) {
+                result.error = std::string{ "Failed to save file. Error: " } + ex.what();
+            }
+        }
+
+        lock.lock();
+        m_Writing = false;
+        m_Results.push_back(std::move(result));
+        if (m_Pending.empty())
+            m_Idle.notify_all();
+    }
+}
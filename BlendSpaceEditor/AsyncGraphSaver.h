@@ -0,0 +1,64 @@
+#pragma once
+#include "GraphFile.h"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Serializes and writes graph snapshots on a worker thread, replacing the target file atomically. A
+// snapshot submitted while another of the same kind (a save or a deduplicated export) for the same file is
+// still waiting replaces it, so repeated saves never queue up; the rest are written in the order they were
+// submitted.
+class AsyncGraphSaver
+{
+public:
+    struct Result
+    {
+        std::filesystem::path path;
+        // Empty when the save succeeded.
+        std::string error;
+        bool deduplicated = false;
+        // How many nodes deduplicating merged away.
+        size_t mergedNodes = 0;
+        // As passed to Submit, so the caller can tell which snapshot was written.
+        uint64_t revision = 0;
+    };
+
+    AsyncGraphSaver();
+    // Finishes the pending save, if any, before returning.
+    ~AsyncGraphSaver();
+
+    AsyncGraphSaver(const AsyncGraphSaver&) = delete;
+    AsyncGraphSaver& operator=(const AsyncGraphSaver&) = delete;
+
+    // With deduplicate, identical sub-trees are merged (see GraphHash::Deduplicate) before writing.
+    void Submit(std::filesystem::path path, GraphFile::Graph&& graph, uint64_t revision, bool deduplicate = false);
+    bool IsBusy() const;
+    // Waits until every submitted snapshot has been written, so its result is ready to take.
+    void Finish();
+    // Takes the outcome of finished saves, oldest first.
+    std::vector<Result> TakeResults();
+
+private:
+    struct Request
+    {
+        std::filesystem::path path;
+        GraphFile::Graph graph;
+        uint64_t revision = 0;
+        bool deduplicate = false;
+    };
+
+    void Run();
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Idle;
+    std::deque<Request> m_Pending;
+    bool m_Writing = false;
+    bool m_Stopping = false;
+    std::vector<Result> m_Results;
+    std::thread m_Thread;
+};
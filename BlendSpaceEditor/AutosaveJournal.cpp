@@ -0,0 +1,759 @@
+#include "AutosaveJournal.h"
+#include "FileUtil.h"
+#include "Profiler.h"
+#include "StringPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t kMagic = 0x4A414742; // "BGAJ"
+    constexpr uint32_t kVersion = 1;
+
+    // Untitled documents are journaled in the temp directory, named after the process so instances don't share one.
+    constexpr std::string_view kUntitledPrefix = "BlendGraphEditor Untitled ";
+    constexpr std::string_view kUntitledSuffix = ".bt.autosave";
+
+    // Checkpoint after this many changes, or after kCheckpointInterval with any change at all.
+    constexpr size_t kCheckpointChanges = 20000;
+    constexpr auto kCheckpointInterval = std::chrono::minutes(5);
+
+    // Records are [type:u8][size:u32][payload][checksum:u32], little-endian. A checkpoint record is followed
+    // by one SpawnNode record per node and one SpawnLink record per link, which together form the snapshot.
+    enum class RecordType : uint8_t
+    {
+        Checkpoint = 1,
+        SpawnNode,
+        DestroyNode,
+        SpawnLink,
+        DestroyLink,
+        SetValue,
+        MoveNodes,
+        Saved,
+        Unsaved
+    };
+
+    constexpr size_t kRecordOverhead = sizeof(uint8_t) + sizeof(uint32_t) * 2;
+
+    uint32_t Checksum(const uint8_t* data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ data[i]) * 16777619u;
+        return hash;
+    }
+
+    class RecordWriter
+    {
+    public:
+        RecordWriter(std::vector<uint8_t>& out, RecordType type) : m_Out(out), m_Start(out.size())
+        {
+            Write(static_cast<uint8_t>(type));
+            Write(uint32_t{ 0 });
+        }
+
+        ~RecordWriter()
+        {
+            auto payloadSize = static_cast<uint32_t>(m_Out.size() - m_Start - sizeof(uint8_t) - sizeof(uint32_t));
+            std::memcpy(m_Out.data() + m_Start + sizeof(uint8_t), &payloadSize, sizeof(payloadSize));
+            Write(Checksum(m_Out.data() + m_Start, m_Out.size() - m_Start));
+        }
+
+        template<typename T>
+        void Write(T value)
+        {
+            auto offset = m_Out.size();
+            m_Out.resize(offset + sizeof(T));
+            std::memcpy(m_Out.data() + offset, &value, sizeof(T));
+        }
+
+        void WriteString(std::string_view value)
+        {
+            Write(static_cast<uint32_t>(value.size()));
+            m_Out.insert(m_Out.end(), value.begin(), value.end());
+        }
+
+    private:
+        std::vector<uint8_t>& m_Out;
+        size_t m_Start;
+    };
+
+    class RecordReader
+    {
+    public:
+        RecordReader(const uint8_t* data, size_t size) : m_Cur(data), m_End(data + size) {}
+
+        template<typename T>
+        T Read()
+        {
+            T value{};
+            if (static_cast<size_t>(m_End - m_Cur) < sizeof(T)) {
+                m_Ok = false;
+                return value;
+            }
+            std::memcpy(&value, m_Cur, sizeof(T));
+            m_Cur += sizeof(T);
+            return value;
+        }
+
+        std::string_view ReadString()
+        {
+            auto size = Read<uint32_t>();
+            if (static_cast<size_t>(m_End - m_Cur) < size) {
+                m_Ok = false;
+                return {};
+            }
+            std::string_view value{ reinterpret_cast<const char*>(m_Cur), size };
+            m_Cur += size;
+            return value;
+        }
+
+        bool Ok() const { return m_Ok; }
+
+    private:
+        const uint8_t* m_Cur;
+        const uint8_t* m_End;
+        bool m_Ok = true;
+    };
+
+    struct Record
+    {
+        RecordType type;
+        RecordReader payload;
+    };
+
+    // Splits a journal into records, stopping at the first one that is incomplete or fails its checksum.
+    class RecordIterator
+    {
+    public:
+        explicit RecordIterator(const std::string& data) : m_Data(reinterpret_cast<const uint8_t*>(data.data())), m_Size(data.size()) {}
+
+        bool ReadHeader()
+        {
+            RecordReader header{ m_Data, m_Size };
+            if (header.Read<uint32_t>() != kMagic || header.Read<uint32_t>() != kVersion || !header.Ok())
+                return false;
+
+            m_Offset = sizeof(uint32_t) * 2;
+            return true;
+        }
+
+        std::optional<Record> Next()
+        {
+            if (m_Size - m_Offset < kRecordOverhead)
+                return std::nullopt;
+
+            auto start = m_Data + m_Offset;
+            uint32_t payloadSize;
+            std::memcpy(&payloadSize, start + sizeof(uint8_t), sizeof(payloadSize));
+            if (m_Size - m_Offset - kRecordOverhead < payloadSize)
+                return std::nullopt;
+
+            auto checkedSize = sizeof(uint8_t) + sizeof(uint32_t) + payloadSize;
+            uint32_t checksum;
+            std::memcpy(&checksum, start + checkedSize, sizeof(checksum));
+            if (checksum != Checksum(start, checkedSize))
+                return std::nullopt;
+
+            m_Offset += kRecordOverhead + payloadSize;
+            return Record{ static_cast<RecordType>(start[0]), RecordReader{ start + sizeof(uint8_t) + sizeof(uint32_t), payloadSize } };
+        }
+
+        // How many bytes are left to read, which bounds how many records can follow.
+        size_t GetRemaining() const
+        {
+            return m_Size - m_Offset;
+        }
+
+    private:
+        const uint8_t* m_Data;
+        size_t m_Size;
+        size_t m_Offset = 0;
+    };
+
+    void WriteHeader(std::vector<uint8_t>& out)
+    {
+        out.resize(sizeof(uint32_t) * 2);
+        std::memcpy(out.data(), &kMagic, sizeof(kMagic));
+        std::memcpy(out.data() + sizeof(kMagic), &kVersion, sizeof(kVersion));
+    }
+
+    void WriteNode(std::vector<uint8_t>& out, const Node& node, const ImVec2& position)
+    {
+        RecordWriter record{ out, RecordType::SpawnNode };
+        record.WriteString(node.def->typeName);
+        record.Write(position.x);
+        record.Write(position.y);
+        record.Write(static_cast<uint32_t>(1 + node.inputs.size() + node.outputs.size()));
+        record.Write(static_cast<uint32_t>(node.id.Get()));
+        for (auto& pin : node.inputs)
+            record.Write(static_cast<uint32_t>(pin.id.Get()));
+        for (auto& pin : node.outputs)
+            record.Write(static_cast<uint32_t>(pin.id.Get()));
+
+        for (auto& pin : node.inputs) {
+            switch (pin.type) {
+            case PinType::CustomInt: record.Write(static_cast<int32_t>(std::get<NodeIntCustomValueConnection>(pin.connected).value)); break;
+            case PinType::CustomFloat: record.Write(std::get<NodeFloatCustomValueConnection>(pin.connected).value); break;
+            case PinType::CustomString: record.WriteString(std::get<NodeStringCustomValueConnection>(pin.connected).value); break;
+            default: break;
+            }
+        }
+    }
+
+    void WriteLink(std::vector<uint8_t>& out, const Link& link)
+    {
+        RecordWriter record{ out, RecordType::SpawnLink };
+        record.Write(static_cast<uint32_t>(link.id.Get()));
+        record.Write(static_cast<uint32_t>(link.startPinID.Get()));
+        record.Write(static_cast<uint32_t>(link.endPinID.Get()));
+    }
+
+    bool ReadNode(RecordReader& payload, Node& node, ImVec2& position)
+    {
+        auto typeName = payload.ReadString();
+        position.x = payload.Read<float>();
+        position.y = payload.Read<float>();
+        auto idCount = payload.Read<uint32_t>();
+
+        auto def = NodeDefinitions::FindDef(typeName);
+
+        if (!payload.Ok() || !def || idCount != 1 + def->inputs.size() + def->outputs.size())
+            return false;
+
+        bool validIds = true;
+        def->CopyToNode([&]() -> int {
+            auto id = payload.Read<uint32_t>();
+            validIds = validIds && id != 0 && id <= INT32_MAX;
+            return static_cast<int>(id);
+        }, node);
+        node.Build();
+
+        for (auto& pin : node.inputs) {
+            switch (pin.type) {
+            case PinType::CustomInt: std::get<NodeIntCustomValueConnection>(pin.connected).value = payload.Read<int32_t>(); break;
+            case PinType::CustomFloat: std::get<NodeFloatCustomValueConnection>(pin.connected).value = payload.Read<float>(); break;
+            case PinType::CustomString: std::get<NodeStringCustomValueConnection>(pin.connected).value = StringPool::Get().Intern(payload.ReadString()); break;
+            default: break;
+            }
+        }
+
+        return payload.Ok() && validIds;
+    }
+
+    // Connects two pins of a graph that isn't in an editor yet, the way Editor::SpawnLink does.
+    void ConnectPins(Pin& startPin, Pin& endPin)
+    {
+        std::get<NodeOutputConnection>(startPin.connected).ids.emplace_back(endPin.id);
+        auto& inputCon = std::get<NodeInputConnection>(endPin.connected);
+        inputCon.id = startPin.id;
+        inputCon.nodeId = startPin.node;
+        inputCon.typeName = startPin.def->typeName.data();
+    }
+
+    bool ReadFile(const std::filesystem::path& path, std::string& data)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        if (!file.is_open())
+            return false;
+
+        file.seekg(0, std::ios::end);
+        data.resize(static_cast<size_t>(std::max<std::streamoff>(file.tellg(), 0)));
+        file.seekg(0, std::ios::beg);
+        file.read(data.data(), data.size());
+        data.resize(file.gcount());
+        return true;
+    }
+
+    bool ChangesGraph(RecordType type)
+    {
+        return type != RecordType::Checkpoint && type != RecordType::Saved && type != RecordType::Unsaved;
+    }
+}
+
+AutosaveJournal::AutosaveJournal(Editor& editor) : m_Editor(editor)
+{
+    m_Editor.AddListener(this);
+    m_Thread = std::thread(&AutosaveJournal::Run, this);
+}
+
+AutosaveJournal::~AutosaveJournal()
+{
+    m_Editor.RemoveListener(this);
+    if (!m_Path.empty() && !m_Records.empty())
+        Submit({ Job::Kind::Append, {}, std::nullopt, false, std::move(m_Records) });
+
+    {
+        std::lock_guard lock{ m_Mutex };
+        m_Stopping = true;
+    }
+    m_Wake.notify_one();
+    m_Thread.join();
+}
+
+std::filesystem::path AutosaveJournal::GetJournalPath(const std::filesystem::path& documentPath)
+{
+    if (documentPath.empty())
+        return std::filesystem::temp_directory_path() / (std::string{ kUntitledPrefix } + std::to_string(FileUtil_GetProcessId()) + std::string{ kUntitledSuffix });
+
+    auto path = documentPath;
+    path += ".autosave";
+    return path;
+}
+
+std::filesystem::path AutosaveJournal::FindAbandonedJournal()
+{
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it{ std::filesystem::temp_directory_path(ec), ec }, end; !ec && it != end; it.increment(ec)) {
+        auto name = it->path().filename().string();
+        if (!name.starts_with(kUntitledPrefix) || !name.ends_with(kUntitledSuffix))
+            continue;
+
+        auto digits = std::string_view{ name }.substr(kUntitledPrefix.size(), name.size() - kUntitledPrefix.size() - kUntitledSuffix.size());
+        uint32_t processId = 0;
+        auto [parsed, error] = std::from_chars(digits.data(), digits.data() + digits.size(), processId);
+        if (error != std::errc{} || parsed != digits.data() + digits.size())
+            continue;
+        if (processId != FileUtil_GetProcessId() && !FileUtil_IsProcessRunning(processId))
+            return it->path();
+    }
+    return {};
+}
+
+bool AutosaveJournal::HasUnsavedChanges(const std::filesystem::path& journalPath)
+{
+    std::string data;
+    if (!ReadFile(journalPath, data))
+        return false;
+
+    RecordIterator records{ data };
+    auto checkpoint = records.ReadHeader() ? records.Next() : std::nullopt;
+    if (!checkpoint || checkpoint->type != RecordType::Checkpoint)
+        return false;
+
+    checkpoint->payload.Read<uint32_t>();
+    uint64_t snapshotRecords = checkpoint->payload.Read<uint32_t>();
+    snapshotRecords += checkpoint->payload.Read<uint32_t>();
+    bool unsaved = checkpoint->payload.Read<uint8_t>() != 0;
+
+    for (uint64_t i = 0; i < snapshotRecords; i++) {
+        if (!records.Next())
+            return false;
+    }
+
+    while (auto record = records.Next()) {
+        if (record->type == RecordType::Saved)
+            unsaved = false;
+        else if (record->type == RecordType::Unsaved || ChangesGraph(record->type))
+            unsaved = true;
+    }
+
+    return unsaved;
+}
+
+bool AutosaveJournal::Recover(Editor& editor, const std::filesystem::path& journalPath, std::string* error)
+{
+    PROFILE_SCOPE("RecoverJournal");
+    const auto fail = [error](const char* message) {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    std::string data;
+    if (!ReadFile(journalPath, data))
+        return fail("Failed to open the autosave journal.");
+
+    RecordIterator records{ data };
+    auto checkpoint = records.ReadHeader() ? records.Next() : std::nullopt;
+    if (!checkpoint || checkpoint->type != RecordType::Checkpoint)
+        return fail("The autosave journal is damaged.");
+
+    GraphFile::Graph graph;
+    auto lastId = checkpoint->payload.Read<uint32_t>();
+    auto nodeCount = checkpoint->payload.Read<uint32_t>();
+    auto linkCount = checkpoint->payload.Read<uint32_t>();
+    // Every record takes at least kRecordOverhead bytes, so counts the rest of the file can't hold are damage,
+    // and are never used to size anything.
+    if (!checkpoint->payload.Ok() || lastId > INT32_MAX || uint64_t{ nodeCount } + linkCount > records.GetRemaining() / kRecordOverhead)
+        return fail("The autosave journal is damaged.");
+
+    graph.lastId = static_cast<int>(lastId);
+    graph.arena = std::make_shared<GraphArena>();
+    graph.nodes.reserve(nodeCount);
+    graph.positions.reserve(nodeCount);
+    graph.links.reserve(linkCount);
+
+    // Node records of the snapshot can't be cut short, since snapshots are written atomically. Pins are
+    // looked up by ID in a sorted list of the ones read, rather than a table as long as the last ID.
+    std::vector<std::pair<uint32_t, Pin*>> pins;
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        auto record = records.Next();
+        auto& node = graph.nodes.emplace_back(graph.arena.get());
+        auto& position = graph.positions.emplace_back();
+        if (!record || record->type != RecordType::SpawnNode || !ReadNode(record->payload, node, position))
+            return fail("The autosave journal is damaged.");
+
+        for (auto& pin : node.inputs)
+            pins.emplace_back(static_cast<uint32_t>(pin.id.Get()), &pin);
+        for (auto& pin : node.outputs)
+            pins.emplace_back(static_cast<uint32_t>(pin.id.Get()), &pin);
+    }
+
+    std::sort(pins.begin(), pins.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    const auto findPin = [&pins](uint32_t id) -> Pin* {
+        auto it = std::lower_bound(pins.begin(), pins.end(), id, [](const auto& entry, uint32_t value) { return entry.first < value; });
+        return it != pins.end() && it->first == id ? it->second : nullptr;
+    };
+
+    for (uint32_t i = 0; i < linkCount; i++) {
+        auto record = records.Next();
+        if (!record || record->type != RecordType::SpawnLink)
+            return fail("The autosave journal is damaged.");
+
+        auto id = record->payload.Read<uint32_t>();
+        auto startPin = findPin(record->payload.Read<uint32_t>());
+        auto endPin = findPin(record->payload.Read<uint32_t>());
+        if (!record->payload.Ok() || !startPin || !endPin)
+            return fail("The autosave journal is damaged.");
+
+        ConnectPins(*startPin, *endPin);
+        auto& link = graph.links.emplace_back(Link(id, startPin->id, endPin->id));
+        link.color = Editor::GetIconColor(startPin->type);
+    }
+
+    GraphFile::Apply(editor, std::move(graph));
+
+    std::vector<NodeMove> moves;
+    while (auto record = records.Next()) {
+        auto& payload = record->payload;
+        switch (record->type) {
+        case RecordType::SpawnNode:
+        {
+            Node node{ editor.m_Arena.get() };
+            ImVec2 position;
+            if (ReadNode(payload, node, position))
+                editor.RestoreNode(std::move(node), position);
+            break;
+        }
+        case RecordType::DestroyNode:
+            editor.DestroyNode(payload.Read<uint32_t>());
+            break;
+        case RecordType::SpawnLink:
+        {
+            auto id = payload.Read<uint32_t>();
+            auto startPin = editor.FindPin(payload.Read<uint32_t>());
+            auto endPin = editor.FindPin(payload.Read<uint32_t>());
+            if (payload.Ok() && startPin && endPin && startPin->kind == PinKind::Output && endPin->kind == PinKind::Input)
+                editor.SpawnLink(startPin, endPin, id);
+            break;
+        }
+        case RecordType::DestroyLink:
+            editor.DestroyLink(payload.Read<uint32_t>());
+            break;
+        case RecordType::SetValue:
+        {
+            auto pin = editor.FindPin(payload.Read<uint32_t>());
+            auto type = static_cast<PinType>(payload.Read<uint16_t>());
+            if (!pin || pin->type != type)
+                break;
+
+            switch (type) {
+            case PinType::CustomInt: editor.SetPinValue(*pin, NodeIntCustomValueConnection{ payload.Read<int32_t>() }); break;
+            case PinType::CustomFloat: editor.SetPinValue(*pin, NodeFloatCustomValueConnection{ payload.Read<float>() }); break;
+            case PinType::CustomString: editor.SetPinValue(*pin, NodeStringCustomValueConnection{ StringPool::Get().Intern(payload.ReadString()) }); break;
+            default: break;
+            }
+            break;
+        }
+        case RecordType::MoveNodes:
+        {
+            moves.clear();
+            auto count = payload.Read<uint32_t>();
+            for (uint32_t i = 0; i < count && payload.Ok(); i++) {
+                ed::NodeId id = payload.Read<uint32_t>();
+                ImVec2 to;
+                to.x = payload.Read<float>();
+                to.y = payload.Read<float>();
+                if (payload.Ok() && editor.FindNode(id))
+                    moves.push_back({ id, ed::GetNodePosition(id), to });
+            }
+            if (!moves.empty())
+                editor.MoveNodes(moves);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+void AutosaveJournal::Open(std::filesystem::path journalPath, bool unsaved)
+{
+    Close();
+    m_Path = std::move(journalPath);
+    m_Unsaved = unsaved;
+    m_CheckpointRequested = true;
+}
+
+void AutosaveJournal::Close()
+{
+    if (m_Path.empty())
+        return;
+
+    if (!m_Records.empty())
+        Submit({ Job::Kind::Append, {}, std::nullopt, false, std::move(m_Records) });
+    Submit({ m_Unsaved ? Job::Kind::Close : Job::Kind::Discard });
+
+    m_Records.clear();
+    m_Path.clear();
+    m_ChangesSinceCheckpoint = 0;
+    m_CheckpointRequested = false;
+}
+
+const std::filesystem::path& AutosaveJournal::GetPath() const
+{
+    return m_Path;
+}
+
+bool AutosaveJournal::HasUnsavedChanges() const
+{
+    return m_Unsaved;
+}
+
+uint64_t AutosaveJournal::GetRevision() const
+{
+    return m_Revision;
+}
+
+void AutosaveJournal::MarkSaved(uint64_t revision)
+{
+    if (m_Path.empty() || revision != m_Revision)
+        return;
+
+    RecordWriter{ m_Records, RecordType::Saved };
+    m_Unsaved = false;
+}
+
+void AutosaveJournal::MarkUnsaved()
+{
+    if (m_Path.empty())
+        return;
+
+    RecordWriter{ m_Records, RecordType::Unsaved };
+    m_Unsaved = true;
+}
+
+void AutosaveJournal::Update()
+{
+    if (m_Path.empty())
+        return;
+
+    bool checkpointDue = m_ChangesSinceCheckpoint >= kCheckpointChanges ||
+        (m_ChangesSinceCheckpoint > 0 && std::chrono::steady_clock::now() - m_LastCheckpoint >= kCheckpointInterval);
+
+    if (m_CheckpointRequested || checkpointDue) {
+        Checkpoint();
+    }
+    else if (!m_Records.empty()) {
+        Submit({ Job::Kind::Append, {}, std::nullopt, false, std::move(m_Records) });
+        m_Records.clear();
+    }
+}
+
+std::string AutosaveJournal::TakeError()
+{
+    std::lock_guard lock{ m_Mutex };
+    return std::move(m_Error);
+}
+
+void AutosaveJournal::Checkpoint()
+{
+    PROFILE_SCOPE("JournalCheckpoint");
+    // The snapshot already holds whatever the pending records describe.
+    m_Records.clear();
+    m_ChangesSinceCheckpoint = 0;
+    m_CheckpointRequested = false;
+    m_LastCheckpoint = std::chrono::steady_clock::now();
+
+    GraphFile::Graph graph;
+    ed::SetCurrentEditor(m_Editor.m_Editor);
+    GraphFile::Capture(m_Editor, graph);
+    ed::SetCurrentEditor(nullptr);
+
+    Submit({ Job::Kind::Start, m_Path, std::move(graph), m_Unsaved });
+}
+
+void AutosaveJournal::RecordChange()
+{
+    ++m_ChangesSinceCheckpoint;
+    ++m_Revision;
+    m_Unsaved = true;
+}
+
+void AutosaveJournal::OnGraphReset()
+{
+    ++m_Revision;
+    if (!m_Path.empty())
+        m_CheckpointRequested = true;
+}
+
+void AutosaveJournal::OnNodeSpawned(const Node& node, const ImVec2& position)
+{
+    if (m_Path.empty())
+        return;
+
+    WriteNode(m_Records, node, position);
+    RecordChange();
+}
+
+void AutosaveJournal::OnNodeDestroying(const Node& node)
+{
+    if (m_Path.empty())
+        return;
+
+    RecordWriter record{ m_Records, RecordType::DestroyNode };
+    record.Write(static_cast<uint32_t>(node.id.Get()));
+    RecordChange();
+}
+
+void AutosaveJournal::OnLinkSpawned(const Link& link)
+{
+    if (m_Path.empty())
+        return;
+
+    WriteLink(m_Records, link);
+    RecordChange();
+}
+
+void AutosaveJournal::OnLinkDestroying(const Link& link)
+{
+    if (m_Path.empty())
+        return;
+
+    RecordWriter record{ m_Records, RecordType::DestroyLink };
+    record.Write(static_cast<uint32_t>(link.id.Get()));
+    RecordChange();
+}
+
+void AutosaveJournal::OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit)
+{
+    if (m_Path.empty())
+        return;
+
+    RecordWriter record{ m_Records, RecordType::SetValue };
+    record.Write(static_cast<uint32_t>(pin.id.Get()));
+    record.Write(static_cast<uint16_t>(pin.type));
+    switch (pin.type) {
+    case PinType::CustomInt: record.Write(static_cast<int32_t>(std::get<NodeIntCustomValueConnection>(pin.connected).value)); break;
+    case PinType::CustomFloat: record.Write(std::get<NodeFloatCustomValueConnection>(pin.connected).value); break;
+    case PinType::CustomString: record.WriteString(std::get<NodeStringCustomValueConnection>(pin.connected).value); break;
+    default: break;
+    }
+    RecordChange();
+}
+
+void AutosaveJournal::OnNodesMoved(std::span<const NodeMove> moves)
+{
+    if (m_Path.empty())
+        return;
+
+    RecordWriter record{ m_Records, RecordType::MoveNodes };
+    record.Write(static_cast<uint32_t>(moves.size()));
+    for (auto& move : moves) {
+        record.Write(static_cast<uint32_t>(move.id.Get()));
+        record.Write(move.to.x);
+        record.Write(move.to.y);
+    }
+    RecordChange();
+}
+
+void AutosaveJournal::Submit(Job&& job)
+{
+    {
+        std::lock_guard lock{ m_Mutex };
+        m_Jobs.push_back(std::move(job));
+    }
+    m_Wake.notify_one();
+}
+
+void AutosaveJournal::Run()
+{
+    Trace::SetThreadName("Journal");
+
+    std::unique_lock lock{ m_Mutex };
+    while (true) {
+        m_Wake.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+        if (m_Jobs.empty())
+            break;
+
+        Job job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+        lock.unlock();
+        Process(job);
+        lock.lock();
+    }
+
+    lock.unlock();
+    if (m_File.is_open())
+        m_File.close();
+}
+
+void AutosaveJournal::Process(Job& job)
+{
+    switch (job.kind) {
+    case Job::Kind::Start:
+    {
+        TRACE_SCOPE("JournalSnapshot");
+        if (m_File.is_open())
+            m_File.close();
+
+        auto& graph = *job.snapshot;
+        std::vector<uint8_t> data;
+        WriteHeader(data);
+        {
+            RecordWriter record{ data, RecordType::Checkpoint };
+            record.Write(static_cast<uint32_t>(graph.lastId));
+            record.Write(static_cast<uint32_t>(graph.nodes.size()));
+            record.Write(static_cast<uint32_t>(graph.links.size()));
+            record.Write(static_cast<uint8_t>(job.unsaved));
+        }
+        for (size_t i = 0; i < graph.nodes.size(); i++)
+            WriteNode(data, graph.nodes[i], graph.positions[i]);
+        for (auto& link : graph.links)
+            WriteLink(data, link);
+
+        m_FilePath = job.path;
+        std::string error;
+        if (!FileUtil_WriteAtomic(m_FilePath, { reinterpret_cast<const char*>(data.data()), data.size() }, &error)) {
+            std::lock_guard lock{ m_Mutex };
+            m_Error = "Autosave failed. " + error;
+            return;
+        }
+        m_File.open(m_FilePath, std::ios::binary | std::ios::app);
+        break;
+    }
+    case Job::Kind::Append:
+        if (m_File.is_open()) {
+            TRACE_SCOPE("JournalAppend");
+            m_File.write(reinterpret_cast<const char*>(job.records.data()), job.records.size());
+            // Handing the records to the OS is enough to survive the editor crashing.
+            m_File.flush();
+        }
+        break;
+    case Job::Kind::Close:
+    case Job::Kind::Discard:
+        if (m_File.is_open())
+            m_File.close();
+        if (job.kind == Job::Kind::Discard && !m_FilePath.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(m_FilePath, ec);
+        }
+        m_FilePath.clear();
+        break;
+    }
+}
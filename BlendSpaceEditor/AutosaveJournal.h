@@ -0,0 +1,102 @@
+#pragma once
+#include "Editor.h"
+#include "GraphFile.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Crash recovery for the open document. Every change to the editor's graph is appended to a journal next
+// to the document as a compact binary record. The journal is periodically restarted from a full snapshot,
+// so recovery replays one snapshot plus the changes made since it, however large the graph is.
+class AutosaveJournal : public EditorListener
+{
+public:
+    explicit AutosaveJournal(Editor& editor);
+    // Writes out everything recorded so far before returning.
+    ~AutosaveJournal() override;
+
+    AutosaveJournal(const AutosaveJournal&) = delete;
+    AutosaveJournal& operator=(const AutosaveJournal&) = delete;
+
+    // An empty document path means an untitled document, whose journal is unique to this process.
+    static std::filesystem::path GetJournalPath(const std::filesystem::path& documentPath);
+    // The journal left by an untitled document of an instance that is no longer running, as after a crash,
+    // or an empty path if there is none.
+    static std::filesystem::path FindAbandonedJournal();
+    // True when the journal holds changes that were never saved.
+    static bool HasUnsavedChanges(const std::filesystem::path& journalPath);
+    // Replaces the editor's graph with the journal's snapshot and replays the changes recorded after it,
+    // stopping quietly at a record cut short by a crash. Returns false and leaves the graph untouched if
+    // the snapshot can't be read. Requires the editor's node editor context to be current.
+    static bool Recover(Editor& editor, const std::filesystem::path& journalPath, std::string* error);
+
+    // Closes the current journal and starts a new one at journalPath from the editor's graph.
+    void Open(std::filesystem::path journalPath, bool unsaved);
+    // Stops journaling. The file is kept only if it holds unsaved changes.
+    void Close();
+    const std::filesystem::path& GetPath() const;
+    bool HasUnsavedChanges() const;
+    // Counts the changes to the graph, across journals. Identifies the graph a save was taken from.
+    uint64_t GetRevision() const;
+    // The graph as of revision was saved. Does nothing if it has changed since, as those changes still aren't.
+    void MarkSaved(uint64_t revision);
+    // A save failed.
+    void MarkUnsaved();
+    // Hands this frame's records to the writer, checkpointing when due. Call once per frame, after the editor.
+    void Update();
+    // Returns and clears the last write error, if any.
+    std::string TakeError();
+
+    void OnGraphReset() override;
+    void OnNodeSpawned(const Node& node, const ImVec2& position) override;
+    void OnNodeDestroying(const Node& node) override;
+    void OnLinkSpawned(const Link& link) override;
+    void OnLinkDestroying(const Link& link) override;
+    void OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit) override;
+    void OnNodesMoved(std::span<const NodeMove> moves) override;
+
+private:
+    struct Job
+    {
+        enum class Kind { Start, Append, Close, Discard };
+
+        Kind kind;
+        std::filesystem::path path;
+        std::optional<GraphFile::Graph> snapshot;
+        bool unsaved = false;
+        std::vector<uint8_t> records;
+    };
+
+    void Checkpoint();
+    void RecordChange();
+    void Submit(Job&& job);
+    void Run();
+    void Process(Job& job);
+
+    Editor& m_Editor;
+    std::filesystem::path m_Path;
+    std::vector<uint8_t> m_Records;
+    size_t m_ChangesSinceCheckpoint = 0;
+    std::chrono::steady_clock::time_point m_LastCheckpoint;
+    bool m_CheckpointRequested = false;
+    bool m_Unsaved = false;
+    uint64_t m_Revision = 0;
+
+    // Owned by the writer thread.
+    std::ofstream m_File;
+    std::filesystem::path m_FilePath;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::deque<Job> m_Jobs;
+    bool m_Stopping = false;
+    std::string m_Error;
+    std::thread m_Thread;
+};
@@ -4,7 +4,11 @@
 #include "imgui_internal.h"
 #include "imgui_stdlib.h"
 #include "NodeBuilder.h"
+#include "Profiler.h"
+#include "StringPool.h"
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <iostream>
 #undef max
 
@@ -31,25 +35,63 @@ Editor::~Editor()
 }
 
 void Editor::InitNew()
+{
+    ed::SetCurrentEditor(m_Editor);
+    Clear();
+
+    SpawnNode(NodeDefinitions::FindDef("anim"), ImVec2(16, 256));
+    SpawnNode(NodeDefinitions::FindDef("actor"), ImVec2(1056, 256));
+
+    ed::SetCurrentEditor(nullptr);
+}
+
+void Editor::Clear()
 {
     m_Nodes.clear();
     m_Links.clear();
+    m_Arena = std::make_shared<GraphArena>();
+    NotifyGraphReplaced();
+}
 
-    ed::SetCurrentEditor(m_Editor);
+void Editor::CompactArena()
+{
+    PROFILE_SCOPE("Editor::CompactArena");
+    auto arena = std::make_shared<GraphArena>();
+    std::vector<Node> nodes;
+    nodes.reserve(m_Nodes.size());
+    for (auto& node : m_Nodes)
+        nodes.emplace_back(std::move(node), arena.get());
 
-    auto& defs = NodeDefinitions::GetDefList();
-    for (auto& d : defs) {
-        if (d->typeName == "anim") {
-            auto node = SpawnNode(d);
-            ed::SetNodePosition(node->id, ImVec2(16, 256));
-        }
-        else if (d->typeName == "actor") {
-            auto node = SpawnNode(d);
-            ed::SetNodePosition(node->id, ImVec2(1056, 256));
-        }
-    }
+    m_Nodes = std::move(nodes);
+    m_Arena = std::move(arena);
+}
 
-    ed::SetCurrentEditor(nullptr);
+bool Editor::IsHoldingPins() const
+{
+    return m_NewLinkPin || m_NewNodeLinkPin || m_CreatingNewNode;
+}
+
+void Editor::NotifyGraphReplaced()
+{
+    InvalidateSpatialIndex();
+    m_IdLookupDirty = true;
+    m_DragStartPositions.clear();
+    // A string edit in progress belongs to the old graph, whose pin IDs the new one may reuse.
+    m_ActiveStringPin = 0;
+    ++m_GraphRevision;
+
+    for (auto listener : m_Listeners)
+        listener->OnGraphReset();
+}
+
+void Editor::AddListener(EditorListener* listener)
+{
+    m_Listeners.push_back(listener);
+}
+
+void Editor::RemoveListener(EditorListener* listener)
+{
+    std::erase(m_Listeners, listener);
 }
 
 int Editor::GetNextId()
@@ -59,20 +101,20 @@ int Editor::GetNextId()
 
 Node* Editor::FindNode(ed::NodeId id)
 {
-    for (auto& node : m_Nodes)
-        if (node.id == id)
-            return &node;
+    auto location = LookupId(id.Get());
+    if (!location || location->kind != IdLocation::Kind::Node)
+        return nullptr;
 
-    return nullptr;
+    return &m_Nodes[location->index];
 }
 
 Link* Editor::FindLink(ed::LinkId id)
 {
-    for (auto& link : m_Links)
-        if (link.id == id)
-            return &link;
+    auto location = LookupId(id.Get());
+    if (!location || location->kind != IdLocation::Kind::Link)
+        return nullptr;
 
-    return nullptr;
+    return &m_Links[location->index];
 }
 
 Pin* Editor::FindPin(ed::PinId id)
@@ -80,30 +122,21 @@ Pin* Editor::FindPin(ed::PinId id)
     if (!id)
         return nullptr;
 
-    for (auto& node : m_Nodes)
-    {
-        for (auto& pin : node.inputs)
-            if (pin.id == id)
-                return &pin;
+    auto location = LookupId(id.Get());
+    if (!location)
+        return nullptr;
 
-        for (auto& pin : node.outputs)
-            if (pin.id == id)
-                return &pin;
+    switch (location->kind) {
+    case IdLocation::Kind::Input: return &m_Nodes[location->index].inputs[location->slot];
+    case IdLocation::Kind::Output: return &m_Nodes[location->index].outputs[location->slot];
+    default: return nullptr;
     }
-
-    return nullptr;
 }
 
 bool Editor::IsPinLinked(ed::PinId id)
 {
-    if (!id)
-        return false;
-
-    for (auto& link : m_Links)
-        if (link.startPinID == id || link.endPinID == id)
-            return true;
-
-    return false;
+    auto pin = FindPin(id);
+    return pin && pin->IsLinked();
 }
 
 bool Editor::CanCreateLink(Pin* a, Pin* b)
@@ -121,16 +154,46 @@ bool Editor::CanCreateLink(Pin* a, Pin* b)
     return true;
 }
 
-Node* Editor::SpawnNode(NodeDefinitions::NodeDef* def)
+Node* Editor::SpawnNode(const NodeDefinitions::NodeDef* def, const ImVec2& position)
 {
-    m_Nodes.emplace_back();
-    def->CopyToNode(m_NextIdBound, m_Nodes.back());
-    m_Nodes.back().Build();
+    Node node{ m_Arena.get() };
+    def->CopyToNode(m_LastId + 1, node);
+    node.Build();
+    return RestoreNode(std::move(node), position);
+}
 
-    return &m_Nodes.back();
+Node* Editor::RestoreNode(Node&& node, const ImVec2& position)
+{
+    m_Nodes.emplace_back(std::move(node), m_Arena.get());
+    return RegisterNode(m_Nodes.size() - 1, position);
 }
 
-Link* Editor::SpawnLink(Pin* startPin, Pin* endPin)
+Node* Editor::RestoreNode(const Node& node, const ImVec2& position)
+{
+    m_Nodes.emplace_back(node, m_Arena.get());
+    return RegisterNode(m_Nodes.size() - 1, position);
+}
+
+Node* Editor::RegisterNode(size_t index, const ImVec2& position)
+{
+    auto& node = m_Nodes[index];
+    m_LastId = std::max<int>(m_LastId, static_cast<int>(node.id.Get()));
+    for (auto& pin : node.inputs)
+        m_LastId = std::max<int>(m_LastId, static_cast<int>(pin.id.Get()));
+    for (auto& pin : node.outputs)
+        m_LastId = std::max<int>(m_LastId, static_cast<int>(pin.id.Get()));
+
+    IndexNode(index);
+    ed::SetNodePosition(node.id, position);
+    MarkNodeBoundsDirty(node.id);
+
+    for (auto listener : m_Listeners)
+        listener->OnNodeSpawned(node, position);
+
+    return &node;
+}
+
+Link* Editor::SpawnLink(Pin* startPin, Pin* endPin, ed::LinkId id)
 {
     if (std::get<NodeInputConnection>(endPin->connected).id.Get() != 0) {
         for (auto iter = m_Links.begin(); iter != m_Links.end(); iter++) {
@@ -145,27 +208,111 @@ Link* Editor::SpawnLink(Pin* startPin, Pin* endPin)
     auto& inputCon = std::get<NodeInputConnection>(endPin->connected);
     inputCon.id = startPin->id;
     inputCon.nodeId = startPin->node;
-    inputCon.typeName = startPin->def->typeName;
+    inputCon.typeName = startPin->def->typeName.data();
+
+    if (id)
+        m_LastId = std::max<int>(m_LastId, static_cast<int>(id.Get()));
+    else
+        id = GetNextId();
+
+    auto& link = m_Links.emplace_back(Link(id, startPin->id, endPin->id));
+    link.color = GetIconColor(startPin->type);
+    IndexLink(m_Links.size() - 1);
+    ++m_GraphRevision;
 
-    m_Links.emplace_back(Link(GetNextId(), startPin->id, endPin->id));
-    m_Links.back().color = GetIconColor(startPin->type);
-    return &m_Links.back();
+    for (auto listener : m_Listeners)
+        listener->OnLinkSpawned(link);
+
+    return &link;
 }
 
 void Editor::DestroyLink(ed::LinkId id)
 {
-    for (auto iter = m_Links.begin(); iter != m_Links.end(); iter++) {
-        if (iter->id == id) {
-            DestroyLinkByIter(iter);
-            break;
-        }
-    }    
+    DestroyLinks({ &id, 1 });
 }
 
 void Editor::DestroyLinkByIter(std::vector<Link>::iterator& iter)
 {
-    auto startPin = FindPin(iter->startPinID);
-    auto endPin = FindPin(iter->endPinID);
+    for (auto listener : m_Listeners)
+        listener->OnLinkDestroying(*iter);
+
+    DisconnectLink(*iter);
+
+    auto index = static_cast<size_t>(iter - m_Links.begin());
+    if (!m_IdLookupDirty)
+        m_IdLookup[iter->id.Get()] = {};
+    m_Links.erase(iter);
+    for (size_t i = index; i < m_Links.size(); i++)
+        IndexLink(i);
+    ++m_GraphRevision;
+}
+
+void Editor::DestroyNode(ed::NodeId id)
+{
+    DestroyNodes({ &id, 1 });
+}
+
+void Editor::DestroyLinks(std::span<const ed::LinkId> ids)
+{
+    // Destroyed links are unmapped first, which is how the single erase pass recognizes them.
+    size_t firstIndex = m_Links.size();
+    for (auto id : ids) {
+        auto link = FindLink(id);
+        if (!link)
+            continue;
+
+        for (auto listener : m_Listeners)
+            listener->OnLinkDestroying(*link);
+
+        DisconnectLink(*link);
+        firstIndex = std::min(firstIndex, static_cast<size_t>(link - m_Links.data()));
+        m_IdLookup[id.Get()] = {};
+    }
+
+    if (firstIndex == m_Links.size())
+        return;
+
+    std::erase_if(m_Links, [this](const Link& link) { return m_IdLookup[link.id.Get()].kind == IdLocation::Kind::None; });
+    for (size_t i = firstIndex; i < m_Links.size(); i++)
+        IndexLink(i);
+    ++m_GraphRevision;
+}
+
+void Editor::DestroyNodes(std::span<const ed::NodeId> ids)
+{
+    size_t firstIndex = m_Nodes.size();
+    for (auto id : ids) {
+        auto node = FindNode(id);
+        if (!node)
+            continue;
+
+        for (auto listener : m_Listeners)
+            listener->OnNodeDestroying(*node);
+
+        firstIndex = std::min(firstIndex, static_cast<size_t>(node - m_Nodes.data()));
+        m_IdLookup[id.Get()] = {};
+        for (auto& pin : node->inputs)
+            m_IdLookup[pin.id.Get()] = {};
+        for (auto& pin : node->outputs)
+            m_IdLookup[pin.id.Get()] = {};
+        m_SpatialIndex.Remove(id.Get());
+    }
+
+    if (firstIndex == m_Nodes.size())
+        return;
+
+    std::erase_if(m_Nodes, [this](const Node& node) { return m_IdLookup[node.id.Get()].kind == IdLocation::Kind::None; });
+    for (size_t i = firstIndex; i < m_Nodes.size(); i++)
+        IndexNode(i);
+
+    std::erase_if(m_DirtyNodeBounds, [this](ed::NodeId id) { return !FindNode(id); });
+    std::erase_if(m_DragStartPositions, [this](auto& move) { return !FindNode(move.id); });
+}
+
+void Editor::DisconnectLink(const Link& link)
+{
+    auto startPin = FindPin(link.startPinID);
+    auto endPin = FindPin(link.endPinID);
     if (startPin && endPin) {
         auto& outputIds = std::get<NodeOutputConnection>(startPin->connected).ids;
         for (auto id_it = outputIds.begin(); id_it != outputIds.end(); id_it++) {
@@ -174,16 +321,194 @@ void Editor::DestroyLinkByIter(std::vector<Link>::iterator& iter)
                 break;
             }
         }
-        std::get<NodeInputConnection>(endPin->connected).id = 0;
+        // Clear the whole connection, since Node::ToJson writes the node ID even when the input is unlinked.
+        std::get<NodeInputConnection>(endPin->connected) = {};
     }
-    m_Links.erase(iter);
 }
 
-void Editor::DestroyNode(ed::NodeId id)
+void Editor::SetPinValue(Pin& pin, const Pin::ConnectionVariant& value)
+{
+    auto before = std::exchange(pin.connected, value);
+    MarkNodeBoundsDirty(pin.node);
+
+    for (auto listener : m_Listeners)
+        listener->OnValueChanged(pin, before, false);
+}
+
+void Editor::MoveNodes(std::span<const NodeMove> moves)
+{
+    for (auto& move : moves) {
+        ed::SetNodePosition(move.id, move.to);
+        MarkNodeBoundsDirty(move.id);
+    }
+
+    for (auto listener : m_Listeners)
+        listener->OnNodesMoved(moves);
+}
+
+void Editor::CopyNodes(std::span<const ed::NodeId> ids, GraphFile::Graph& clipboard)
 {
-    auto iter = std::find_if(m_Nodes.begin(), m_Nodes.end(), [id](auto& node) { return node.id == id; });
-    if (iter != m_Nodes.end())
-        m_Nodes.erase(iter);
+    PROFILE_SCOPE("CopyNodes");
+    clipboard.nodes.clear();
+    clipboard.positions.clear();
+    clipboard.links.clear();
+    clipboard.nodes.reserve(ids.size());
+    clipboard.positions.reserve(ids.size());
+    if (m_NodeSlots.size() < m_Nodes.size())
+        m_NodeSlots.resize(m_Nodes.size(), -1);
+
+    int lastId = 0;
+    for (auto id : ids) {
+        auto node = FindNode(id);
+        if (!node || m_NodeSlots[node - m_Nodes.data()] != -1)
+            continue;
+
+        m_NodeSlots[node - m_Nodes.data()] = static_cast<int32_t>(clipboard.nodes.size());
+        clipboard.positions.push_back(ed::GetNodePosition(id));
+        auto& copy = clipboard.nodes.emplace_back(*node);
+        copy.id = ++lastId;
+        for (auto& pin : copy.inputs) {
+            pin.id = ++lastId;
+            pin.node = copy.id;
+        }
+        for (auto& pin : copy.outputs) {
+            pin.id = ++lastId;
+            pin.node = copy.id;
+            std::get<NodeOutputConnection>(pin.connected).ids.clear();
+        }
+    }
+
+    // Inputs still name the original output they're linked to, which the slot table maps to its copy.
+    for (auto& copy : clipboard.nodes) {
+        for (auto& input : copy.inputs) {
+            if (input.type >= PinType::CustomStart)
+                continue;
+
+            auto& connected = std::get<NodeInputConnection>(input.connected);
+            auto source = LookupId(connected.id.Get());
+            connected = {};
+            if (!source || source->kind != IdLocation::Kind::Output || m_NodeSlots[source->index] == -1)
+                continue;
+
+            auto& sourceCopy = clipboard.nodes[m_NodeSlots[source->index]];
+            auto& link = clipboard.links.emplace_back(++lastId, sourceCopy.outputs[source->slot].id, input.id);
+            link.color = GetIconColor(input.type);
+        }
+    }
+    clipboard.lastId = lastId;
+
+    for (auto id : ids) {
+        if (auto node = FindNode(id))
+            m_NodeSlots[node - m_Nodes.data()] = -1;
+    }
+}
+
+void Editor::PasteNodes(const GraphFile::Graph& clipboard, const ImVec2& position)
+{
+    PROFILE_SCOPE("PasteNodes");
+    if (clipboard.nodes.empty())
+        return;
+
+    ImVec2 topLeft = clipboard.positions.front();
+    for (auto& p : clipboard.positions)
+        topLeft = ImMin(topLeft, p);
+    auto offset = position - topLeft;
+
+    // Clipboard IDs run from 1 to lastId, so offsetting them past the last ID in use makes them fresh.
+    int base = m_LastId;
+    m_Nodes.reserve(m_Nodes.size() + clipboard.nodes.size());
+    m_Links.reserve(m_Links.size() + clipboard.links.size());
+    if (!m_IdLookupDirty)
+        m_IdLookup.resize(std::max<size_t>(m_IdLookup.size(), static_cast<size_t>(base) + clipboard.lastId + 1));
+
+    ed::ClearSelection();
+    for (size_t i = 0; i < clipboard.nodes.size(); i++) {
+        // Copied straight into the arena, then renumbered in place.
+        auto& node = m_Nodes.emplace_back(clipboard.nodes[i], m_Arena.get());
+        node.id = node.id.Get() + base;
+        for (auto& pin : node.inputs) {
+            pin.id = pin.id.Get() + base;
+            pin.node = node.id;
+        }
+        for (auto& pin : node.outputs) {
+            pin.id = pin.id.Get() + base;
+            pin.node = node.id;
+        }
+
+        auto pasted = RegisterNode(m_Nodes.size() - 1, clipboard.positions[i] + offset);
+        ed::SelectNode(pasted->id, true);
+    }
+
+    for (auto& link : clipboard.links)
+        SpawnLink(FindPin(link.startPinID.Get() + base), FindPin(link.endPinID.Get() + base), link.id.Get() + base);
+}
+
+void Editor::DeleteNodes(std::span<const ed::NodeId> ids)
+{
+    // Marking the nodes lets one pass over the links find every link attached to them.
+    if (m_NodeSlots.size() < m_Nodes.size())
+        m_NodeSlots.resize(m_Nodes.size(), -1);
+    for (auto id : ids) {
+        if (auto node = FindNode(id))
+            m_NodeSlots[node - m_Nodes.data()] = 0;
+    }
+
+    const auto isMarked = [this](ed::PinId pinId) {
+        auto location = LookupId(pinId.Get());
+        return location && location->kind != IdLocation::Kind::None && m_NodeSlots[location->index] != -1;
+    };
+
+    m_DeletedLinksBuffer.clear();
+    for (auto& link : m_Links) {
+        if (isMarked(link.startPinID) || isMarked(link.endPinID))
+            m_DeletedLinksBuffer.push_back(link.id);
+    }
+
+    for (auto id : ids) {
+        if (auto node = FindNode(id))
+            m_NodeSlots[node - m_Nodes.data()] = -1;
+    }
+
+    DestroyLinks(m_DeletedLinksBuffer);
+    DestroyNodes(ids);
+}
+
+void Editor::CopySelection()
+{
+    CopyNodes(GetSelectedNodes(), m_Clipboard);
+}
+
+void Editor::CutSelection()
+{
+    auto selection = GetSelectedNodes();
+    CopyNodes(selection, m_Clipboard);
+    DeleteNodes(selection);
+    ed::ClearSelection();
+}
+
+void Editor::Paste()
+{
+    PasteNodes(m_Clipboard, m_NewNodePosition);
+}
+
+void Editor::DuplicateSelection()
+{
+    CopyNodes(GetSelectedNodes(), m_DuplicateBuffer);
+    if (m_DuplicateBuffer.nodes.empty())
+        return;
+
+    ImVec2 topLeft = m_DuplicateBuffer.positions.front();
+    for (auto& p : m_DuplicateBuffer.positions)
+        topLeft = ImMin(topLeft, p);
+    PasteNodes(m_DuplicateBuffer, topLeft + ImVec2(32.0f, 32.0f));
+}
+
+std::span<const ed::NodeId> Editor::GetSelectedNodes()
+{
+    auto selectedCount = ed::GetSelectedObjectCount();
+    m_SelectedNodesBuffer.resize(selectedCount);
+    int nodeCount = selectedCount > 0 ? ed::GetSelectedNodes(m_SelectedNodesBuffer.data(), selectedCount) : 0;
+    return { m_SelectedNodesBuffer.data(), static_cast<size_t>(nodeCount) };
 }
 
 ImColor Editor::GetIconColor(PinType type)
@@ -239,29 +564,195 @@ void Editor::EndCustomValue()
     ImGui::PopItemWidth();
 }
 
+void Editor::MarkNodeBoundsDirty(ed::NodeId id)
+{
+    m_DirtyNodeBounds.push_back(id);
+}
+
+void Editor::InvalidateSpatialIndex()
+{
+    m_SpatialIndex.Clear();
+    m_DirtyNodeBounds.clear();
+    for (auto& node : m_Nodes)
+        m_DirtyNodeBounds.push_back(node.id);
+}
+
+void Editor::QueryNodesInRect(const ImVec2& min, const ImVec2& max, std::vector<ed::NodeId>& out)
+{
+    m_SpatialQueryBuffer.clear();
+    m_SpatialIndex.QueryRect({ min.x, min.y, max.x, max.y }, m_SpatialQueryBuffer);
+    for (auto id : m_SpatialQueryBuffer)
+        out.emplace_back(id);
+}
+
+ed::NodeId Editor::QueryNodeAtPoint(const ImVec2& pos)
+{
+    m_SpatialQueryBuffer.clear();
+    m_SpatialIndex.QueryPoint(pos.x, pos.y, m_SpatialQueryBuffer);
+    if (m_SpatialQueryBuffer.empty())
+        return 0;
+
+    return m_SpatialQueryBuffer.front();
+}
+
+const Editor::IdLocation* Editor::LookupId(uintptr_t id)
+{
+    if (m_IdLookupDirty)
+        RebuildIdLookup();
+
+    if (id >= m_IdLookup.size())
+        return nullptr;
+
+    return &m_IdLookup[id];
+}
+
+void Editor::IndexNode(size_t index)
+{
+    if (m_IdLookupDirty)
+        return;
+
+    auto& node = m_Nodes[index];
+    const auto set = [this](uintptr_t id, IdLocation location) {
+        if (id >= m_IdLookup.size())
+            m_IdLookup.resize(std::max<size_t>(id + 1, m_IdLookup.size() * 2));
+        m_IdLookup[id] = location;
+    };
+
+    set(node.id.Get(), { static_cast<uint32_t>(index), 0, IdLocation::Kind::Node });
+    for (size_t i = 0; i < node.inputs.size(); i++)
+        set(node.inputs[i].id.Get(), { static_cast<uint32_t>(index), static_cast<uint16_t>(i), IdLocation::Kind::Input });
+    for (size_t i = 0; i < node.outputs.size(); i++)
+        set(node.outputs[i].id.Get(), { static_cast<uint32_t>(index), static_cast<uint16_t>(i), IdLocation::Kind::Output });
+}
+
+void Editor::IndexLink(size_t index)
+{
+    if (m_IdLookupDirty)
+        return;
+
+    auto id = m_Links[index].id.Get();
+    if (id >= m_IdLookup.size())
+        m_IdLookup.resize(std::max<size_t>(id + 1, m_IdLookup.size() * 2));
+    m_IdLookup[id] = { static_cast<uint32_t>(index), 0, IdLocation::Kind::Link };
+}
+
+void Editor::RebuildIdLookup()
+{
+    PROFILE_SCOPE("RebuildIdLookup");
+    m_IdLookup.assign(static_cast<size_t>(std::max(m_LastId, 0)) + 1, {});
+    m_IdLookupDirty = false;
+
+    // Walk backwards so that the first occurrence of a repeated ID wins, as with a linear search.
+    for (size_t i = m_Links.size(); i-- > 0;)
+        IndexLink(i);
+    for (size_t i = m_Nodes.size(); i-- > 0;)
+        IndexNode(i);
+}
+
+// Call right after a custom value widget. before is the value ahead of this frame's change, or nullptr
+// to use the one saved when the widget was activated, which avoids copying strings every frame.
+void Editor::TrackValueEdit(Pin& pin, bool changed, const Pin::ConnectionVariant* before)
+{
+    if (ImGui::IsItemActivated()) {
+        m_ValueEditPin = pin.id;
+        m_ValueEditChanged = false;
+        if (!changed)
+            m_ValueEditBefore = pin.connected;
+    }
+
+    if (changed) {
+        bool tracked = m_ValueEditPin == pin.id;
+        const auto& previous = before ? *before : tracked ? m_ValueEditBefore : pin.connected;
+        MarkNodeBoundsDirty(pin.node);
+
+        for (auto listener : m_Listeners)
+            listener->OnValueChanged(pin, previous, tracked && m_ValueEditChanged);
+
+        if (tracked) {
+            m_ValueEditChanged = true;
+            if (!before)
+                m_ValueEditBefore = pin.connected;
+        }
+    }
+
+    if (ImGui::IsItemDeactivated() && m_ValueEditPin == pin.id)
+        m_ValueEditPin = 0;
+}
+
+// Ends the string edit in progress, if any, changing the value if the text differs. Another string widget
+// can be activated before the one it takes over from reports being deactivated, so it ends the edit too.
+void Editor::CommitStringEdit()
+{
+    auto pin = m_ActiveStringPin ? FindPin(m_ActiveStringPin) : nullptr;
+    m_ActiveStringPin = 0;
+    if (!pin)
+        return;
+
+    auto& value = std::get<NodeStringCustomValueConnection>(pin->connected).value;
+    if (value == m_ActiveStringEdit)
+        return;
+
+    Pin::ConnectionVariant before = pin->connected;
+    value = StringPool::Get().Intern(m_ActiveStringEdit);
+    MarkNodeBoundsDirty(pin->node);
+    for (auto listener : m_Listeners)
+        listener->OnValueChanged(*pin, before, false);
+}
+
 void Editor::OnFrame(ImGuiIO& io)
 {
+    PROFILE_SCOPE("Editor::OnFrame");
     ed::SetCurrentEditor(m_Editor);
     auto windowSize = ImGui::GetWindowSize();
+    auto editorMin = ImGui::GetCursorScreenPos();
+    auto editorSize = ImGui::GetContentRegionAvail();
     ed::Begin("Editor");
 
     ed::PushStyleVar(ax::NodeEditor::StyleVar_LinkStrength, 120.0f);
     auto cursorTopLeft = ImGui::GetCursorScreenPos();
     ImGui::SetCursorScreenPos(cursorTopLeft);
 
+    using Clock = std::chrono::steady_clock;
+    const auto elapsedMs = [](Clock::time_point& since) {
+        auto now = Clock::now();
+        double result = std::chrono::duration<double, std::milli>(now - since).count();
+        since = now;
+        return result;
+    };
+
+    auto phaseStart = Clock::now();
     OnFrame_RenderNodes(io);
+    m_LastFrameTimings.renderNodes = elapsedMs(phaseStart);
+    OnFrame_UpdateSpatialIndex(io);
+    phaseStart = Clock::now();
     OnFrame_RenderLinks(io);
+    m_LastFrameTimings.renderLinks = elapsedMs(phaseStart);
 
     OnFrame_UpdatePendingCreations(io);
+    m_LastFrameTimings.updatePendingCreations = elapsedMs(phaseStart);
     OnFrame_UpdatePendingDeletions(io);
+    m_LastFrameTimings.updatePendingDeletions = elapsedMs(phaseStart);
+    OnFrame_UpdateShortcuts(io);
 
     if (!m_CreatingNewNode) {
         m_NewNodePosition = ImGui::GetMousePos();
     }
     
+    ImVec2 viewMin = ed::ScreenToCanvas(editorMin);
+    ImVec2 viewMax = ed::ScreenToCanvas(editorMin + editorSize);
+
     ed::Suspend();
     OnFrame_RenderNewNodeMenu(io);
 
+    if (m_ShowMinimap) {
+        const ImVec2 minimapSize{ 240.0f, 180.0f };
+        auto minimapMin = editorMin + editorSize - minimapSize - ImVec2(12.0f, 12.0f);
+        if (auto target = m_Minimap.Draw(*this, minimapMin, minimapSize, viewMin, viewMax)) {
+            ed::SelectNode(target);
+            ed::NavigateToSelection();
+        }
+    }
+
     /*
     if (ImGui::BeginPopup("Link Context Menu"))
     {
@@ -287,18 +778,32 @@ void Editor::OnFrame(ImGuiIO& io)
     ed::Resume();
     ed::PopStyleVar();
     ed::End();
+    OnFrame_TrackNodeMoves(io);
+
+    if (!IsHoldingPins() && m_Arena->ShouldCompact())
+        CompactArena();
+
     ed::SetCurrentEditor(nullptr);
 }
 
 void Editor::OnFrame_RenderNodes(ImGuiIO& io)
 {
+    PROFILE_SCOPE("OnFrame_RenderNodes");
+    PROFILE_COUNT(NodesDrawn, m_Nodes.size());
     Util::NodeBuilder builder(m_HeaderBackground, 0, 0);
 
     for (auto& node : m_Nodes)
     {
+        PROFILE_COUNT(PinsDrawn, node.inputs.size() + node.outputs.size());
+        bool highlighted = !m_HighlightedNodes.empty() && std::binary_search(m_HighlightedNodes.begin(), m_HighlightedNodes.end(), node.id, NodeIdLess{});
+        if (highlighted) {
+            ed::PushStyleColor(ed::StyleColor_NodeBorder, node.id == m_FocusedNode ? ImColor(255, 160, 0) : ImColor(255, 220, 80, 160));
+            ed::PushStyleVar(ed::StyleVar_NodeBorderWidth, 3.0f);
+        }
         builder.Begin(node.id);
-        builder.BeginHeader(node.color);
-        ImGui::TextUnformatted(node.name.c_str());
+        auto& nodeName = node.def->name;
+        builder.BeginHeader(ImColor(node.def->color));
+        ImGui::TextUnformatted(nodeName.data(), nodeName.data() + nodeName.size());
         builder.EndHeader();
 
         builder.BeginLeft();
@@ -312,37 +817,63 @@ void Editor::OnFrame_RenderNodes(ImGuiIO& io)
             ImGui::PushStyleVar(ImGuiStyleVar_Alpha, alpha);
 
             if (input.type < PinType::CustomStart) {
-                DrawPinIcon(input, IsPinLinked(input.id), (int)(alpha * 255));
+                DrawPinIcon(input, input.IsLinked(), (int)(alpha * 255));
             }
             else {
                 ImGui::Dummy(ImVec2(static_cast<float>(m_PinIconSize), static_cast<float>(m_PinIconSize)));
             }
             
-            if (!input.name.empty())
+            if (auto& inputName = input.def->name; !inputName.empty())
             {
                 ImGui::SameLine();
-                ImGui::TextUnformatted(input.name.c_str());
+                ImGui::TextUnformatted(inputName.data(), inputName.data() + inputName.size());
             }
 
             ImGui::PopStyleVar();
             builder.EndInput();
 
+            // Values are cheap to copy ahead of the widget (strings are interned views), which matters
+            // because the step buttons change the value on the same frame they activate it.
             switch (input.type) {
             case PinType::CustomInt:
+            {
                 BeginCustomValue(100.0f, input.id.Get());
-                ImGui::InputInt("", &std::get<NodeIntCustomValueConnection>(input.connected).value, 1, 5);
+                Pin::ConnectionVariant before = std::get<NodeIntCustomValueConnection>(input.connected);
+                bool changed = ImGui::InputInt("", &std::get<NodeIntCustomValueConnection>(input.connected).value, 1, 5);
+                TrackValueEdit(input, changed, &before);
                 EndCustomValue();
                 break;
+            }
             case PinType::CustomString:
+            {
                 BeginCustomValue(200.0f, input.id.Get());
-                ImGui::InputText("", &std::get<NodeStringCustomValueConnection>(input.connected).value);
+                // The widget being edited keeps its text in m_ActiveStringEdit until the edit ends, and only
+                // then is the value changed, interned once. The pool never frees, so interning as each key
+                // is typed would keep every intermediate text.
+                bool editing = m_ActiveStringPin == input.id;
+                if (!editing)
+                    m_StringEditBuffer.assign(std::get<NodeStringCustomValueConnection>(input.connected).value);
+                auto& text = editing ? m_ActiveStringEdit : m_StringEditBuffer;
+                ImGui::InputText("", &text);
+                if (ImGui::IsItemActivated() && !editing) {
+                    CommitStringEdit();
+                    m_ActiveStringPin = input.id;
+                    m_ActiveStringEdit = text;
+                }
+                if (ImGui::IsItemDeactivated() && m_ActiveStringPin == input.id)
+                    CommitStringEdit();
                 EndCustomValue();
                 break;
+            }
             case PinType::CustomFloat:
+            {
                 BeginCustomValue(130.0f, input.id.Get());
-                ImGui::InputFloat("", &std::get<NodeFloatCustomValueConnection>(input.connected).value, 0.1f, 0.5f);
+                Pin::ConnectionVariant before = std::get<NodeFloatCustomValueConnection>(input.connected);
+                bool changed = ImGui::InputFloat("", &std::get<NodeFloatCustomValueConnection>(input.connected).value, 0.1f, 0.5f);
+                TrackValueEdit(input, changed, &before);
                 EndCustomValue();
                 break;
+            }
             default:
                 break;
             }
@@ -356,7 +887,8 @@ void Editor::OnFrame_RenderNodes(ImGuiIO& io)
         auto currentSizeBuffer = sizeXBuffer.begin();
         for (auto& output : node.outputs) {
             auto& sizeX = *currentSizeBuffer;
-            sizeX = ImGui::CalcTextSize(output.name.c_str()).x;
+            auto& outputName = output.def->name;
+            sizeX = ImGui::CalcTextSize(outputName.data(), outputName.data() + outputName.size()).x;
             maxSizeX = std::max(sizeX, maxSizeX);
             ++currentSizeBuffer;
         }
@@ -395,9 +927,9 @@ void Editor::OnFrame_RenderNodes(ImGuiIO& io)
                 ImGui::SameLine();
             }
             */
-            ImGui::TextUnformatted(output.name.c_str());
+            ImGui::TextUnformatted(output.def->name.data(), output.def->name.data() + output.def->name.size());
             ImGui::SameLine();
-            DrawPinIcon(output, IsPinLinked(output.id), (int)(alpha * 255));
+            DrawPinIcon(output, output.IsLinked(), (int)(alpha * 255));
             ImGui::PopStyleVar();
             builder.EndOutput();
             ++currentSizeBuffer;
@@ -405,17 +937,46 @@ void Editor::OnFrame_RenderNodes(ImGuiIO& io)
         builder.EndRight();
 
         builder.End();
+        if (highlighted) {
+            ed::PopStyleVar();
+            ed::PopStyleColor();
+        }
+    }
+}
+
+void Editor::OnFrame_UpdateSpatialIndex(ImGuiIO& io)
+{
+    PROFILE_SCOPE("OnFrame_UpdateSpatialIndex");
+    // Nodes only move while the editor drags the current selection, so the index is refreshed
+    // from the selection during drags and from the dirty list for spawns and resizes.
+    if (ImGui::IsMouseDragging(ImGuiMouseButton_Left) || ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
+        auto selectedCount = ed::GetSelectedObjectCount();
+        if (selectedCount > 0) {
+            m_SelectedNodesBuffer.resize(selectedCount);
+            auto nodeCount = ed::GetSelectedNodes(m_SelectedNodesBuffer.data(), selectedCount);
+            m_DirtyNodeBounds.insert(m_DirtyNodeBounds.end(), m_SelectedNodesBuffer.begin(), m_SelectedNodesBuffer.begin() + nodeCount);
+        }
+    }
+
+    for (auto id : m_DirtyNodeBounds) {
+        auto pos = ed::GetNodePosition(id);
+        auto size = ed::GetNodeSize(id);
+        m_SpatialIndex.Update(id.Get(), { pos.x, pos.y, pos.x + size.x, pos.y + size.y });
     }
+    m_DirtyNodeBounds.clear();
 }
 
 void Editor::OnFrame_RenderLinks(ImGuiIO& io)
 {
+    PROFILE_SCOPE("OnFrame_RenderLinks");
+    PROFILE_COUNT(LinksSubmitted, m_Links.size());
     for (auto& link : m_Links)
-        ed::Link(link.id, link.startPinID, link.endPinID, link.color, 2.0f);
+        ed::Link(link.id, link.startPinID, link.endPinID, ImColor(link.color), 2.0f);
 }
 
 void Editor::OnFrame_UpdatePendingCreations(ImGuiIO& io)
 {
+    PROFILE_SCOPE("OnFrame_UpdatePendingCreations");
     if (m_CreatingNewNode)
         return;
 
@@ -496,44 +1057,67 @@ void Editor::OnFrame_UpdatePendingCreations(ImGuiIO& io)
 
 void Editor::OnFrame_UpdatePendingDeletions(ImGuiIO& io)
 {
+    PROFILE_SCOPE("OnFrame_UpdatePendingDeletions");
     if (m_CreatingNewNode)
         return;
 
     if (ed::BeginDelete())
     {
-        ed::NodeId nodeId = 0;
-        while (ed::QueryDeletedNode(&nodeId))
+        // Links go first so that they can still reach the pins of nodes deleted alongside them.
+        m_DeletedLinksBuffer.clear();
+        ed::LinkId linkId = 0;
+        while (ed::QueryDeletedLink(&linkId))
         {
             if (ed::AcceptDeletedItem())
             {
-                DestroyNode(nodeId);
+                m_DeletedLinksBuffer.push_back(linkId);
             }
         }
+        DestroyLinks(m_DeletedLinksBuffer);
 
-        ed::LinkId linkId = 0;
-        while (ed::QueryDeletedLink(&linkId))
+        m_DeletedNodesBuffer.clear();
+        ed::NodeId nodeId = 0;
+        while (ed::QueryDeletedNode(&nodeId))
         {
             if (ed::AcceptDeletedItem())
             {
-                DestroyLink(linkId);
+                m_DeletedNodesBuffer.push_back(nodeId);
             }
         }
+        DestroyNodes(m_DeletedNodesBuffer);
     }
     ed::EndDelete();
 }
 
+void Editor::OnFrame_UpdateShortcuts(ImGuiIO& io)
+{
+    PROFILE_SCOPE("OnFrame_UpdateShortcuts");
+    // Text fields keep their own clipboard.
+    if (ed::BeginShortcut() && !m_CreatingNewNode && !io.WantTextInput)
+    {
+        if (ed::AcceptCopy())
+            CopySelection();
+        else if (ed::AcceptCut())
+            CutSelection();
+        else if (ed::AcceptPaste())
+            Paste();
+        else if (ed::AcceptDuplicate())
+            DuplicateSelection();
+    }
+    ed::EndShortcut();
+}
+
 void Editor::OnFrame_RenderNewNodeMenu(ImGuiIO& io)
 {
+    PROFILE_SCOPE("OnFrame_RenderNewNodeMenu");
     if (ImGui::BeginPopup("Create New Node"))
     {
         ImGui::Dummy(ImVec2(0, 8));
 
         Node* node = nullptr;
-        auto& defs = NodeDefinitions::GetDefList();
-
-        for (auto& d : defs) {
-            if (ImGui::MenuItem(d->name.data()))
-                node = SpawnNode(d);
+        for (auto& d : NodeDefinitions::GetDefs()) {
+            if (ImGui::MenuItem(d.name.data()))
+                node = SpawnNode(&d, m_NewNodePosition);
         }
 
         ImGui::Dummy(ImVec2(0, 8));
@@ -541,7 +1125,6 @@ void Editor::OnFrame_RenderNewNodeMenu(ImGuiIO& io)
         if (node)
         {
             m_CreatingNewNode = false;
-            ed::SetNodePosition(node->id, m_NewNodePosition);
 
             if (m_NewNodeLinkPin) {
                 if (m_NewNodeLinkPin->kind == PinKind::Output) {
@@ -569,3 +1152,42 @@ void Editor::OnFrame_RenderNewNodeMenu(ImGuiIO& io)
         m_CreatingNewNode = false;
     }
 }
+
+void Editor::OnFrame_TrackNodeMoves(ImGuiIO& io)
+{
+    // The node editor only moves nodes by dragging the selection or the node under the cursor,
+    // so the positions of those when the button goes down are where any drag starts from.
+    if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+        m_DragStartPositions.clear();
+        auto selectedCount = ed::GetSelectedObjectCount();
+        int nodeCount = 0;
+        m_SelectedNodesBuffer.resize(selectedCount + 1);
+        if (selectedCount > 0)
+            nodeCount = ed::GetSelectedNodes(m_SelectedNodesBuffer.data(), selectedCount);
+
+        auto hoveredNode = ed::GetHoveredNode();
+        if (hoveredNode && std::find(m_SelectedNodesBuffer.begin(), m_SelectedNodesBuffer.begin() + nodeCount, hoveredNode) == m_SelectedNodesBuffer.begin() + nodeCount)
+            m_SelectedNodesBuffer[nodeCount++] = hoveredNode;
+
+        for (int i = 0; i < nodeCount; i++) {
+            auto position = ed::GetNodePosition(m_SelectedNodesBuffer[i]);
+            m_DragStartPositions.push_back({ m_SelectedNodesBuffer[i], position, position });
+        }
+    }
+
+    if (!ImGui::IsMouseReleased(ImGuiMouseButton_Left) || m_DragStartPositions.empty())
+        return;
+
+    m_NodeMoves.clear();
+    for (auto& start : m_DragStartPositions) {
+        auto position = ed::GetNodePosition(start.id);
+        if (position.x != start.from.x || position.y != start.from.y)
+            m_NodeMoves.push_back({ start.id, start.from, position });
+    }
+    m_DragStartPositions.clear();
+
+    if (!m_NodeMoves.empty()) {
+        for (auto listener : m_Listeners)
+            listener->OnNodesMoved(m_NodeMoves);
+    }
+}
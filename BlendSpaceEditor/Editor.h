@@ -1,45 +1,147 @@
 #pragma once
 #include "ImUtil.h"
+#include "GraphArena.h"
+#include "GraphFile.h"
 #include "imgui-node-editor/imgui_node_editor.h"
 #include "Nodes/NodeTypes.h"
 #include "Nodes/NodeDefinitions.h"
+#include "SpatialIndex.h"
+#include "Minimap.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <span>
 #include <variant>
-#include <functional>
 
 namespace ed = ax::NodeEditor;
 
+struct NodeMove
+{
+    ed::NodeId id;
+    ImVec2 from;
+    ImVec2 to;
+};
+
+// Observes changes to an Editor's graph. Spawns are reported after they happen, destroys just before,
+// so the object is still intact. Every callback runs on the UI thread with the node editor context current.
+class EditorListener
+{
+public:
+    virtual ~EditorListener() = default;
+
+    // m_Nodes and m_Links were replaced wholesale, by a load or InitNew.
+    virtual void OnGraphReset() {}
+    virtual void OnNodeSpawned(const Node& node, const ImVec2& position) {}
+    virtual void OnNodeDestroying(const Node& node) {}
+    virtual void OnLinkSpawned(const Link& link) {}
+    virtual void OnLinkDestroying(const Link& link) {}
+    // before is the value ahead of this change. continuesEdit is set for the second and later changes
+    // made while the same value widget stays active, so that they can be treated as one edit.
+    virtual void OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit) {}
+    virtual void OnNodesMoved(std::span<const NodeMove> moves) {}
+};
+
 class Editor
 {
 public:
+    // Milliseconds spent in each OnFrame phase during the last frame.
+    struct FrameTimings
+    {
+        double renderNodes = 0.0;
+        double renderLinks = 0.0;
+        double updatePendingCreations = 0.0;
+        double updatePendingDeletions = 0.0;
+    };
+
 	Editor();
 	~Editor();
 
+    // Where an ID lives in m_Nodes or m_Links.
+    struct IdLocation
+    {
+        enum class Kind : uint8_t { None, Node, Input, Output, Link };
+
+        uint32_t index = 0;
+        uint16_t slot = 0;
+        Kind kind = Kind::None;
+    };
+
     void InitNew();
+    // Empties the graph and releases its arena. Requires the node editor context to be current.
+    void Clear();
+    // Moves the graph into a fresh arena, reclaiming what the old one lost to destroyed nodes and regrown
+    // lists. Pin pointers into m_Nodes are invalidated, so this must not run while one is held.
+    void CompactArena();
+    // True while a link is being dragged or the new-node menu is open, both of which hold pin pointers. The
+    // graph mustn't be rebuilt, as undo, redo and CompactArena do, until they're done.
+    bool IsHoldingPins() const;
+    // Must be called after replacing m_Nodes/m_Links directly. Requires the node editor context to be current.
+    void NotifyGraphReplaced();
+    void AddListener(EditorListener* listener);
+    void RemoveListener(EditorListener* listener);
     int GetNextId();
     Node* FindNode(ed::NodeId id);
     Link* FindLink(ed::LinkId id);
     Pin* FindPin(ed::PinId id);
     bool IsPinLinked(ed::PinId id);
     bool CanCreateLink(Pin* a, Pin* b);
-    Node* SpawnNode(NodeDefinitions::NodeDef* def);
-    Link* SpawnLink(Pin* startPin, Pin* endPin);
+    Node* SpawnNode(const NodeDefinitions::NodeDef* def, const ImVec2& position);
+    // Adds a node that already has its IDs, such as one read back from the autosave journal.
+    Node* RestoreNode(Node&& node, const ImVec2& position);
+    // Copies the node straight into the arena, as undo restores a snapshot it keeps.
+    Node* RestoreNode(const Node& node, const ImVec2& position);
+    // Indexes, positions and reports a node already placed at index in m_Nodes.
+    Node* RegisterNode(size_t index, const ImVec2& position);
+    // A zero id takes the next free ID.
+    Link* SpawnLink(Pin* startPin, Pin* endPin, ed::LinkId id = 0);
     void DestroyLink(ed::LinkId id);
     void DestroyLinkByIter(std::vector<Link>::iterator& iter);
     void DestroyNode(ed::NodeId id);
-    ImColor GetIconColor(PinType type);
+    // Remove many objects in one pass over m_Links/m_Nodes. Links attached to the nodes must be destroyed first.
+    void DestroyLinks(std::span<const ed::LinkId> ids);
+    void DestroyNodes(std::span<const ed::NodeId> ids);
+    void SetPinValue(Pin& pin, const Pin::ConnectionVariant& value);
+    void MoveNodes(std::span<const NodeMove> moves);
+    // Copies the nodes and the links between them, with IDs renumbered from 1 so that pasting only has to
+    // offset them. Links to nodes outside ids are left out.
+    void CopyNodes(std::span<const ed::NodeId> ids, GraphFile::Graph& clipboard);
+    // Adds a copy of clipboard with fresh IDs, its top left corner at position, and selects it.
+    void PasteNodes(const GraphFile::Graph& clipboard, const ImVec2& position);
+    // Destroys the nodes along with every link attached to them.
+    void DeleteNodes(std::span<const ed::NodeId> ids);
+    // Work on the node editor's selection and m_Clipboard. Require the node editor context to be current.
+    void CopySelection();
+    void CutSelection();
+    void Paste();
+    void DuplicateSelection();
+    std::span<const ed::NodeId> GetSelectedNodes();
+    static ImColor GetIconColor(PinType type);
     void DrawPinIcon(const Pin& pin, bool connected, int alpha);
     void BeginCustomValue(float itemWidth, int id);
     void EndCustomValue();
+    void MarkNodeBoundsDirty(ed::NodeId id);
+    void InvalidateSpatialIndex();
+    void QueryNodesInRect(const ImVec2& min, const ImVec2& max, std::vector<ed::NodeId>& out);
+    ed::NodeId QueryNodeAtPoint(const ImVec2& pos);
+    const IdLocation* LookupId(uintptr_t id);
+    void IndexNode(size_t index);
+    void IndexLink(size_t index);
+    void RebuildIdLookup();
+    void DisconnectLink(const Link& link);
+    void TrackValueEdit(Pin& pin, bool changed, const Pin::ConnectionVariant* before);
+    void CommitStringEdit();
 
     void OnFrame(ImGuiIO& io);
     void OnFrame_RenderNodes(ImGuiIO& io);
     void OnFrame_RenderLinks(ImGuiIO& io);
+    void OnFrame_UpdateSpatialIndex(ImGuiIO& io);
     void OnFrame_UpdatePendingCreations(ImGuiIO& io);
     void OnFrame_UpdatePendingDeletions(ImGuiIO& io);
+    void OnFrame_UpdateShortcuts(ImGuiIO& io);
     void OnFrame_RenderNewNodeMenu(ImGuiIO& io);
+    void OnFrame_TrackNodeMoves(ImGuiIO& io);
 
     //Render Context
     bool m_CreatingNewNode = false;
@@ -54,9 +156,45 @@ public:
 	ed::EditorContext* m_Editor = nullptr;
     int m_LastId = 0;
     const int m_PinIconSize = 24;
-    const std::function<int()> m_NextIdBound = std::bind(&Editor::GetNextId, this);
+    // Backs the pin lists of m_Nodes; declared first so that it outlives them.
+    std::shared_ptr<GraphArena> m_Arena = std::make_shared<GraphArena>();
     std::vector<Node> m_Nodes;
     std::vector<Link> m_Links;
+    SpatialIndex m_SpatialIndex;
+    std::vector<ed::NodeId> m_DirtyNodeBounds;
+    std::vector<ed::NodeId> m_SelectedNodesBuffer;
+    std::vector<uint64_t> m_SpatialQueryBuffer;
+    uint64_t m_GraphRevision = 0;
+    std::vector<EditorListener*> m_Listeners;
+    // Indexed by ID. Appends and erasures keep it current; NotifyGraphReplaced defers a full rebuild to the next lookup.
+    std::vector<IdLocation> m_IdLookup;
+    bool m_IdLookupDirty = true;
+    // Positions of the selection when the left button went down, to report where a drag moved it from.
+    std::vector<NodeMove> m_DragStartPositions;
+    std::vector<NodeMove> m_NodeMoves;
+    std::vector<ed::NodeId> m_DeletedNodesBuffer;
+    std::vector<ed::LinkId> m_DeletedLinksBuffer;
+    GraphFile::Graph m_Clipboard;
+    GraphFile::Graph m_DuplicateBuffer;
+    // Scratch table indexed like m_Nodes, -1 except for the nodes CopyNodes or DeleteNodes is working on.
+    // Only those entries are set and reset, so neither costs anything for the rest of the graph.
+    std::vector<int32_t> m_NodeSlots;
+    // The value widget being edited, and its pin's value before the last change.
+    ed::PinId m_ValueEditPin = 0;
+    bool m_ValueEditChanged = false;
+    Pin::ConnectionVariant m_ValueEditBefore;
+    // Text for the string widgets not being edited, kept so its capacity is reused from frame to frame.
+    std::string m_StringEditBuffer;
+    // The string widget being edited, and its text so far.
+    ed::PinId m_ActiveStringPin = 0;
+    std::string m_ActiveStringEdit;
+    Minimap m_Minimap;
+    bool m_ShowMinimap = true;
+    // Nodes drawn with a highlighted border, such as search results, ordered by NodeIdLess. The focused one
+    // stands out from the rest.
+    std::vector<ed::NodeId> m_HighlightedNodes;
+    ed::NodeId m_FocusedNode = 0;
+    FrameTimings m_LastFrameTimings;
     ImTextureID m_HeaderBackground = nullptr;
     ImTextureID m_SaveIcon = nullptr;
     ImTextureID m_RestoreIcon = nullptr;
@@ -0,0 +1,134 @@
+#include "FileUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    void SetError(std::string* error, const char* what, const std::filesystem::path& path)
+    {
+        if (error)
+            *error = std::string{ what } + " " + path.generic_string();
+    }
+
+    // Unique to each write, so that writers of the same path, in this process or another, never share one.
+    std::filesystem::path GetTempPath(const std::filesystem::path& path)
+    {
+        static std::atomic<uint32_t> nextWrite{ 0 };
+        auto tempPath = path;
+        tempPath += "." + std::to_string(FileUtil_GetProcessId()) + "." + std::to_string(nextWrite++) + ".tmp";
+        return tempPath;
+    }
+}
+
+bool FileUtil_WriteAtomic(const std::filesystem::path& path, std::string_view data, std::string* error)
+{
+    auto tempPath = GetTempPath(path);
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SetError(error, "Failed to create", tempPath);
+        return false;
+    }
+
+    bool written = true;
+    size_t offset = 0;
+    while (written && offset < data.size()) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.size() - offset, 1u << 30));
+        DWORD chunkWritten = 0;
+        written = WriteFile(file, data.data() + offset, chunk, &chunkWritten, nullptr) && chunkWritten == chunk;
+        offset += chunkWritten;
+    }
+    written = written && FlushFileBuffers(file);
+    CloseHandle(file);
+
+    if (!written) {
+        DeleteFileW(tempPath.c_str());
+        SetError(error, "Failed to write", tempPath);
+        return false;
+    }
+
+    if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileW(tempPath.c_str());
+        SetError(error, "Failed to replace", path);
+        return false;
+    }
+#else
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        SetError(error, "Failed to create", tempPath);
+        return false;
+    }
+
+    bool written = true;
+    size_t offset = 0;
+    while (written && offset < data.size()) {
+        auto result = write(fd, data.data() + offset, data.size() - offset);
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        written = result > 0;
+        offset += written ? static_cast<size_t>(result) : 0;
+    }
+    written = written && fsync(fd) == 0;
+    written = close(fd) == 0 && written;
+
+    if (!written) {
+        unlink(tempPath.c_str());
+        SetError(error, "Failed to write", tempPath);
+        return false;
+    }
+
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        unlink(tempPath.c_str());
+        SetError(error, "Failed to replace", path);
+        return false;
+    }
+
+    // Make the rename itself durable.
+    auto directory = path.parent_path().empty() ? std::filesystem::path{ "." } : path.parent_path();
+    int dirFd = open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+#endif
+
+    return true;
+}
+
+uint32_t FileUtil_GetProcessId()
+{
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+bool FileUtil_IsProcessRunning(uint32_t processId)
+{
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (!process)
+        return GetLastError() == ERROR_ACCESS_DENIED;
+
+    DWORD exitCode = 0;
+    bool running = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(process);
+    return running;
+#else
+    return kill(static_cast<pid_t>(processId), 0) == 0 || errno == EPERM;
+#endif
+}
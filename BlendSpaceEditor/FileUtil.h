@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Writes data to a temporary file next to path, flushes it to disk and renames it over path, so readers
+// and crashes only ever see the old or the new contents. Each call uses its own temporary file, so several
+// processes may write the same path at once; the last rename wins. On failure returns false and describes
+// it in error.
+bool FileUtil_WriteAtomic(const std::filesystem::path& path, std::string_view data, std::string* error = nullptr);
+
+uint32_t FileUtil_GetProcessId();
+// Whether a process with this ID exists. IDs are reused, so a stranger's process may be mistaken for it.
+bool FileUtil_IsProcessRunning(uint32_t processId);
@@ -0,0 +1,53 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+double FrameScheduler::SteadyClock::Now() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameScheduler::FrameScheduler(const Clock& clock, double tailDuration, double minFrameInterval) :
+    m_Clock(clock),
+    m_TailDuration(tailDuration),
+    m_MinFrameInterval(minFrameInterval)
+{
+    // Render the first frames unconditionally so the window has content.
+    m_LastFrameTime = m_Clock.Now() - m_MinFrameInterval;
+    m_ActiveUntil = m_Clock.Now() + m_TailDuration;
+}
+
+void FrameScheduler::NotifyActivity()
+{
+    m_ActiveUntil = std::max(m_ActiveUntil, m_Clock.Now() + m_TailDuration);
+}
+
+void FrameScheduler::RequestFrames(double duration)
+{
+    m_ActiveUntil = std::max(m_ActiveUntil, m_Clock.Now() + duration);
+}
+
+void FrameScheduler::SetContinuous(bool continuous)
+{
+    m_Continuous = continuous;
+}
+
+bool FrameScheduler::ShouldRender() const
+{
+    return GetWaitTimeout() == 0.0;
+}
+
+void FrameScheduler::OnFrameRendered()
+{
+    m_LastFrameTime = m_Clock.Now();
+}
+
+double FrameScheduler::GetWaitTimeout() const
+{
+    double now = m_Clock.Now();
+    // One frame is still owed after the active period so the last input is reflected on screen.
+    if (!m_Continuous && m_LastFrameTime >= m_ActiveUntil)
+        return -1.0;
+
+    return std::max(0.0, m_LastFrameTime + m_MinFrameInterval - now);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// Decides when the main loop should render. Frames are produced while there is input, animation or
+// pending work, plus a short tail afterwards so hover states and popups can settle; otherwise the
+// loop can block until the next OS event. Time comes from a Clock so the pacing is platform-independent.
+class FrameScheduler
+{
+public:
+    struct Clock
+    {
+        virtual ~Clock() = default;
+        // Seconds from an arbitrary, monotonic origin.
+        virtual double Now() const = 0;
+    };
+
+    struct SteadyClock : Clock
+    {
+        double Now() const override;
+    };
+
+    explicit FrameScheduler(const Clock& clock, double tailDuration = 0.5, double minFrameInterval = 1.0 / 60.0);
+
+    // Input or window events; keeps frames coming for the tail duration.
+    void NotifyActivity();
+    // Animation or background work that needs frames until at least `duration` seconds from now.
+    void RequestFrames(double duration);
+    // Work that needs frames until it is explicitly finished, e.g. a progress indicator.
+    void SetContinuous(bool continuous);
+
+    bool ShouldRender() const;
+    void OnFrameRendered();
+
+    // Seconds the loop may block waiting for events before the next frame is due. 0 means render
+    // immediately, a negative value means nothing is scheduled and it can wait indefinitely.
+    double GetWaitTimeout() const;
+
+private:
+    const Clock& m_Clock;
+    double m_TailDuration;
+    double m_MinFrameInterval;
+    double m_ActiveUntil;
+    double m_LastFrameTime;
+    bool m_Continuous = false;
+};
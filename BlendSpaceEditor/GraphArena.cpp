@@ -0,0 +1,61 @@
+#include "GraphArena.h"
+
+namespace
+{
+    // The first block; later ones grow geometrically, so even a large load takes only a few dozen.
+    constexpr size_t kInitialBlockSize = 64 * 1024;
+    // Below this, waste isn't worth a pause to reclaim.
+    constexpr size_t kMinCompactBytes = 4 * 1024 * 1024;
+}
+
+void* GraphArena::Upstream::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    reservedBytes += bytes;
+    blocks++;
+    return p;
+}
+
+void GraphArena::Upstream::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool GraphArena::Upstream::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+GraphArena::GraphArena() : m_Buffer(kInitialBlockSize, &m_Upstream)
+{
+}
+
+GraphArena::Stats GraphArena::GetStats() const
+{
+    std::lock_guard lock{ m_Mutex };
+    return { m_AllocatedBytes - m_ReleasedBytes, m_ReleasedBytes, m_Upstream.reservedBytes, m_Upstream.blocks };
+}
+
+bool GraphArena::ShouldCompact() const
+{
+    auto stats = GetStats();
+    return stats.wastedBytes >= kMinCompactBytes && stats.wastedBytes > stats.liveBytes;
+}
+
+void* GraphArena::do_allocate(size_t bytes, size_t alignment)
+{
+    std::lock_guard lock{ m_Mutex };
+    m_AllocatedBytes += bytes;
+    return m_Buffer.allocate(bytes, alignment);
+}
+
+void GraphArena::do_deallocate(void*, size_t bytes, size_t)
+{
+    std::lock_guard lock{ m_Mutex };
+    m_ReleasedBytes += bytes;
+}
+
+bool GraphArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
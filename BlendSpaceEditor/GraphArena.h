@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+// Memory for one document's nodes and pins. Allocating bumps a pointer through large blocks and freeing does
+// nothing, so building a graph costs a few big allocations and dropping the arena releases all of it at once.
+// Memory that's given back (destroyed nodes, pin lists that grew) isn't reused until Editor::CompactArena moves
+// the graph to a fresh arena. Safe to allocate from several threads, as parallel loads do.
+class GraphArena : public std::pmr::memory_resource
+{
+public:
+    struct Stats
+    {
+        // Allocated and not given back.
+        size_t liveBytes = 0;
+        // Given back, and only reclaimed by compaction.
+        size_t wastedBytes = 0;
+        // Taken from the heap, in blocks.
+        size_t reservedBytes = 0;
+        size_t blocks = 0;
+    };
+
+    GraphArena();
+
+    Stats GetStats() const;
+    // Whether enough has been given back for compacting to be worth a full copy of the graph.
+    bool ShouldCompact() const;
+
+private:
+    // Counts the blocks the buffer takes from the heap.
+    class Upstream : public std::pmr::memory_resource
+    {
+    public:
+        size_t reservedBytes = 0;
+        size_t blocks = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    mutable std::mutex m_Mutex;
+    Upstream m_Upstream;
+    std::pmr::monotonic_buffer_resource m_Buffer;
+    size_t m_AllocatedBytes = 0;
+    size_t m_ReleasedBytes = 0;
+};
@@ -0,0 +1,168 @@
+#include "GraphBatch.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace
+{
+    // Nodes per parallel chunk, as for GraphFile::Parse.
+    constexpr size_t kMinNodesPerChunk = 256;
+}
+
+GraphBatch::GraphBatch(Editor& editor) : m_Editor(editor)
+{
+}
+
+void GraphBatch::Reserve(size_t nodeCount, size_t linkCount)
+{
+    m_Nodes.reserve(nodeCount);
+    m_Links.reserve(linkCount);
+}
+
+ed::NodeId GraphBatch::AddNode(const NodeDefinitions::NodeDef* def, const ImVec2& position)
+{
+    if (m_Nodes.empty())
+        m_FirstId = m_NextId = m_Editor.m_LastId + 1;
+
+    auto index = static_cast<uint32_t>(m_Nodes.size());
+    int id = m_NextId;
+    m_Nodes.push_back({ def, position, id });
+    m_NextId += def->GetIdCount();
+
+    m_IdLookup.push_back({ index, 0, Editor::IdLocation::Kind::Node });
+    for (size_t i = 0; i < def->inputs.size(); i++)
+        m_IdLookup.push_back({ index, static_cast<uint16_t>(i), Editor::IdLocation::Kind::Input });
+    for (size_t i = 0; i < def->outputs.size(); i++)
+        m_IdLookup.push_back({ index, static_cast<uint16_t>(i), Editor::IdLocation::Kind::Output });
+
+    return id;
+}
+
+ed::PinId GraphBatch::GetInputId(ed::NodeId node, size_t slot) const
+{
+    return node.Get() + 1 + slot;
+}
+
+ed::PinId GraphBatch::GetOutputId(ed::NodeId node, size_t slot) const
+{
+    auto& pending = m_Nodes[m_IdLookup[node.Get() - m_FirstId].index];
+    return node.Get() + 1 + pending.def->inputs.size() + slot;
+}
+
+void GraphBatch::AddLink(ed::PinId startPinId, ed::PinId endPinId)
+{
+    m_Links.emplace_back(startPinId, endPinId);
+}
+
+size_t GraphBatch::GetNodeCount() const
+{
+    return m_Nodes.size();
+}
+
+size_t GraphBatch::GetLinkCount() const
+{
+    return m_Links.size();
+}
+
+bool GraphBatch::Commit(std::string* error, unsigned maxThreads)
+{
+    PROFILE_SCOPE("GraphBatch::Commit");
+    const auto fail = [this, error](const char* reason) {
+        if (error)
+            *error = reason;
+        Clear();
+        return false;
+    };
+
+    if (!m_Nodes.empty() && m_Editor.m_LastId != m_FirstId - 1)
+        return fail("The graph changed while the batch was being built.");
+
+    int lastId = m_Nodes.empty() ? m_Editor.m_LastId : m_NextId - 1;
+    if (static_cast<int64_t>(lastId) + static_cast<int64_t>(m_Links.size()) > INT32_MAX)
+        return fail("Link ID exceeds maximum value.");
+
+    // Every link is checked before anything is added, against the rules of Editor::CanCreateLink. An input
+    // takes one link, so one that's already linked, or that two links in the batch end at, fails the batch.
+    std::vector<bool> linkedInputs(static_cast<size_t>(lastId) + 1);
+    PinInfo start, end;
+    for (auto& [startPinId, endPinId] : m_Links) {
+        if (!FindPin(startPinId, start) || !FindPin(endPinId, end))
+            return fail("Link refers to a pin that doesn't exist.");
+        if (start.kind != PinKind::Output || end.kind != PinKind::Input || start.type != end.type || end.type >= PinType::CustomStart || start.node == end.node)
+            return fail("Link connects incompatible pins.");
+
+        auto endIndex = static_cast<size_t>(endPinId.Get());
+        if (end.linked || linkedInputs[endIndex])
+            return fail("Link ends at an input that is already linked.");
+        linkedInputs[endIndex] = true;
+    }
+
+    auto& editor = m_Editor;
+    size_t firstIndex = editor.m_Nodes.size();
+    editor.m_Nodes.reserve(firstIndex + m_Nodes.size());
+    editor.m_Links.reserve(editor.m_Links.size() + m_Links.size());
+    if (!editor.m_IdLookupDirty)
+        editor.m_IdLookup.resize(std::max<size_t>(editor.m_IdLookup.size(), static_cast<size_t>(lastId) + m_Links.size() + 1));
+
+    // Nodes are built where they'll stay; only indexing them and telling listeners has to be in order.
+    for (size_t i = 0; i < m_Nodes.size(); i++)
+        editor.m_Nodes.emplace_back(editor.m_Arena.get());
+    {
+        PROFILE_SCOPE("BuildNodes");
+        ThreadPool::Get().ParallelFor(m_Nodes.size(), kMinNodesPerChunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto& node = editor.m_Nodes[firstIndex + i];
+                m_Nodes[i].def->CopyToNode(m_Nodes[i].id, node);
+                node.Build();
+            }
+        }, maxThreads);
+    }
+
+    for (size_t i = 0; i < m_Nodes.size(); i++)
+        editor.RegisterNode(firstIndex + i, m_Nodes[i].position);
+
+    // The inputs are known to be free, so SpawnLink never has to search for a link to replace.
+    int linkId = lastId;
+    for (auto& [startPinId, endPinId] : m_Links)
+        editor.SpawnLink(editor.FindPin(startPinId), editor.FindPin(endPinId), ++linkId);
+
+    Clear();
+    return true;
+}
+
+void GraphBatch::Clear()
+{
+    m_Nodes.clear();
+    m_Links.clear();
+    m_IdLookup.clear();
+    m_FirstId = m_NextId = 0;
+}
+
+bool GraphBatch::FindPin(ed::PinId id, PinInfo& info)
+{
+    auto value = static_cast<int64_t>(id.Get());
+    if (m_Nodes.empty() || value < m_FirstId || value >= m_NextId) {
+        auto pin = m_Editor.FindPin(id);
+        if (!pin)
+            return false;
+
+        info.node = pin->node.Get();
+        info.kind = pin->kind;
+        info.type = pin->type;
+        info.linked = pin->kind == PinKind::Input && pin->type < PinType::CustomStart && std::get<NodeInputConnection>(pin->connected).id;
+        return true;
+    }
+
+    auto& location = m_IdLookup[static_cast<size_t>(value - m_FirstId)];
+    auto& node = m_Nodes[location.index];
+    switch (location.kind) {
+    case Editor::IdLocation::Kind::Input:
+        info = { static_cast<uintptr_t>(node.id), PinKind::Input, node.def->inputs[location.slot].type, false };
+        return true;
+    case Editor::IdLocation::Kind::Output:
+        info = { static_cast<uintptr_t>(node.id), PinKind::Output, node.def->outputs[location.slot].type, false };
+        return true;
+    default:
+        return false;
+    }
+}
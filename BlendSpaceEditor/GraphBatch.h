@@ -0,0 +1,60 @@
+#pragma once
+#include "Editor.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Builds many nodes and links for an Editor at once, for generators and imports. Nothing reaches the editor
+// until Commit, which checks every link first and then constructs all the nodes in parallel, in place in the
+// editor's storage after reserving it once. A batch that fails leaves the graph as it was. Listeners see the
+// same spawns that SpawnNode and SpawnLink would report. The editor's graph must not change between the first
+// Add and Commit.
+class GraphBatch
+{
+public:
+    explicit GraphBatch(Editor& editor);
+
+    void Reserve(size_t nodeCount, size_t linkCount);
+    // IDs are final as soon as they're handed out: the node's, then its inputs' and outputs' in order.
+    ed::NodeId AddNode(const NodeDefinitions::NodeDef* def, const ImVec2& position);
+    // The pins of a node added to this batch.
+    ed::PinId GetInputId(ed::NodeId node, size_t slot) const;
+    ed::PinId GetOutputId(ed::NodeId node, size_t slot) const;
+    // Either pin may belong to this batch or to the editor's graph.
+    void AddLink(ed::PinId startPinId, ed::PinId endPinId);
+    size_t GetNodeCount() const;
+    size_t GetLinkCount() const;
+
+    // Requires the node editor context to be current. Returns false, with the reason in error, if any link
+    // can't be made. Nodes are built on at most maxThreads threads (0 for all). The batch is empty afterwards
+    // either way.
+    bool Commit(std::string* error = nullptr, unsigned maxThreads = 0);
+    void Clear();
+
+private:
+    struct PendingNode
+    {
+        const NodeDefinitions::NodeDef* def;
+        ImVec2 position;
+        int id;
+    };
+
+    struct PinInfo
+    {
+        uintptr_t node = 0;
+        PinKind kind = PinKind::Input;
+        PinType type = PinType::Flow;
+        bool linked = false;
+    };
+
+    bool FindPin(ed::PinId id, PinInfo& info);
+
+    Editor& m_Editor;
+    // The batch's nodes and pins take the IDs from m_FirstId up to m_NextId; links are numbered after them on commit.
+    int m_FirstId = 0;
+    int m_NextId = 0;
+    std::vector<PendingNode> m_Nodes;
+    std::vector<std::pair<ed::PinId, ed::PinId>> m_Links;
+    // Indexed by ID minus m_FirstId.
+    std::vector<Editor::IdLocation> m_IdLookup;
+};
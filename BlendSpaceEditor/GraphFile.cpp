@@ -0,0 +1,241 @@
+#include "GraphFile.h"
+#include "Editor.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	// Nodes per parallel chunk; smaller chunks cost more in scheduling than they gain.
+	constexpr size_t kMinNodesPerChunk = 256;
+	constexpr int32_t kNoNode = -1;
+
+	// Maps node IDs to indices in the node array. IDs are dense after a save compacts them,
+	// so a direct table is used unless the file's IDs are very sparse.
+	class NodeIdTable
+	{
+	public:
+		NodeIdTable(const std::vector<Node>& nodes, size_t maxId)
+		{
+			if (maxId <= nodes.size() * 8 + 1024) {
+				m_Direct.assign(maxId + 1, kNoNode);
+				// Iterate backwards so that the first node wins when a file repeats an ID, like FindNode.
+				for (size_t i = nodes.size(); i-- > 0;)
+					m_Direct[nodes[i].id.Get()] = static_cast<int32_t>(i);
+			}
+			else {
+				m_Sorted.reserve(nodes.size());
+				for (size_t i = 0; i < nodes.size(); i++)
+					m_Sorted.emplace_back(nodes[i].id.Get(), static_cast<int32_t>(i));
+				std::stable_sort(m_Sorted.begin(), m_Sorted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+			}
+		}
+
+		int32_t Find(size_t id) const
+		{
+			if (!m_Sorted.empty()) {
+				auto iter = std::lower_bound(m_Sorted.begin(), m_Sorted.end(), id, [](const auto& entry, size_t value) { return entry.first < value; });
+				return iter != m_Sorted.end() && iter->first == id ? iter->second : kNoNode;
+			}
+			return id < m_Direct.size() ? m_Direct[id] : kNoNode;
+		}
+
+	private:
+		std::vector<int32_t> m_Direct;
+		std::vector<std::pair<size_t, int32_t>> m_Sorted;
+	};
+}
+
+namespace GraphFile
+{
+	void Parse(nlohmann::json& obj, Graph& graph, unsigned maxThreads, ParseStatus* status)
+	{
+		auto& pool = ThreadPool::Get();
+		auto& nodes = obj["nodes"];
+
+		std::vector<nlohmann::json*> nodeObjects;
+		nodeObjects.reserve(nodes.size());
+		for (auto& n : nodes) {
+			if (n.is_object())
+				nodeObjects.push_back(&n);
+		}
+
+		graph.nodes.clear();
+		graph.arena = std::make_shared<GraphArena>();
+		graph.nodes.reserve(nodeObjects.size());
+		for (size_t i = 0; i < nodeObjects.size(); i++)
+			graph.nodes.emplace_back(graph.arena.get());
+		graph.positions.resize(nodeObjects.size());
+		graph.links.clear();
+		if (status)
+			status->nodeCount = nodeObjects.size();
+
+		size_t chunkCount = (nodeObjects.size() + kMinNodesPerChunk - 1) / kMinNodesPerChunk;
+		std::vector<size_t> chunkMaxIds(chunkCount, 0);
+		{
+			PROFILE_SCOPE("FromJson");
+			pool.ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk) {
+				for (size_t chunk = firstChunk; chunk < lastChunk; chunk++) {
+					if (status && status->cancelRequested.load(std::memory_order_relaxed))
+						throw ParseCancelled{};
+
+					size_t begin = chunk * kMinNodesPerChunk;
+					size_t end = std::min(begin + kMinNodesPerChunk, nodeObjects.size());
+					for (size_t i = begin; i < end; i++) {
+						if (!graph.nodes[i].FromJson(*nodeObjects[i], chunkMaxIds[chunk], graph.positions[i])) {
+							throw std::runtime_error{ "Failed to parse node. " };
+						}
+					}
+					if (status)
+						status->nodesParsed.fetch_add(end - begin, std::memory_order_relaxed);
+				}
+			}, maxThreads);
+		}
+
+		if (status && status->cancelRequested.load(std::memory_order_relaxed))
+			throw ParseCancelled{};
+
+		// Pins are numbered after the highest node ID, in node order, exactly as a serial load would.
+		size_t maxNodeId = 0;
+		for (auto id : chunkMaxIds)
+			maxNodeId = std::max(maxNodeId, id);
+
+		std::vector<size_t> firstPinIds(graph.nodes.size());
+		size_t lastId = maxNodeId;
+		for (size_t i = 0; i < graph.nodes.size(); i++) {
+			firstPinIds[i] = lastId + 1;
+			lastId += graph.nodes[i].inputs.size() + graph.nodes[i].outputs.size();
+		}
+
+		if (lastId > INT32_MAX) {
+			throw std::runtime_error{ "[P] Node ID exceeds maximum value." };
+		}
+
+		pool.ParallelFor(graph.nodes.size(), kMinNodesPerChunk, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				size_t pinId = firstPinIds[i];
+				for (auto& input : graph.nodes[i].inputs)
+					input.id = pinId++;
+				for (auto& output : graph.nodes[i].outputs)
+					output.id = pinId++;
+			}
+		}, maxThreads);
+
+		PROFILE_SCOPE("ResolveLinks");
+		NodeIdTable nodeIds{ graph.nodes, maxNodeId };
+
+		// Each input only writes to itself here; the output side and the links are filled in below
+		// in node order, so link IDs and output connection order don't depend on scheduling.
+		pool.ParallelFor(graph.nodes.size(), kMinNodesPerChunk, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				for (auto& input : graph.nodes[i].inputs) {
+					if (input.type >= PinType::CustomStart)
+						continue;
+
+					auto& connected = std::get<NodeInputConnection>(input.connected);
+					auto targetIndex = nodeIds.Find(connected.nodeId.Get());
+					if (targetIndex == kNoNode)
+						continue;
+
+					for (auto& output : graph.nodes[targetIndex].outputs) {
+						if (output.def->typeName == connected.typeName) {
+							connected.id = output.id;
+							break;
+						}
+					}
+				}
+			}
+		}, maxThreads);
+
+		size_t nextLinkId = lastId;
+		for (auto& node : graph.nodes) {
+			for (auto& input : node.inputs) {
+				if (input.type >= PinType::CustomStart)
+					continue;
+
+				auto& connected = std::get<NodeInputConnection>(input.connected);
+				if (!connected.id)
+					continue;
+
+				auto& target = graph.nodes[nodeIds.Find(connected.nodeId.Get())];
+				for (auto& output : target.outputs) {
+					if (output.id == connected.id) {
+						std::get<NodeOutputConnection>(output.connected).ids.push_back(input.id);
+						break;
+					}
+				}
+				if (++nextLinkId > INT32_MAX) {
+					throw std::runtime_error{ "[L] Link ID exceeds maximum value." };
+				}
+				graph.links.emplace_back(static_cast<int>(nextLinkId), connected.id, input.id);
+				graph.links.back().color = Editor::GetIconColor(input.type);
+			}
+		}
+
+		graph.lastId = static_cast<int>(nextLinkId);
+	}
+
+	void Apply(Editor& editor, Graph&& graph)
+	{
+		// The old nodes go before the old arena, which then frees their memory in one go.
+		editor.m_Nodes = std::move(graph.nodes);
+		editor.m_Arena = graph.arena ? std::move(graph.arena) : std::make_shared<GraphArena>();
+		editor.m_Links = std::move(graph.links);
+		editor.m_LastId = graph.lastId;
+
+		for (size_t i = 0; i < editor.m_Nodes.size(); i++)
+			ed::SetNodePosition(editor.m_Nodes[i].id, graph.positions[i]);
+
+		editor.NotifyGraphReplaced();
+	}
+
+	void Load(Editor& editor, nlohmann::json& obj, unsigned maxThreads)
+	{
+		Graph graph;
+		try {
+			Parse(obj, graph, maxThreads);
+		}
+		catch (...) {
+			editor.Clear();
+			throw;
+		}
+
+		Apply(editor, std::move(graph));
+	}
+
+	void Capture(Editor& editor, Graph& graph)
+	{
+		PROFILE_SCOPE("CaptureGraph");
+		// Copied into an arena of its own, so the pin lists take a few large blocks rather than several heap
+		// allocations per node, and the copy is released in one go once saved.
+		graph.nodes.clear();
+		graph.arena = std::make_shared<GraphArena>();
+		graph.nodes.reserve(editor.m_Nodes.size());
+		for (auto& node : editor.m_Nodes)
+			graph.nodes.emplace_back(node, graph.arena.get());
+		graph.links = editor.m_Links;
+		graph.lastId = editor.m_LastId;
+		graph.positions.resize(graph.nodes.size());
+		for (size_t i = 0; i < graph.nodes.size(); i++)
+			graph.positions[i] = ed::GetNodePosition(graph.nodes[i].id);
+	}
+
+	void Serialize(const Graph& graph, nlohmann::json& obj)
+	{
+		obj["version"] = 1;
+
+		auto& nodes = obj["nodes"];
+		for (size_t i = 0; i < graph.nodes.size(); i++) {
+			graph.nodes[i].ToJson(nodes.emplace_back(), graph.positions[i]);
+		}
+		Node::CompactJsonIds(nodes);
+	}
+
+	void Save(Editor& editor, nlohmann::json& obj)
+	{
+		Graph graph;
+		Capture(editor, graph);
+		Serialize(graph, obj);
+	}
+}
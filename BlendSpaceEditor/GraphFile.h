@@ -0,0 +1,60 @@
+#pragma once
+#include "imgui.h"
+#include "GraphArena.h"
+#include "Nodes/NodeTypes.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+class Editor;
+
+// Conversion between the editor's graph and the .bt JSON document, independent of any file or UI handling.
+namespace GraphFile
+{
+	// A graph read from a document but not yet handed to an editor. Building one doesn't touch
+	// the node editor, so it can happen on any thread.
+	struct Graph
+	{
+		// Backs the nodes Parse and Capture build, and becomes the editor's arena on Apply. Null for other
+		// copies of a graph, whose nodes use the heap. Declared first so that it outlives the nodes.
+		std::shared_ptr<GraphArena> arena;
+		std::vector<Node> nodes;
+		// Canvas position of each node, in the same order as nodes.
+		std::vector<ImVec2> positions;
+		std::vector<Link> links;
+		int lastId = 0;
+	};
+
+	// Lets another thread follow and cancel a Parse.
+	struct ParseStatus
+	{
+		std::atomic<bool> cancelRequested{ false };
+		std::atomic<size_t> nodesParsed{ 0 };
+		std::atomic<size_t> nodeCount{ 0 };
+	};
+
+	struct ParseCancelled : std::runtime_error
+	{
+		ParseCancelled() : std::runtime_error{ "Load cancelled." } {}
+	};
+
+	// Builds nodes in parallel chunks on ThreadPool::Get(), using at most maxThreads threads (0 for all).
+	// The result is identical for any thread count. Throws std::exception on malformed input, and
+	// ParseCancelled soon after status->cancelRequested is set.
+	void Parse(nlohmann::json& obj, Graph& graph, unsigned maxThreads = 0, ParseStatus* status = nullptr);
+	// Replaces the editor's graph with graph, positioning all nodes in one pass.
+	// Requires the editor's node editor context to be current.
+	void Apply(Editor& editor, Graph&& graph);
+
+	// Parse followed by Apply. On malformed input, throws and leaves the editor's graph empty.
+	void Load(Editor& editor, nlohmann::json& obj, unsigned maxThreads = 0);
+
+	// Copies the editor's graph and node positions, so it can be serialized on another thread while editing
+	// continues. Requires the editor's node editor context to be current.
+	void Capture(Editor& editor, Graph& graph);
+	void Serialize(const Graph& graph, nlohmann::json& obj);
+	// Capture followed by Serialize.
+	void Save(Editor& editor, nlohmann::json& obj);
+}
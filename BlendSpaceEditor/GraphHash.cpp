@@ -0,0 +1,327 @@
+#include "GraphHash.h"
+#include "Nodes/NodeDefinitions.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <xxhash.h>
+
+namespace GraphHash
+{
+	namespace
+	{
+		// Each instance draws its own random values, so two with the same settings still differ.
+		constexpr std::string_view kUnmergeableTypes[] = { "smooth_rand" };
+
+		// Written before each piece of content, so that differently shaped nodes can't hash alike.
+		enum class Tag : uint8_t
+		{
+			Unlinked,
+			Linked,
+			Pending,
+			Float,
+			Int,
+			String
+		};
+
+		class HashBuffer
+		{
+		public:
+			void Clear() { m_Data.clear(); }
+
+			template <typename T>
+			void Append(const T& value)
+			{
+				m_Data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+			}
+
+			void Append(std::string_view text)
+			{
+				Append(static_cast<uint64_t>(text.size()));
+				m_Data.append(text);
+			}
+
+			uint64_t Hash() const { return XXH3_64bits(m_Data.data(), m_Data.size()); }
+
+		private:
+			std::string m_Data;
+		};
+
+		void AppendValue(HashBuffer& buffer, const Pin& pin)
+		{
+			switch (pin.type) {
+			case PinType::CustomFloat:
+				buffer.Append(Tag::Float);
+				buffer.Append(std::bit_cast<uint32_t>(std::get<NodeFloatCustomValueConnection>(pin.connected).value));
+				break;
+			case PinType::CustomInt:
+				buffer.Append(Tag::Int);
+				buffer.Append(std::get<NodeIntCustomValueConnection>(pin.connected).value);
+				break;
+			case PinType::CustomString:
+				buffer.Append(Tag::String);
+				buffer.Append(std::get<NodeStringCustomValueConnection>(pin.connected).value);
+				break;
+			default:
+				break;
+			}
+		}
+
+		bool SameValue(const Pin& a, const Pin& b)
+		{
+			switch (a.type) {
+			case PinType::CustomFloat:
+				return std::bit_cast<uint32_t>(std::get<NodeFloatCustomValueConnection>(a.connected).value) == std::bit_cast<uint32_t>(std::get<NodeFloatCustomValueConnection>(b.connected).value);
+			case PinType::CustomInt:
+				return std::get<NodeIntCustomValueConnection>(a.connected).value == std::get<NodeIntCustomValueConnection>(b.connected).value;
+			case PinType::CustomString:
+				return std::get<NodeStringCustomValueConnection>(a.connected).value == std::get<NodeStringCustomValueConnection>(b.connected).value;
+			default:
+				return true;
+			}
+		}
+
+		bool IsMergeable(const Node& node)
+		{
+			return std::find(std::begin(kUnmergeableTypes), std::end(kUnmergeableTypes), node.def->typeName) == std::end(kUnmergeableTypes);
+		}
+	}
+
+	Hashes Compute(const GraphFile::Graph& graph)
+	{
+		PROFILE_SCOPE("GraphHash::Compute");
+		auto& nodes = graph.nodes;
+		auto count = static_cast<uint32_t>(nodes.size());
+		Hashes hashes;
+
+		hashes.firstInput.resize(count + 1);
+		size_t inputCount = 0, outputCount = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			hashes.firstInput[i] = static_cast<uint32_t>(inputCount);
+			inputCount += nodes[i].inputs.size();
+			outputCount += nodes[i].outputs.size();
+		}
+		hashes.firstInput[count] = static_cast<uint32_t>(inputCount);
+
+		std::unordered_map<uintptr_t, Source> outputs;
+		outputs.reserve(outputCount);
+		for (uint32_t i = 0; i < count; i++) {
+			for (uint32_t slot = 0; slot < nodes[i].outputs.size(); slot++)
+				outputs.emplace(nodes[i].outputs[slot].id.Get(), Source{ i, slot });
+		}
+
+		// Resolve every link, counting each node's consumers and its inputs from other nodes.
+		hashes.sources.resize(inputCount);
+		std::vector<uint32_t> unhashedInputs(count, 0);
+		std::vector<uint32_t> consumerOffsets(count + 1, 0);
+		for (uint32_t i = 0; i < count; i++) {
+			for (size_t slot = 0; slot < nodes[i].inputs.size(); slot++) {
+				auto& input = nodes[i].inputs[slot];
+				if (input.type >= PinType::CustomStart)
+					continue;
+
+				auto& connected = std::get<NodeInputConnection>(input.connected);
+				auto iter = connected.id ? outputs.find(connected.id.Get()) : outputs.end();
+				if (iter == outputs.end())
+					continue;
+
+				hashes.sources[hashes.firstInput[i] + slot] = iter->second;
+				if (iter->second.node != i) {
+					unhashedInputs[i]++;
+					consumerOffsets[iter->second.node + 1]++;
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < count; i++)
+			consumerOffsets[i + 1] += consumerOffsets[i];
+		std::vector<uint32_t> consumers(consumerOffsets[count]);
+		{
+			auto next = consumerOffsets;
+			for (uint32_t i = 0; i < count; i++) {
+				for (auto& source : hashes.GetSources(i)) {
+					if (source.node != kNoNode && source.node != i)
+						consumers[next[source.node]++] = i;
+				}
+			}
+		}
+
+		hashes.order.reserve(count);
+		for (uint32_t i = 0; i < count; i++) {
+			if (!unhashedInputs[i])
+				hashes.order.push_back(i);
+		}
+		for (size_t next = 0; next < hashes.order.size(); next++) {
+			auto node = hashes.order[next];
+			for (auto i = consumerOffsets[node]; i < consumerOffsets[node + 1]; i++) {
+				if (--unhashedInputs[consumers[i]] == 0)
+					hashes.order.push_back(consumers[i]);
+			}
+		}
+
+		hashes.acyclic.assign(count, false);
+		for (auto node : hashes.order)
+			hashes.acyclic[node] = true;
+		for (uint32_t i = 0; i < count; i++) {
+			if (!hashes.acyclic[i])
+				hashes.order.push_back(i);
+		}
+
+		hashes.local.resize(count);
+		hashes.tree.resize(count);
+		std::vector<bool> hashed(count, false);
+		HashBuffer buffer;
+		for (auto node : hashes.order) {
+			buffer.Clear();
+			buffer.Append(nodes[node].def->typeName);
+			for (auto& input : nodes[node].inputs)
+				AppendValue(buffer, input);
+			hashes.local[node] = buffer.Hash();
+
+			buffer.Clear();
+			buffer.Append(hashes.local[node]);
+			for (auto& source : hashes.GetSources(node)) {
+				if (source.node == kNoNode) {
+					buffer.Append(Tag::Unlinked);
+				}
+				else if (!hashed[source.node]) {
+					buffer.Append(Tag::Pending);
+				}
+				else {
+					buffer.Append(Tag::Linked);
+					buffer.Append(hashes.tree[source.node]);
+					buffer.Append(source.output);
+				}
+			}
+			hashes.tree[node] = buffer.Hash();
+			hashed[node] = true;
+		}
+
+		return hashes;
+	}
+
+	size_t Deduplicate(GraphFile::Graph& graph)
+	{
+		PROFILE_SCOPE("GraphHash::Deduplicate");
+		auto hashes = Compute(graph);
+		auto& nodes = graph.nodes;
+		auto count = static_cast<uint32_t>(nodes.size());
+
+		// Hashes only find candidates; nodes are merged when their content matches exactly and their inputs
+		// come from the same outputs of nodes that were themselves merged, which producers-first order settles.
+		std::vector<uint32_t> representative(count);
+		std::iota(representative.begin(), representative.end(), 0u);
+		const auto sameSubTree = [&](uint32_t a, uint32_t b) {
+			if (nodes[a].def != nodes[b].def)
+				return false;
+
+			auto sourcesA = hashes.GetSources(a);
+			auto sourcesB = hashes.GetSources(b);
+			for (size_t slot = 0; slot < sourcesA.size(); slot++) {
+				if (!SameValue(nodes[a].inputs[slot], nodes[b].inputs[slot]))
+					return false;
+
+				auto& sourceA = sourcesA[slot];
+				auto& sourceB = sourcesB[slot];
+				if (sourceA.node == kNoNode || sourceB.node == kNoNode) {
+					if (sourceA.node != sourceB.node)
+						return false;
+				}
+				else if (representative[sourceA.node] != representative[sourceB.node] || sourceA.output != sourceB.output) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		// Kept nodes by tree hash, chained through nextWithHash.
+		std::unordered_map<uint64_t, uint32_t> firstWithHash;
+		std::vector<uint32_t> nextWithHash(count, kNoNode);
+		firstWithHash.reserve(count);
+		size_t removed = 0;
+		for (auto node : hashes.order) {
+			if (!hashes.acyclic[node] || !IsMergeable(nodes[node]))
+				continue;
+
+			auto [iter, inserted] = firstWithHash.try_emplace(hashes.tree[node], node);
+			if (inserted)
+				continue;
+
+			for (auto candidate = iter->second; candidate != kNoNode; candidate = nextWithHash[candidate]) {
+				if (sameSubTree(node, candidate)) {
+					representative[node] = candidate;
+					removed++;
+					break;
+				}
+			}
+			if (representative[node] == node) {
+				nextWithHash[node] = iter->second;
+				iter->second = node;
+			}
+		}
+
+		if (!removed)
+			return 0;
+
+		// Relink the inputs of the kept nodes, then rebuild the output connections and links from them.
+		std::unordered_map<uintptr_t, size_t> linkByEnd;
+		linkByEnd.reserve(graph.links.size());
+		for (size_t i = 0; i < graph.links.size(); i++)
+			linkByEnd.emplace(graph.links[i].endPinID.Get(), i);
+
+		for (uint32_t i = 0; i < count; i++) {
+			if (representative[i] != i)
+				continue;
+			for (auto& output : nodes[i].outputs)
+				std::get<NodeOutputConnection>(output.connected).ids.clear();
+		}
+
+		std::vector<Link> links;
+		links.reserve(graph.links.size());
+		for (uint32_t i = 0; i < count; i++) {
+			if (representative[i] != i)
+				continue;
+
+			auto sources = hashes.GetSources(i);
+			for (size_t slot = 0; slot < sources.size(); slot++) {
+				if (sources[slot].node == kNoNode)
+					continue;
+
+				auto& input = nodes[i].inputs[slot];
+				auto& source = nodes[representative[sources[slot].node]];
+				auto& output = source.outputs[sources[slot].output];
+				auto& connected = std::get<NodeInputConnection>(input.connected);
+				connected.id = output.id;
+				connected.nodeId = source.id;
+				std::get<NodeOutputConnection>(output.connected).ids.push_back(input.id);
+
+				if (auto iter = linkByEnd.find(input.id.Get()); iter != linkByEnd.end()) {
+					auto& link = links.emplace_back(graph.links[iter->second]);
+					link.startPinID = output.id;
+				}
+			}
+		}
+		graph.links = std::move(links);
+
+		bool hasPositions = graph.positions.size() == nodes.size();
+		size_t kept = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			if (representative[i] != i)
+				continue;
+
+			if (kept != i) {
+				nodes[kept] = std::move(nodes[i]);
+				if (hasPositions)
+					graph.positions[kept] = graph.positions[i];
+			}
+			kept++;
+		}
+		nodes.erase(nodes.begin() + kept, nodes.end());
+		if (hasPositions)
+			graph.positions.resize(kept);
+
+		return removed;
+	}
+}
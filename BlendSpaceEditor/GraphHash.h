@@ -0,0 +1,48 @@
+#pragma once
+#include "GraphFile.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Structural hashes of a graph's nodes, which don't depend on IDs or positions, for comparing versions of a
+// graph and finding repeated sub-trees.
+namespace GraphHash
+{
+	constexpr uint32_t kNoNode = UINT32_MAX;
+
+	// The node, by index in Graph::nodes, and output that an input is linked to.
+	struct Source
+	{
+		uint32_t node = kNoNode;
+		uint32_t output = 0;
+	};
+
+	struct Hashes
+	{
+		// Each node's own content: its type and custom values.
+		std::vector<uint64_t> local;
+		// Each node's sub-tree: its local hash and, for every input in order, the tree hash and output of the
+		// node it's linked to. Two nodes with equal tree hashes compute the same thing.
+		std::vector<uint64_t> tree;
+		// Producers before consumers. Nodes on a cycle, or fed by one, come last in graph order; a linked input
+		// whose source isn't hashed yet contributes a fixed marker instead.
+		std::vector<uint32_t> order;
+		std::vector<bool> acyclic;
+		// The sources of node i's inputs are sources[firstInput[i]] onwards, one per input pin.
+		std::vector<uint32_t> firstInput;
+		std::vector<Source> sources;
+
+		std::span<const Source> GetSources(size_t node) const
+		{
+			return { sources.data() + firstInput[node], sources.data() + firstInput[node + 1] };
+		}
+	};
+
+	// One pass over the graph in topological order.
+	Hashes Compute(const GraphFile::Graph& graph);
+
+	// Merges every set of nodes whose sub-trees are identical into the first of them, relinking their consumers
+	// to it, and returns how many nodes were removed. Nodes on cycles, and types whose instances each produce
+	// different output, like Smoothed Random Value, are kept apart.
+	size_t Deduplicate(GraphFile::Graph& graph);
+}
@@ -1,8 +1,10 @@
 #pragma once
 #include "Drawing.h"
-#include <Windows.h>
 #include <vector>
 
+#ifdef _WIN32
+#include <Windows.h>
+
 inline ImFont* ImGui_LoadWindowsFont(const char* fontName, float fontSize, ImGuiIO& io)
 {
     // Create a temporary DC
@@ -58,6 +60,7 @@ inline ImFont* ImGui_LoadWindowsFont(const char* fontName, float fontSize, ImGui
     fontConfig.OversampleV = 2;
     return io.Fonts->AddFontFromMemoryTTF(buffer.data(), size, fontSize, &fontConfig);
 }
+#endif
 
 static inline ImRect ImGui_GetItemRect()
 {
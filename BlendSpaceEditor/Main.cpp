@@ -1,8 +1,17 @@
 #include "Main.h"
 #include "Editor.h"
+#include "GraphFile.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "AsyncGraphLoad.h"
+#include "AsyncGraphSaver.h"
+#include "AutosaveJournal.h"
+#include "SearchIndex.h"
+#include "UndoHistory.h"
+#include "imgui_stdlib.h"
 #include <memory>
 #include "Win32Util.h"
-#include <fstream>
+#include <ctime>
 
 namespace ed = ax::NodeEditor;
 
@@ -17,6 +26,52 @@ namespace Main
     std::string g_statusText{ "" };
     std::filesystem::path g_curPath{ L"" };
     std::filesystem::path pendingOpenFile{ L"" };
+    bool g_showProfiler{ false };
+    std::unique_ptr<AsyncGraphLoad> g_pendingLoad{ nullptr };
+    std::vector<std::unique_ptr<AsyncGraphLoad>> g_cancelledLoads;
+    std::unique_ptr<AsyncGraphSaver> g_saver{ nullptr };
+    std::unique_ptr<AutosaveJournal> g_journal{ nullptr };
+    std::unique_ptr<UndoHistory> g_history{ nullptr };
+    std::unique_ptr<SearchIndex> g_searchIndex{ nullptr };
+    std::string g_searchQuery;
+    // What g_searchResults were found for.
+    std::string g_searchedQuery;
+    uint64_t g_searchedRevision{ UINT64_MAX };
+    std::vector<ed::NodeId> g_searchResults;
+    // The result last jumped to, or SIZE_MAX before the first jump.
+    size_t g_searchCurrent{ SIZE_MAX };
+    bool g_focusSearch{ false };
+    ImTextureID(*updateTexture)(ImTextureID texture, const void* pixels, int width, int height) { nullptr };
+
+    void UpdatePendingSaves();
+
+    // Offers to restore changes to the document that a crash kept from being saved, then starts journaling it.
+    void OpenJournal(const std::filesystem::path& documentPath)
+    {
+        auto journalPath = AutosaveJournal::GetJournalPath(documentPath);
+        // Each instance journals its untitled document under its own name, so one left by a crash is looked for.
+        auto previousPath = documentPath.empty() ? AutosaveJournal::FindAbandonedJournal() : journalPath;
+        bool recovered = false;
+        if (!previousPath.empty() && AutosaveJournal::HasUnsavedChanges(previousPath)) {
+            auto documentName = documentPath.empty() ? std::string{ "The untitled document" } : documentPath.filename().generic_string();
+            auto message = std::format("{} has changes from a previous session that were never saved. Recover them?", documentName);
+            if (MessageBoxA(g_MainHWND, message.c_str(), "Recover Changes", MB_YESNO | MB_ICONQUESTION) == IDYES) {
+                std::string error;
+                ed::SetCurrentEditor(g_mainEditor->m_Editor);
+                recovered = AutosaveJournal::Recover(*g_mainEditor, previousPath, &error);
+                ed::SetCurrentEditor(nullptr);
+                if (!recovered) {
+                    MessageBoxA(g_MainHWND, error.c_str(), "Error", 0);
+                }
+            }
+        }
+        g_journal->Open(journalPath, recovered);
+        // Recovered or not, the new journal takes over from the abandoned one.
+        if (previousPath != journalPath && !previousPath.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(previousPath, ec);
+        }
+    }
 
 	void OnStart(ImGuiIO& io)
 	{
@@ -28,10 +83,29 @@ namespace Main
         g_mainFontSmall = ImGui_LoadWindowsFont("Arial", 16.0f, io);
         g_mainFontMedium = ImGui_LoadWindowsFont("Arial", 18.5f, io);
         g_mainEditor = std::make_unique<Editor>();
+        g_saver = std::make_unique<AsyncGraphSaver>();
+        g_journal = std::make_unique<AutosaveJournal>(*g_mainEditor);
+        g_history = std::make_unique<UndoHistory>(*g_mainEditor);
+        g_searchIndex = std::make_unique<SearchIndex>(*g_mainEditor);
+        Trace::SetThreadName("Main");
+
+        if (pendingOpenFile.empty())
+            OpenJournal({});
 	}
 
 	void OnStop(ImGuiIO& io)
 	{
+        g_pendingLoad.reset();
+        g_cancelledLoads.clear();
+        // Waits for an in-flight save so quitting right after Ctrl+S doesn't lose it, and so the journal is kept
+        // should that save fail.
+        g_saver->Finish();
+        UpdatePendingSaves();
+        g_saver.reset();
+        g_journal->Close();
+        g_journal.reset();
+        g_history.reset();
+        g_searchIndex.reset();
         g_mainEditor.reset();
 	}
 
@@ -46,131 +120,137 @@ namespace Main
         return oss.str();
     }
 
+    // Only the snapshot is taken here; serializing and writing happen on the saver's thread.
     void SaveData(const std::filesystem::path& filePath)
     {
+        PROFILE_SCOPE("SaveData");
+        GraphFile::Graph graph;
         ed::SetCurrentEditor(g_mainEditor->m_Editor);
-        nlohmann::json obj;
-        obj["version"] = 1;
+        GraphFile::Capture(*g_mainEditor, graph);
+        ed::SetCurrentEditor(nullptr);
 
-        auto& nodes = obj["nodes"];
-        for (auto& node : g_mainEditor->m_Nodes) {
-            node.ToJson(nodes.emplace_back());
+        // Save As moves the journal along, leaving none behind for the old document. The new one holds unsaved
+        // changes until the save's result says otherwise.
+        auto revision = g_journal->GetRevision();
+        auto journalPath = AutosaveJournal::GetJournalPath(filePath);
+        if (g_journal->GetPath() != journalPath) {
+            bool unsaved = g_journal->HasUnsavedChanges();
+            g_journal->MarkSaved(revision);
+            g_journal->Open(journalPath, unsaved);
         }
-        Node::CompactJsonIds(nodes);
 
-        std::ofstream outFile{ filePath };
-        if (!outFile.is_open() || !outFile.good()) {
-            MessageBoxA(g_MainHWND, "Failed to save file.", "Error", 0);
-            return;
-        }
-        outFile << obj.dump();
+        g_saver->Submit(filePath, std::move(graph), revision);
+        g_statusText = std::format("Saving {}...", filePath.generic_string());
+    }
+
+    // Writes a copy with identical sub-trees merged. The document and its journal stay as they are.
+    void ExportDeduplicated(const std::filesystem::path& filePath)
+    {
+        PROFILE_SCOPE("ExportDeduplicated");
+        GraphFile::Graph graph;
+        ed::SetCurrentEditor(g_mainEditor->m_Editor);
+        GraphFile::Capture(*g_mainEditor, graph);
         ed::SetCurrentEditor(nullptr);
 
-        g_statusText = std::format("Saved {} at {}", filePath.generic_string(), GetCurrentClockTime());
+        g_saver->Submit(filePath, std::move(graph), g_journal->GetRevision(), true);
+        g_statusText = std::format("Exporting {}...", filePath.generic_string());
+    }
+
+    void UpdatePendingSaves()
+    {
+        for (auto& result : g_saver->TakeResults()) {
+            if (!result.error.empty()) {
+                MessageBoxA(g_MainHWND, result.error.c_str(), "Error", 0);
+                if (!result.deduplicated)
+                    g_journal->MarkUnsaved();
+                g_statusText = "";
+                continue;
+            }
+            if (result.deduplicated) {
+                g_statusText = std::format("Exported {} with {} nodes merged at {}", result.path.generic_string(), result.mergedNodes, GetCurrentClockTime());
+                continue;
+            }
+            // A save of a document since replaced, or of a graph changed since, leaves the journal as it is.
+            if (result.path == g_curPath)
+                g_journal->MarkSaved(result.revision);
+            g_statusText = std::format("Saved {} at {}", result.path.generic_string(), GetCurrentClockTime());
+        }
     }
 
     void LoadData(const std::filesystem::path& filePath)
     {
-        std::ifstream inFile{ filePath };
-        if (!inFile.is_open() || !inFile.good()) {
-            MessageBoxA(g_MainHWND, "Failed to open file.", "Error", 0);
-            return;
+        PROFILE_SCOPE("LoadData");
+        // Superseded loads are cancelled and reaped once their worker exits, so this never waits.
+        if (g_pendingLoad) {
+            g_pendingLoad->Cancel();
+            g_cancelledLoads.push_back(std::move(g_pendingLoad));
         }
+        g_pendingLoad = std::make_unique<AsyncGraphLoad>(filePath);
+    }
 
-        nlohmann::json obj;
-        try {
-            obj = nlohmann::json::parse(inFile);
+    void CancelLoad()
+    {
+        if (g_pendingLoad) {
+            g_pendingLoad->Cancel();
+            g_cancelledLoads.push_back(std::move(g_pendingLoad));
         }
-        catch (const std::exception& ex) {
-            MessageBoxA(g_MainHWND, std::format("Failed to parse blend graph file. Error: {}", ex.what()).c_str(), "Error", 0);
+    }
+
+    // Hands a finished load to the editor. Runs at the start of a frame, before anything reads the graph.
+    void UpdatePendingLoad()
+    {
+        std::erase_if(g_cancelledLoads, [](const auto& load) { return load->IsDone(); });
+
+        if (!g_pendingLoad || !g_pendingLoad->IsDone())
             return;
+
+        auto load = std::move(g_pendingLoad);
+        if (!load->WasCancelled() && !load->GetError().empty()) {
+            MessageBoxA(g_MainHWND, load->GetError().c_str(), "Error", 0);
         }
 
-        g_mainEditor->m_Nodes.clear();
-        g_mainEditor->m_Links.clear();
+        if (load->WasCancelled() || !load->GetError().empty()) {
+            // A file opened at startup that fails to load leaves the untitled document unjournaled.
+            if (g_journal->GetPath().empty())
+                OpenJournal(g_curPath);
+            return;
+        }
 
-        bool successful = true;
+        PROFILE_SCOPE("ApplyLoadedGraph");
+        g_journal->Close();
         ed::SetCurrentEditor(g_mainEditor->m_Editor);
-        try {
-            auto& nodes = obj["nodes"];
-            size_t lastId = 0;
-            for (auto& n : nodes) {
-                if (!n.is_object())
-                    continue;
-
-                auto& curNode = g_mainEditor->m_Nodes.emplace_back();
-                if (!curNode.FromJson(n, lastId)) {
-                    throw std::exception{ "Failed to parse node. " };
-                }
-            }
-
-            for (auto& n : g_mainEditor->m_Nodes) {
-                for (auto& i : n.inputs) {
-                    i.id = ++lastId;
-                }
-                for (auto& o : n.outputs) {
-                    o.id = ++lastId;
-                }
-            }
+        GraphFile::Apply(*g_mainEditor, std::move(load->GetGraph()));
+        ed::SetCurrentEditor(nullptr);
 
-            if (lastId > INT32_MAX) {
-                throw std::exception{ "[P] Node ID exceeds maximum value." };
-            }
+        g_curPath = load->GetPath();
+        OpenJournal(g_curPath);
+        g_statusText = std::format("Loaded {} at {}", g_curPath.generic_string(), GetCurrentClockTime());
+    }
 
-            g_mainEditor->m_LastId = lastId;
-
-            for (auto& n : g_mainEditor->m_Nodes) {
-                for (auto& i : n.inputs) {
-                    if (i.type < PinType::CustomStart)
-                    {
-                        auto& connected = std::get<NodeInputConnection>(i.connected);
-                        auto targetNode = g_mainEditor->FindNode(connected.nodeId);
-                        if (!targetNode)
-                            continue;
-
-                        for (auto& o : targetNode->outputs) {
-                            if (o.def->typeName == connected.typeName) {
-                                connected.id = o.id;
-                                auto& outConnect = std::get<NodeOutputConnection>(o.connected);
-                                outConnect.ids.push_back(i.id);
-                                g_mainEditor->m_Links.emplace_back(g_mainEditor->GetNextId(), o.id, i.id);
-                                g_mainEditor->m_Links.back().color = g_mainEditor->GetIconColor(i.type);
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        catch (const std::exception& ex) {
-            successful = false;
-            g_mainEditor->m_Nodes.clear();
-            g_mainEditor->m_Links.clear();
-            MessageBoxA(g_MainHWND, std::format("Failed to load blend graph file. Error: {}", ex.what()).c_str(), "Error", 0);
-        }
-        
-        ed::SetCurrentEditor(nullptr);
+    void RenderLoadProgress(ImGuiIO& io)
+    {
+        if (!g_pendingLoad)
+            return;
 
-        if (!successful) {
-            g_mainEditor->InitNew();
-            g_curPath = L"";
-            g_statusText = "";
-        }
-        else {
-            g_statusText = std::format("Loaded {} at {}", filePath.generic_string(), GetCurrentClockTime());
+        static constexpr const char* stageNames[] = { "Reading file", "Parsing", "Building graph", "Finishing" };
+        ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y * 0.5f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+        ImGui::SetNextWindowSize(ImVec2(420.0f, 0.0f));
+        ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings);
+        ImGui::TextUnformatted(g_pendingLoad->GetPath().filename().generic_string().c_str());
+        ImGui::ProgressBar(g_pendingLoad->GetProgress(), ImVec2(-1.0f, 0.0f), stageNames[static_cast<int>(g_pendingLoad->GetStage())]);
+        if (ImGui::Button("Cancel")) {
+            CancelLoad();
         }
+        ImGui::End();
     }
 
     void OnLoad()
     {
         auto result = Win32Util_OpenFileDialog(false, g_MainHWND, L"Blend Tree Files (*.bt)\0*.bt\0");
-        if (!result.empty()) {
-            g_curPath = result;
-        }
-        else {
+        if (result.empty()) {
             return;
         }
-        LoadData(g_curPath);
+        LoadData(result);
     }
 
     void OnSave(bool forceChoosePath)
@@ -188,17 +268,133 @@ namespace Main
         SaveData(g_curPath);
     }
 
+    void OnExportDeduplicated()
+    {
+        auto result = Win32Util_OpenFileDialog(true, g_MainHWND, L"Blend Tree Files (*.bt)\0*.bt\0");
+        if (result.empty()) {
+            return;
+        }
+        // The merged graph would replace the document on disk while its journal says it's saved.
+        auto filePath = std::filesystem::path{ result }.replace_extension(".bt");
+        std::error_code ec;
+        if (!g_curPath.empty() && (filePath == g_curPath || std::filesystem::equivalent(filePath, g_curPath, ec))) {
+            MessageBoxA(g_MainHWND, "Export to a different file than the open document, or save the document instead.", "Error", 0);
+            return;
+        }
+        ExportDeduplicated(filePath);
+    }
+
+    // Searches again when the query or the graph changed, keeping the editor's highlights in step.
+    void UpdateSearch()
+    {
+        if (g_searchQuery == g_searchedQuery && g_searchIndex->GetRevision() == g_searchedRevision)
+            return;
+
+        // With no query the index isn't touched, so it costs nothing until the first search.
+        auto focused = g_searchCurrent < g_searchResults.size() ? g_searchResults[g_searchCurrent] : ed::NodeId{ 0 };
+        if (g_searchQuery.empty())
+            g_searchResults.clear();
+        else
+            g_searchIndex->Find(g_searchQuery, g_searchResults);
+        g_searchedQuery = g_searchQuery;
+        g_searchedRevision = g_searchIndex->GetRevision();
+
+        // Editing the graph keeps the place in the results if the focused node still matches.
+        auto iter = std::lower_bound(g_searchResults.begin(), g_searchResults.end(), focused, NodeIdLess{});
+        g_searchCurrent = iter != g_searchResults.end() && *iter == focused ? iter - g_searchResults.begin() : SIZE_MAX;
+        g_mainEditor->m_HighlightedNodes.assign(g_searchResults.begin(), g_searchResults.end());
+        g_mainEditor->m_FocusedNode = g_searchCurrent != SIZE_MAX ? focused : ed::NodeId{ 0 };
+    }
+
+    void JumpToSearchResult(bool backwards)
+    {
+        if (g_searchResults.empty())
+            return;
+
+        auto count = g_searchResults.size();
+        if (g_searchCurrent >= count)
+            g_searchCurrent = backwards ? count - 1 : 0;
+        else
+            g_searchCurrent = (g_searchCurrent + (backwards ? count - 1 : 1)) % count;
+
+        auto id = g_searchResults[g_searchCurrent];
+        g_mainEditor->m_FocusedNode = id;
+        ed::SetCurrentEditor(g_mainEditor->m_Editor);
+        ed::SelectNode(id);
+        ed::NavigateToSelection();
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    // Enter jumps to the next match and Shift+Enter to the previous one.
+    void RenderSearchBox()
+    {
+        if (g_focusSearch) {
+            ImGui::SetKeyboardFocusHere();
+            g_focusSearch = false;
+        }
+        ImGui::SetNextItemWidth(260.0f);
+        bool entered = ImGui::InputTextWithHint("##Search", "Search (Ctrl+F)", &g_searchQuery, ImGuiInputTextFlags_EnterReturnsTrue);
+        UpdateSearch();
+        if (entered) {
+            JumpToSearchResult(ImGui::IsKeyDown(ImGuiKey_LeftShift));
+            g_focusSearch = true;
+        }
+
+        if (g_searchQuery.empty())
+            return;
+
+        if (g_searchResults.empty())
+            ImGui::TextUnformatted("No matches");
+        else if (g_searchCurrent < g_searchResults.size())
+            ImGui::Text("%zu of %zu", g_searchCurrent + 1, g_searchResults.size());
+        else
+            ImGui::Text("%zu matches", g_searchResults.size());
+        if (ImGui::ArrowButton("##PreviousMatch", ImGuiDir_Up))
+            JumpToSearchResult(true);
+        if (ImGui::ArrowButton("##NextMatch", ImGuiDir_Down))
+            JumpToSearchResult(false);
+    }
+
+    void ToggleTrace()
+    {
+        if (!Trace::IsRecording()) {
+            Trace::Start();
+            g_statusText = "Recording trace, press F9 to stop";
+            return;
+        }
+
+        Trace::Stop();
+        auto tracePath = std::filesystem::current_path() / std::format("trace_{}.json", std::time(nullptr));
+        if (!Trace::Write(tracePath)) {
+            MessageBoxA(g_MainHWND, "Failed to write trace file.", "Error", 0);
+            g_statusText = "";
+            return;
+        }
+        g_statusText = std::format("Trace written to {}", tracePath.generic_string());
+    }
+
+    bool HasPendingWork()
+    {
+        return !pendingOpenFile.empty() || g_pendingLoad || !g_cancelledLoads.empty() || g_saver->IsBusy();
+    }
+
 	void OnFrame(ImGuiIO& io)
 	{
         ImGui::PushFont(g_mainFontSmall);
 		ImGui::SetNextWindowSize(io.DisplaySize);
 		ImGui::SetNextWindowPos({ .0f, .0f });
-		ImGui::Begin("Main", NULL, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_MenuBar);
+		ImGui::Begin("Main", NULL, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoBringToFrontOnFocus);
+
+        UpdatePendingLoad();
+        UpdatePendingSaves();
 
         if (!pendingOpenFile.empty()) {
-            g_curPath = pendingOpenFile;
+            LoadData(pendingOpenFile);
             pendingOpenFile.clear();
-            LoadData(g_curPath);
+        }
+
+        if (ImGui::IsKeyPressed(ImGuiKey_F9, false)) {
+            ToggleTrace();
         }
 
         if (ImGui::IsKeyDown(ImGuiKey_LeftCtrl)) {
@@ -208,6 +404,19 @@ namespace Main
             else if (ImGui::IsKeyReleased(ImGuiKey_O, false)) {
                 OnLoad();
             }
+            // Text fields keep their own undo, and a link being dragged holds pins that undo would free.
+            else if (!io.WantTextInput && !g_mainEditor->IsHoldingPins() && ImGui::IsKeyPressed(ImGuiKey_Z)) {
+                if (ImGui::IsKeyDown(ImGuiKey_LeftShift))
+                    g_history->Redo();
+                else
+                    g_history->Undo();
+            }
+            else if (!io.WantTextInput && !g_mainEditor->IsHoldingPins() && ImGui::IsKeyPressed(ImGuiKey_Y)) {
+                g_history->Redo();
+            }
+            else if (ImGui::IsKeyPressed(ImGuiKey_F, false)) {
+                g_focusSearch = true;
+            }
         }
 
         if (ImGui::BeginMenuBar())
@@ -215,7 +424,10 @@ namespace Main
             if (ImGui::BeginMenu("File"))
             {
                 if (ImGui::MenuItem("New")) {
+                    CancelLoad();
+                    g_journal->Close();
                     g_mainEditor->InitNew();
+                    g_journal->Open(AutosaveJournal::GetJournalPath({}), false);
                     g_curPath = L"";
                     g_statusText = "";
                 }
@@ -228,8 +440,50 @@ namespace Main
                 if (ImGui::MenuItem("Save As...", "Ctrl+S")) {
                     OnSave(true);
                 }
+                if (ImGui::MenuItem("Export Deduplicated...")) {
+                    OnExportDeduplicated();
+                }
                 ImGui::EndMenu();
             }
+            if (ImGui::BeginMenu("Edit"))
+            {
+                bool canEdit = !g_mainEditor->IsHoldingPins();
+                if (ImGui::MenuItem("Undo", "Ctrl+Z", false, canEdit && g_history->CanUndo())) {
+                    g_history->Undo();
+                }
+                if (ImGui::MenuItem("Redo", "Ctrl+Y", false, canEdit && g_history->CanRedo())) {
+                    g_history->Redo();
+                }
+                ImGui::Separator();
+                ed::SetCurrentEditor(g_mainEditor->m_Editor);
+                bool hasSelection = ed::GetSelectedObjectCount() > 0;
+                if (ImGui::MenuItem("Cut", "Ctrl+X", false, hasSelection)) {
+                    g_mainEditor->CutSelection();
+                }
+                if (ImGui::MenuItem("Copy", "Ctrl+C", false, hasSelection)) {
+                    g_mainEditor->CopySelection();
+                }
+                if (ImGui::MenuItem("Paste", "Ctrl+V", false, !g_mainEditor->m_Clipboard.nodes.empty())) {
+                    g_mainEditor->Paste();
+                }
+                if (ImGui::MenuItem("Duplicate", "Ctrl+D", false, hasSelection)) {
+                    g_mainEditor->DuplicateSelection();
+                }
+                ed::SetCurrentEditor(nullptr);
+                ImGui::EndMenu();
+            }
+            if (ImGui::BeginMenu("View"))
+            {
+                ImGui::MenuItem("Minimap", nullptr, &g_mainEditor->m_ShowMinimap);
+#ifdef BLENDGRAPH_PROFILE
+                ImGui::MenuItem("Profiler", nullptr, &g_showProfiler);
+#endif
+                if (ImGui::MenuItem("Record Trace", "F9", Trace::IsRecording())) {
+                    ToggleTrace();
+                }
+                ImGui::EndMenu();
+            }
+            RenderSearchBox();
 
             ImGui::SameLine((ImGui::GetWindowWidth() - ImGui::CalcTextSize(g_statusText.c_str()).x) - 20);
             ImGui::TextUnformatted(g_statusText.c_str());
@@ -244,6 +498,19 @@ namespace Main
         g_mainEditor->OnFrame(io);
         ImGui::PopFont();
         ImGui::End();
+
+        RenderLoadProgress(io);
+
+        g_history->CommitStep();
+        g_journal->Update();
+        if (auto error = g_journal->TakeError(); !error.empty()) {
+            g_statusText = error;
+        }
+
+#ifdef BLENDGRAPH_PROFILE
+        if (g_showProfiler)
+            Profiler::DrawOverlay(&g_showProfiler);
+#endif
         
 	}
 }
\ No newline at end of file
@@ -5,8 +5,12 @@
 namespace Main
 {
 	extern std::filesystem::path pendingOpenFile;
+	// Creates or updates an RGBA8 texture; passing null pixels releases it. Set by the platform layer.
+	extern ImTextureID(*updateTexture)(ImTextureID texture, const void* pixels, int width, int height);
 
 	void OnStart(ImGuiIO& io);
 	void OnStop(ImGuiIO& io);
 	void OnFrame(ImGuiIO& io);
+	// True while there is work that needs frames even without input.
+	bool HasPendingWork();
 }
\ No newline at end of file
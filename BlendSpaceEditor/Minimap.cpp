@@ -0,0 +1,199 @@
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "Minimap.h"
+#include "Editor.h"
+#include "Main.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#undef max
+#undef min
+
+namespace
+{
+    // While nodes are being dragged the raster would otherwise be rebuilt every frame.
+    constexpr double kRebuildInterval = 0.1;
+    constexpr ImU32 kBackgroundColor = IM_COL32(24, 24, 24, 220);
+    constexpr float kPickRadius = 8.0f;
+}
+
+Minimap::~Minimap()
+{
+    if (m_Texture && Main::updateTexture)
+        Main::updateTexture(m_Texture, nullptr, 0, 0);
+}
+
+ed::NodeId Minimap::Draw(Editor& editor, const ImVec2& panelMin, const ImVec2& panelSize, const ImVec2& viewMin, const ImVec2& viewMax)
+{
+    int width = static_cast<int>(panelSize.x);
+    int height = static_cast<int>(panelSize.y);
+    bool stale = editor.m_SpatialIndex.GetRevision() != m_BuiltSpatialRevision ||
+        editor.m_GraphRevision != m_BuiltGraphRevision ||
+        width != m_Width || height != m_Height;
+
+    double now = ImGui::GetTime();
+    if (stale && now - m_LastRebuildTime >= kRebuildInterval) {
+        Rebuild(editor, width, height);
+        m_BuiltSpatialRevision = editor.m_SpatialIndex.GetRevision();
+        m_BuiltGraphRevision = editor.m_GraphRevision;
+        m_LastRebuildTime = now;
+    }
+
+    auto drawList = ImGui::GetWindowDrawList();
+    auto panelMax = panelMin + panelSize;
+    if (m_Texture) {
+        drawList->AddImage(m_Texture, panelMin, panelMax);
+    }
+    else {
+        drawList->AddRectFilled(panelMin, panelMax, kBackgroundColor);
+    }
+
+    auto viewRectMin = ImClamp(panelMin + CanvasToMinimap(viewMin), panelMin, panelMax);
+    auto viewRectMax = ImClamp(panelMin + CanvasToMinimap(viewMax), panelMin, panelMax);
+    drawList->AddRect(viewRectMin, viewRectMax, IM_COL32(255, 255, 255, 180));
+    drawList->AddRect(panelMin, panelMax, IM_COL32(90, 90, 90, 255));
+
+    ImGui::SetCursorScreenPos(panelMin);
+    if (!ImGui::InvisibleButton("##Minimap", panelSize))
+        return 0;
+
+    auto canvasPos = MinimapToCanvas(ImGui::GetMousePos() - panelMin);
+    if (auto hit = editor.QueryNodeAtPoint(canvasPos))
+        return hit;
+
+    // A node is often only a pixel or two on the minimap, so fall back to the nearest one around the cursor.
+    std::vector<ed::NodeId> nearby;
+    float radius = kPickRadius / m_Scale;
+    editor.QueryNodesInRect(canvasPos - ImVec2(radius, radius), canvasPos + ImVec2(radius, radius), nearby);
+
+    ed::NodeId closest = 0;
+    float closestDist = FLT_MAX;
+    for (auto id : nearby) {
+        auto bounds = editor.m_SpatialIndex.GetBounds(id.Get());
+        if (!bounds)
+            continue;
+
+        float dx = (bounds->minX + bounds->maxX) * 0.5f - canvasPos.x;
+        float dy = (bounds->minY + bounds->maxY) * 0.5f - canvasPos.y;
+        float dist = dx * dx + dy * dy;
+        if (dist < closestDist) {
+            closestDist = dist;
+            closest = id;
+        }
+    }
+
+    return closest;
+}
+
+void Minimap::Rebuild(Editor& editor, int width, int height)
+{
+    m_Width = width;
+    m_Height = height;
+    m_Pixels.assign(static_cast<size_t>(width) * height, kBackgroundColor);
+
+    auto& index = editor.m_SpatialIndex;
+    SpatialIndex::Rect graphBounds{ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (auto& node : editor.m_Nodes) {
+        if (auto b = index.GetBounds(node.id.Get())) {
+            graphBounds.minX = std::min(graphBounds.minX, b->minX);
+            graphBounds.minY = std::min(graphBounds.minY, b->minY);
+            graphBounds.maxX = std::max(graphBounds.maxX, b->maxX);
+            graphBounds.maxY = std::max(graphBounds.maxY, b->maxY);
+        }
+    }
+
+    if (graphBounds.minX <= graphBounds.maxX) {
+        float graphWidth = std::max(graphBounds.maxX - graphBounds.minX, 1.0f) * 1.1f;
+        float graphHeight = std::max(graphBounds.maxY - graphBounds.minY, 1.0f) * 1.1f;
+        m_Scale = std::min(width / graphWidth, height / graphHeight);
+        m_CanvasOrigin = ImVec2(
+            (graphBounds.minX + graphBounds.maxX) * 0.5f - (width * 0.5f) / m_Scale,
+            (graphBounds.minY + graphBounds.maxY) * 0.5f - (height * 0.5f) / m_Scale);
+
+        m_PinNodes.clear();
+        for (size_t i = 0; i < editor.m_Nodes.size(); i++) {
+            for (auto& pin : editor.m_Nodes[i].inputs)
+                m_PinNodes.emplace(pin.id.Get(), i);
+            for (auto& pin : editor.m_Nodes[i].outputs)
+                m_PinNodes.emplace(pin.id.Get(), i);
+        }
+
+        for (auto& link : editor.m_Links) {
+            auto startIter = m_PinNodes.find(link.startPinID.Get());
+            auto endIter = m_PinNodes.find(link.endPinID.Get());
+            if (startIter == m_PinNodes.end() || endIter == m_PinNodes.end())
+                continue;
+
+            auto startBounds = index.GetBounds(editor.m_Nodes[startIter->second].id.Get());
+            auto endBounds = index.GetBounds(editor.m_Nodes[endIter->second].id.Get());
+            if (!startBounds || !endBounds)
+                continue;
+
+            auto a = CanvasToMinimap({ startBounds->maxX, (startBounds->minY + startBounds->maxY) * 0.5f });
+            auto b = CanvasToMinimap({ endBounds->minX, (endBounds->minY + endBounds->maxY) * 0.5f });
+            ImColor color = link.color;
+            color.Value.w = 0.6f;
+            DrawLine(static_cast<int>(a.x), static_cast<int>(a.y), static_cast<int>(b.x), static_cast<int>(b.y), color);
+        }
+
+        for (auto& node : editor.m_Nodes) {
+            if (auto b = index.GetBounds(node.id.Get())) {
+                auto min = CanvasToMinimap({ b->minX, b->minY });
+                auto max = CanvasToMinimap({ b->maxX, b->maxY });
+                FillRect(static_cast<int>(min.x), static_cast<int>(min.y), static_cast<int>(max.x), static_cast<int>(max.y), node.def->color);
+            }
+        }
+    }
+
+    if (Main::updateTexture)
+        m_Texture = Main::updateTexture(m_Texture, m_Pixels.data(), m_Width, m_Height);
+}
+
+void Minimap::FillRect(int x0, int y0, int x1, int y1, ImU32 color)
+{
+    // Always cover at least one pixel so tiny nodes stay visible when zoomed out.
+    x0 = std::clamp(x0, 0, m_Width - 1);
+    y0 = std::clamp(y0, 0, m_Height - 1);
+    x1 = std::clamp(std::max(x1, x0 + 1), 0, m_Width);
+    y1 = std::clamp(std::max(y1, y0 + 1), 0, m_Height);
+
+    for (int y = y0; y < y1; y++)
+        std::fill(m_Pixels.begin() + (static_cast<size_t>(y) * m_Width + x0), m_Pixels.begin() + (static_cast<size_t>(y) * m_Width + x1), color);
+}
+
+void Minimap::DrawLine(int x0, int y0, int x1, int y1, ImU32 color)
+{
+    int dx = std::abs(x1 - x0);
+    int dy = -std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (true) {
+        if (x0 >= 0 && x0 < m_Width && y0 >= 0 && y0 < m_Height)
+            m_Pixels[static_cast<size_t>(y0) * m_Width + x0] = color;
+
+        if (x0 == x1 && y0 == y1)
+            break;
+
+        int e2 = err * 2;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+ImVec2 Minimap::CanvasToMinimap(const ImVec2& pos) const
+{
+    return (pos - m_CanvasOrigin) * m_Scale;
+}
+
+ImVec2 Minimap::MinimapToCanvas(const ImVec2& pos) const
+{
+    return m_CanvasOrigin + pos * (1.0f / m_Scale);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "imgui.h"
+#include "imgui-node-editor/imgui_node_editor.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ed = ax::NodeEditor;
+
+class Editor;
+
+// Overview of the whole graph, rasterized into a cached texture. The raster is only rebuilt when
+// the spatial index or the link set changes, so drawing it each frame is a single textured quad.
+class Minimap
+{
+public:
+    ~Minimap();
+
+    // viewMin/viewMax are the canvas-space corners of the visible editor area.
+    // Returns a node to navigate to when the minimap was clicked, otherwise 0.
+    ed::NodeId Draw(Editor& editor, const ImVec2& panelMin, const ImVec2& panelSize, const ImVec2& viewMin, const ImVec2& viewMax);
+
+private:
+    void Rebuild(Editor& editor, int width, int height);
+    void FillRect(int x0, int y0, int x1, int y1, ImU32 color);
+    void DrawLine(int x0, int y0, int x1, int y1, ImU32 color);
+    ImVec2 CanvasToMinimap(const ImVec2& pos) const;
+    ImVec2 MinimapToCanvas(const ImVec2& pos) const;
+
+    std::vector<ImU32> m_Pixels;
+    std::unordered_map<uintptr_t, size_t> m_PinNodes;
+    ImTextureID m_Texture = nullptr;
+    int m_Width = 0;
+    int m_Height = 0;
+    uint64_t m_BuiltSpatialRevision = UINT64_MAX;
+    uint64_t m_BuiltGraphRevision = UINT64_MAX;
+    double m_LastRebuildTime = 0.0;
+    ImVec2 m_CanvasOrigin = { 0.0f, 0.0f };
+    float m_Scale = 1.0f;
+};
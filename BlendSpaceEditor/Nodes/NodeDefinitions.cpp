@@ -1,199 +1,214 @@
 #include "NodeDefinitions.h"
+#include <algorithm>
+#include <array>
+#include <bit>
 
 namespace NodeDefinitions
 {
 
-	PinDef::PinDef(const char* _name,
-		const char* _typeName,
-		PinType _type) :
-		name(_name),
-		typeName(_typeName),
-		type(_type)
-	{}
-
-	NodeDef::NodeDef(const char* _name,
-		const char* _typeName,
-		const std::vector<PinDef>& _inputs,
-		const std::vector<PinDef>& _outputs,
-		ImColor _color) :
-		name(_name),
-		typeName(_typeName),
-		inputs(_inputs.begin(), _inputs.end()),
-		outputs(_outputs.begin(), _outputs.end()),
-		color(_color)
+	void NodeDef::CopyToNode(const std::function<int()>& getNextId, Node& dest) const
 	{
-		GetDefList().emplace_back(this);
+		dest.id = getNextId();
+		dest.def = this;
+
+		dest.inputs.reserve(inputs.size());
+		for (auto& i : inputs) {
+			dest.inputs.emplace_back(getNextId(), i.type).def = &i;
+		}
+
+		dest.outputs.reserve(outputs.size());
+		for (auto& o : outputs) {
+			dest.outputs.emplace_back(getNextId(), o.type).def = &o;
+		}
 	}
 
-	void NodeDef::CopyToNode(const std::function<int()>& getNextId, Node& dest)
+	void NodeDef::CopyToNode(int firstId, Node& dest) const
 	{
-		dest.id = getNextId();
-		dest.name = name;
-		dest.color = color;
+		int id = firstId;
+		dest.id = id++;
 		dest.def = this;
 
+		dest.inputs.reserve(inputs.size());
 		for (auto& i : inputs) {
-			dest.inputs.emplace_back(getNextId(), i.name.data(), i.type).def = &i;
+			dest.inputs.emplace_back(id++, i.type).def = &i;
 		}
 
+		dest.outputs.reserve(outputs.size());
 		for (auto& o : outputs) {
-			dest.outputs.emplace_back(getNextId(), o.name.data(), o.type).def = &o;
+			dest.outputs.emplace_back(id++, o.type).def = &o;
 		}
 	}
 
-	std::vector<NodeDef*>& GetDefList()
+	// Start of Definitions
+
+	constexpr PinDef kFullAnimationInputs[] = {
+		{ "File", "file", PinType::CustomString},
+		{ "Sync ID", "syncId", PinType::CustomInt },
+		{ "Speed Modifier (Optional)", "speedMod", PinType::Float }
+	};
+
+	constexpr PinDef kFullAnimationOutputs[] = {
+		{ "Output Pose", "output", PinType::Pose}
+	};
+
+	constexpr PinDef kBlendSpace1DInputs[] = {
+		{ "Pose 1", "1", PinType::Pose},
+		{ "Pose 2", "2", PinType::Pose},
+		{ "Value Input", "val", PinType::Float}
+	};
+
+	constexpr PinDef kBlendSpace1DOutputs[] = {
+		{ "Output Pose", "output", PinType::Pose}
+	};
+
+	constexpr PinDef kAdditiveBlendInputs[] = {
+		{ "Additive Pose", "add", PinType::Pose},
+		{ "Full Pose", "full", PinType::Pose},
+		{ "Value Input", "val", PinType::Float}
+	};
+
+	constexpr PinDef kAdditiveBlendOutputs[] = {
+		{ "Output Pose", "output", PinType::Pose}
+	};
+
+	constexpr PinDef kIKTwoBoneAdjInputs[] = {
+		{ "Input Pose", "pose", PinType::Pose },
+		{ "Start Bone", "start_node", PinType::CustomString},
+		{ "Mid Bone", "mid_node", PinType::CustomString},
+		{ "End Bone", "end_node", PinType::CustomString},
+		{ "Mid Axis X", "mid_x", PinType::CustomFloat},
+		{ "Mid Axis Y", "mid_y", PinType::CustomFloat},
+		{ "Mid Axis Z", "mid_z", PinType::CustomFloat},
+		{ "X Offset", "x_offset", PinType::Float},
+		{ "Y Offset", "y_offset", PinType::Float },
+		{ "Z Offset", "z_offset", PinType::Float }
+	};
+
+	constexpr PinDef kIKTwoBoneAdjOutputs[] = {
+		{ "Output Pose", "output", PinType::Pose }
+	};
+
+	constexpr PinDef kFixedValueInputs[] = {
+		{ "Value", "val", PinType::CustomFloat},
+	};
+
+	constexpr PinDef kFixedValueOutputs[] = {
+		{ "Value Output", "output", PinType::Float}
+	};
+
+	constexpr PinDef kVariableInputs[] = {
+		{ "Name", "name", PinType::CustomString},
+		{ "Default Value", "defVal", PinType::CustomFloat}
+	};
+
+	constexpr PinDef kVariableOutputs[] = {
+		{ "Value Output", "output", PinType::Float}
+	};
+
+	constexpr PinDef kLimitROCInputs[] = {
+		{ "Value Input", "input", PinType::Float},
+		{ "Rate-of-Change/s", "roc", PinType::CustomFloat}
+	};
+
+	constexpr PinDef kLimitROCOutputs[] = {
+		{ "Value Output", "output", PinType::Float}
+	};
+
+	constexpr PinDef kTransformRangeInputs[] = {
+		{ "Value Input", "input", PinType::Float},
+		{ "Old Min", "oldMin", PinType::CustomFloat},
+		{ "Old Max", "oldMax", PinType::CustomFloat},
+		{ "New Min", "newMin", PinType::CustomFloat},
+		{ "New Max", "newMax", PinType::CustomFloat}
+	};
+
+	constexpr PinDef kTransformRangeOutputs[] = {
+		{ "Value Output", "output", PinType::Float}
+	};
+
+	constexpr PinDef kSmoothedRandomValueInputs[] = {
+		{ "Smooth Duration Min", "dur_min", PinType::CustomFloat},
+		{ "Smooth Duration Max", "dur_max", PinType::CustomFloat },
+		{ "Differential Min", "diff_min", PinType::CustomFloat },
+		{ "Differential Max", "diff_max", PinType::CustomFloat },
+		{ "Delay Min", "delay_min", PinType::CustomFloat },
+		{ "Delay Max", "delay_max", PinType::CustomFloat },
+		{ "Edge Threshold", "edge", PinType::CustomFloat },
+		{ "Sync ID", "syncId", PinType::CustomInt }
+	};
+
+	constexpr PinDef kSmoothedRandomValueOutputs[] = {
+		{ "Value Output", "output", PinType::Float}
+	};
+
+	constexpr PinDef kActorInputs[] = {
+		{ "Input Pose", "input", PinType::Pose}
+	};
+
+	constexpr NodeDef kDefs[] = {
+		{ "Full Animation", "anim", kFullAnimationInputs, kFullAnimationOutputs, IM_COL32(147, 226, 74, 255) },
+		{ "Blend Space 1D", "blend_1d", kBlendSpace1DInputs, kBlendSpace1DOutputs, IM_COL32(147, 226, 74, 255) },
+		{ "Additive Blend", "blend_add", kAdditiveBlendInputs, kAdditiveBlendOutputs, IM_COL32(147, 226, 74, 255) },
+		{ "IK Two Bone Adjust", "ik_2b_adj", kIKTwoBoneAdjInputs, kIKTwoBoneAdjOutputs, IM_COL32(147, 226, 74, 255) },
+		{ "Fixed Value", "fixed_val", kFixedValueInputs, kFixedValueOutputs, IM_COL32(177, 3, 252, 255) },
+		{ "Variable", "var", kVariableInputs, kVariableOutputs, IM_COL32(177, 3, 252, 255) },
+		{ "Limit Rate-of-Change", "limit_roc", kLimitROCInputs, kLimitROCOutputs, IM_COL32(177, 3, 252, 255) },
+		{ "Transform Range", "transform_range", kTransformRangeInputs, kTransformRangeOutputs, IM_COL32(177, 3, 252, 255) },
+		{ "Smoothed Random Value", "smooth_rand", kSmoothedRandomValueInputs, kSmoothedRandomValueOutputs, IM_COL32(177, 3, 252, 255) },
+		{ "Actor", "actor", kActorInputs, {}, IM_COL32(255, 0, 0, 255) }
+	};
+
+	// Type names are looked up through a perfect hash built at compile time: a seed for which FNV-1a puts
+	// every type name in its own slot of a table twice the size of the definition list.
+	constexpr uint32_t Hash(std::string_view text, uint32_t seed)
 	{
-		static std::vector<NodeDef*> list;
-		return list;
+		uint32_t hash = 2166136261u ^ seed;
+		for (char c : text)
+			hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+		return hash;
 	}
 
-	// Start of Definitions
+	constexpr size_t kSlotCount = std::bit_ceil(std::size(kDefs) * 2);
+	constexpr uint8_t kEmptySlot = 0xFF;
+	static_assert(std::size(kDefs) < kEmptySlot);
+
+	struct PerfectHash
+	{
+		uint32_t seed = 0;
+		std::array<uint8_t, kSlotCount> slots{};
+	};
+
+	constexpr PerfectHash BuildPerfectHash()
+	{
+		for (uint32_t seed = 0; seed < 1u << 16; seed++) {
+			PerfectHash table{ seed };
+			table.slots.fill(kEmptySlot);
+			bool collision = false;
+			for (size_t i = 0; i < std::size(kDefs) && !collision; i++) {
+				auto& slot = table.slots[Hash(kDefs[i].typeName, seed) & (kSlotCount - 1)];
+				collision = slot != kEmptySlot;
+				slot = static_cast<uint8_t>(i);
+			}
+			if (!collision)
+				return table;
+		}
+		return {};
+	}
+
+	constexpr PerfectHash kTypeLookup = BuildPerfectHash();
+	static_assert(std::count(kTypeLookup.slots.begin(), kTypeLookup.slots.end(), kEmptySlot) == kSlotCount - std::size(kDefs),
+			"No perfect hash seed found for the node type names");
+
+	std::span<const NodeDef> GetDefs()
+	{
+		return kDefs;
+	}
 
-	static NodeDef FullAnimationNode{
-		"Full Animation",
-		"anim",
-		{
-			{ "File", "file", PinType::CustomString},
-			{ "Sync ID", "syncId", PinType::CustomInt },
-			{ "Speed Modifier (Optional)", "speedMod", PinType::Float }
-		},
-		{
-			{ "Output Pose", "output", PinType::Pose}
-		},
-		{ 147, 226, 74, 255 }
-	};
-
-	static NodeDef BlendSpace1DNode{
-		"Blend Space 1D",
-		"blend_1d",
-		{
-			{ "Pose 1", "1", PinType::Pose},
-			{ "Pose 2", "2", PinType::Pose},
-			{ "Value Input", "val", PinType::Float}
-		},
-		{
-			{ "Output Pose", "output", PinType::Pose}
-		},
-		{ 147, 226, 74, 255 }
-	};
-
-	static NodeDef AdditiveBlendNode{
-		"Additive Blend",
-		"blend_add",
-		{
-			{ "Additive Pose", "add", PinType::Pose},
-			{ "Full Pose", "full", PinType::Pose},
-			{ "Value Input", "val", PinType::Float}
-		},
-		{
-			{ "Output Pose", "output", PinType::Pose}
-		},
-		{ 147, 226, 74, 255 }
-	};
-
-	static NodeDef IKTwoBoneAdjNode{
-		"IK Two Bone Adjust",
-		"ik_2b_adj",
-		{
-			{ "Input Pose", "pose", PinType::Pose },
-			{ "Start Bone", "start_node", PinType::CustomString},
-			{ "Mid Bone", "mid_node", PinType::CustomString},
-			{ "End Bone", "end_node", PinType::CustomString},
-			{ "Mid Axis X", "mid_x", PinType::CustomFloat},
-			{ "Mid Axis Y", "mid_y", PinType::CustomFloat},
-			{ "Mid Axis Z", "mid_z", PinType::CustomFloat},
-			{ "X Offset", "x_offset", PinType::Float},
-			{ "Y Offset", "y_offset", PinType::Float },
-			{ "Z Offset", "z_offset", PinType::Float }
-		},
-		{
-			{ "Output Pose", "output", PinType::Pose }
-		},
-		{ 147, 226, 74, 255 }
-	};
-
-	static NodeDef FixedValueNode{
-		"Fixed Value",
-		"fixed_val",
-		{
-			{ "Value", "val", PinType::CustomFloat},
-		},
-		{
-			{ "Value Output", "output", PinType::Float}
-		},
-		{ 177, 3, 252, 255  }
-	};
-
-	static NodeDef VariableNode{
-		"Variable",
-		"var",
-		{
-			{ "Name", "name", PinType::CustomString},
-			{ "Default Value", "defVal", PinType::CustomFloat}
-		},
-		{
-			{ "Value Output", "output", PinType::Float}
-		},
-		{ 177, 3, 252, 255  }
-	};
-
-	static NodeDef LimitROCNode{
-		"Limit Rate-of-Change",
-		"limit_roc",
-		{
-			{ "Value Input", "input", PinType::Float},
-			{ "Rate-of-Change/s", "roc", PinType::CustomFloat}
-		},
-		{
-			{ "Value Output", "output", PinType::Float}
-		},
-		{ 177, 3, 252, 255  }
-	};
-
-	static NodeDef TransformRangeNode{
-		"Transform Range",
-		"transform_range",
-		{
-			{ "Value Input", "input", PinType::Float},
-			{ "Old Min", "oldMin", PinType::CustomFloat},
-			{ "Old Max", "oldMax", PinType::CustomFloat},
-			{ "New Min", "newMin", PinType::CustomFloat},
-			{ "New Max", "newMax", PinType::CustomFloat}
-		},
-		{
-			{ "Value Output", "output", PinType::Float}
-		},
-		{ 177, 3, 252, 255  }
-	};
-
-	static NodeDef SmoothedRandomValueNode{
-		"Smoothed Random Value",
-		"smooth_rand",
-		{
-			{ "Smooth Duration Min", "dur_min", PinType::CustomFloat},
-			{ "Smooth Duration Max", "dur_max", PinType::CustomFloat },
-			{ "Differential Min", "diff_min", PinType::CustomFloat },
-			{ "Differential Max", "diff_max", PinType::CustomFloat },
-			{ "Delay Min", "delay_min", PinType::CustomFloat },
-			{ "Delay Max", "delay_max", PinType::CustomFloat },
-			{ "Edge Threshold", "edge", PinType::CustomFloat },
-			{ "Sync ID", "syncId", PinType::CustomInt }
-		},
-		{
-			{ "Value Output", "output", PinType::Float}
-		},
-		{ 177, 3, 252, 255  }
-	};
-
-	static NodeDef ActorNode{
-		"Actor",
-		"actor",
-		{
-			{ "Input Pose", "input", PinType::Pose}
-		},
-		{
-		},
-		{ 255, 0, 0, 255 }
-	};
-
-}
\ No newline at end of file
+	const NodeDef* FindDef(std::string_view typeName)
+	{
+		auto slot = kTypeLookup.slots[Hash(typeName, kTypeLookup.seed) & (kSlotCount - 1)];
+		if (slot == kEmptySlot || kDefs[slot].typeName != typeName)
+			return nullptr;
+		return &kDefs[slot];
+	}
+}
@@ -7,31 +7,28 @@ namespace NodeDefinitions
 {
 	struct PinDef
 	{
-		std::string_view typeName;
 		std::string_view name;
+		std::string_view typeName;
 		PinType type;
-
-		PinDef(const char* _name,
-			const char* _typeName,
-			PinType _type);
 	};
 
+	// Definitions are constant data built at compile time; see NodeDefinitions.cpp.
 	struct NodeDef
 	{
-		NodeDef(const char* _name,
-			const char* _typeName,
-			const std::vector<PinDef>& _inputs,
-			const std::vector<PinDef>& _outputs,
-			ImColor _color = { 1.0f, 1.0f, 1.0f, 1.0f });
+		void CopyToNode(const std::function<int()>& getNextId, Node& dest) const;
+		// Numbers the node firstId and its pins consecutively after it, inputs first.
+		void CopyToNode(int firstId, Node& dest) const;
+		constexpr int GetIdCount() const { return static_cast<int>(1 + inputs.size() + outputs.size()); }
 
-		void CopyToNode(const std::function<int()>& getNextId, Node& dest);
-
-		std::string_view typeName;
 		std::string_view name;
-		std::vector<PinDef> inputs;
-		std::vector<PinDef> outputs;
-		ImColor color;
+		std::string_view typeName;
+		std::span<const PinDef> inputs;
+		std::span<const PinDef> outputs;
+		ImU32 color = IM_COL32_WHITE;
 	};
 
-	std::vector<NodeDef*>& GetDefList();
+	// Every definition, in the order the New Node menu lists them.
+	std::span<const NodeDef> GetDefs();
+	// Finds a definition by its type name in constant time; nullptr if there is none.
+	const NodeDef* FindDef(std::string_view typeName);
 }
\ No newline at end of file
@@ -1,7 +1,40 @@
 #include "NodeTypes.h"
 #include "NodeDefinitions.h"
+#include "../StringPool.h"
+#include <stdexcept>
 
-void Node::ToJson(nlohmann::json& obj)
+Node::Node(Node&& other, std::pmr::memory_resource* resource) :
+	id(other.id), inputs(std::move(other.inputs), resource), outputs(resource), def(other.def)
+{
+	if (other.outputs.get_allocator().resource() == resource)
+		outputs = std::move(other.outputs);
+	else
+		CopyOutputs(other.outputs);
+}
+
+Node::Node(const Node& other, std::pmr::memory_resource* resource) :
+	id(other.id), inputs(other.inputs, resource), outputs(resource), def(other.def)
+{
+	CopyOutputs(other.outputs);
+}
+
+void Node::CopyOutputs(const std::pmr::vector<Pin>& source)
+{
+	// Copying a pmr vector into another resource copies its elements, but not their own lists, so each
+	// output's connection list is rebuilt there.
+	auto resource = outputs.get_allocator().resource();
+	outputs.reserve(source.size());
+	for (auto& sourceOutput : source) {
+		auto& output = outputs.emplace_back(static_cast<int>(sourceOutput.id.Get()), sourceOutput.type);
+		output.node = sourceOutput.node;
+		output.kind = sourceOutput.kind;
+		output.def = sourceOutput.def;
+		auto& ids = std::get<NodeOutputConnection>(sourceOutput.connected).ids;
+		output.connected.emplace<NodeOutputConnection>(NodeOutputConnection{ std::pmr::vector<ed::PinId>{ ids.begin(), ids.end(), resource } });
+	}
+}
+
+void Node::ToJson(nlohmann::json& obj, const ImVec2& position) const
 {
 	auto& inLinks = obj["inputs"];
 	auto& values = obj["values"];
@@ -25,10 +58,9 @@ void Node::ToJson(nlohmann::json& obj)
 	obj["id"] = id.Get();
 	obj["type"] = def->typeName;
 
-	auto nodePos = ed::GetNodePosition(id);
 	auto& pos = obj["pos"];
-	pos.push_back(nodePos.x);
-	pos.push_back(nodePos.y);
+	pos.push_back(position.x);
+	pos.push_back(position.y);
 
 	if (values.empty()) {
 		obj.erase("values");
@@ -59,27 +91,19 @@ void Node::CompactJsonIds(nlohmann::json& arr)
 	}
 }
 
-bool Node::FromJson(nlohmann::json& obj, size_t& maxId)
+bool Node::FromJson(nlohmann::json& obj, size_t& maxId, ImVec2& position)
 {
-	static auto& defs = NodeDefinitions::GetDefList();
-	NodeDefinitions::NodeDef* targetDef = nullptr;
-	std::string_view targetTypeName = obj["type"];
-	for (auto& d : defs) {
-		if (d->typeName == targetTypeName) {
-			targetDef = d;
-			break;
-		}
-	}
+	auto targetDef = NodeDefinitions::FindDef(obj["type"].get_ref<const std::string&>());
 
 	if (!targetDef) {
-		throw std::exception{ "Node has unknown type." };
+		throw std::runtime_error{ "Node has unknown type." };
 	}
 
 	size_t targetId = obj["id"];
 	maxId = std::max(targetId, maxId);
 
 	if (maxId > INT32_MAX) {
-		throw std::exception{ "[N] Node ID exceeds maximum value." };
+		throw std::runtime_error{ "[N] Node ID exceeds maximum value." };
 	}
 
 	targetDef->CopyToNode([targetId]() -> int {
@@ -88,7 +112,7 @@ bool Node::FromJson(nlohmann::json& obj, size_t& maxId)
 	Build();
 
 	auto& pos = obj["pos"];
-	ed::SetNodePosition(id, ImVec2(pos[0], pos[1]));
+	position = ImVec2(pos[0], pos[1]);
 	auto& inLinks = obj["inputs"];
 	auto& values = obj["values"];
 
@@ -98,9 +122,9 @@ bool Node::FromJson(nlohmann::json& obj, size_t& maxId)
 			if (auto linkIter = inLinks.find(i.def->typeName); linkIter != inLinks.end()) {
 				auto& connected = std::get<NodeInputConnection>(i.connected);
 				size_t linkNodeId = (*linkIter)[0];
-				std::string_view lDestTypeName = (*linkIter)[1];
+				std::string_view lDestTypeName = (*linkIter)[1].get_ref<const std::string&>();
 				connected.nodeId = linkNodeId;
-				connected.typeName = lDestTypeName;
+				connected.typeName = StringPool::Get().Intern(lDestTypeName).data();
 			}
 		}
 		else {
@@ -109,7 +133,7 @@ bool Node::FromJson(nlohmann::json& obj, size_t& maxId)
 				switch (i.type) {
 				case PinType::CustomFloat: std::get<NodeFloatCustomValueConnection>(i.connected).value = *valIter; break;
 				case PinType::CustomInt: std::get<NodeIntCustomValueConnection>(i.connected).value = *valIter; break;
-				case PinType::CustomString: std::get<NodeStringCustomValueConnection>(i.connected).value = *valIter; break;
+				case PinType::CustomString: std::get<NodeStringCustomValueConnection>(i.connected).value = StringPool::Get().Intern(valIter->get_ref<const std::string&>()); break;
 				}
 			}
 		}
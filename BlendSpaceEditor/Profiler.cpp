@@ -0,0 +1,186 @@
+#include "Profiler.h"
+#ifdef BLENDGRAPH_PROFILE
+#include "AllocTracker.h"
+#include "imgui.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#undef max
+
+namespace
+{
+    constexpr size_t kMaxTimers = 64;
+    constexpr int kHistorySize = 240;
+    constexpr size_t kCounterCount = static_cast<size_t>(Profiler::Counter::Count);
+    constexpr const char* kCounterNames[kCounterCount] = { "Nodes drawn", "Pins drawn", "Links submitted", "Allocations" };
+
+    struct TimerSlot
+    {
+        const char* name = nullptr;
+        double frameMs = 0.0;
+        double lastMs = 0.0;
+        uint32_t frameCalls = 0;
+        float history[kHistorySize] = {};
+    };
+
+    std::mutex g_Mutex;
+    TimerSlot g_Timers[kMaxTimers];
+    size_t g_TimerCount = 0;
+    std::atomic<int64_t> g_Counters[kCounterCount] = {};
+    float g_CounterHistory[kCounterCount][kHistorySize] = {};
+    int g_HistoryIndex = 0;
+    uint64_t g_LastAllocationCount = 0;
+
+    // Timers are looked up by name pointer first; string literals from different translation units may not be merged.
+    TimerSlot* FindTimer(const char* name)
+    {
+        for (size_t i = 0; i < g_TimerCount; i++) {
+            if (g_Timers[i].name == name)
+                return &g_Timers[i];
+        }
+        for (size_t i = 0; i < g_TimerCount; i++) {
+            if (std::strcmp(g_Timers[i].name, name) == 0)
+                return &g_Timers[i];
+        }
+        if (g_TimerCount == kMaxTimers)
+            return nullptr;
+
+        auto& slot = g_Timers[g_TimerCount++];
+        slot.name = name;
+        return &slot;
+    }
+
+    void PlotHistory(const char* label, const float* values, float height)
+    {
+        float maxValue = *std::max_element(values, values + kHistorySize);
+        ImGui::PlotLines(label, values, kHistorySize, g_HistoryIndex, nullptr, 0.0f, std::max(maxValue * 1.1f, 0.001f), ImVec2(0.0f, height));
+    }
+}
+
+namespace Profiler
+{
+    ScopedTimer::ScopedTimer(const char* name) : m_Trace(name), m_Name(name), m_Start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ScopedTimer::~ScopedTimer()
+    {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+        std::lock_guard lock{ g_Mutex };
+        if (auto timer = FindTimer(m_Name)) {
+            timer->frameMs += ms;
+            timer->lastMs = ms;
+            timer->frameCalls++;
+        }
+    }
+
+    void AddCount(Counter counter, int64_t value)
+    {
+        g_Counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void EndFrame()
+    {
+#ifdef BLENDGRAPH_TRACK_ALLOCATIONS
+        auto allocations = AllocTracker::GetTotals().count;
+        AddCount(Counter::Allocations, allocations - g_LastAllocationCount);
+        g_LastAllocationCount = allocations;
+#endif
+
+        std::lock_guard lock{ g_Mutex };
+        for (size_t i = 0; i < g_TimerCount; i++) {
+            auto& timer = g_Timers[i];
+            timer.history[g_HistoryIndex] = static_cast<float>(timer.frameMs);
+            timer.frameMs = 0.0;
+            timer.frameCalls = 0;
+        }
+        for (size_t i = 0; i < kCounterCount; i++)
+            g_CounterHistory[i][g_HistoryIndex] = static_cast<float>(g_Counters[i].exchange(0, std::memory_order_relaxed));
+
+        g_HistoryIndex = (g_HistoryIndex + 1) % kHistorySize;
+    }
+
+    void DrawOverlay(bool* open)
+    {
+        ImGui::SetNextWindowSize(ImVec2(520.0f, 0.0f), ImGuiCond_FirstUseEver);
+        if (!ImGui::Begin("Profiler", open)) {
+            ImGui::End();
+            return;
+        }
+
+        std::lock_guard lock{ g_Mutex };
+        int lastFrame = (g_HistoryIndex + kHistorySize - 1) % kHistorySize;
+
+        if (auto frame = FindTimer("Frame")) {
+            ImGui::Text("Frame: %.2f ms", frame->history[lastFrame]);
+            PlotHistory("##Frame", frame->history, 60.0f);
+        }
+
+        if (ImGui::BeginTable("Timers", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Scope");
+            ImGui::TableSetupColumn("Frame ms");
+            ImGui::TableSetupColumn("Max ms");
+            ImGui::TableSetupColumn("Last call ms");
+            ImGui::TableHeadersRow();
+            for (size_t i = 0; i < g_TimerCount; i++) {
+                auto& timer = g_Timers[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(timer.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", timer.history[lastFrame]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", *std::max_element(timer.history, timer.history + kHistorySize));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", timer.lastMs);
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+        for (size_t i = 0; i < kCounterCount; i++) {
+            ImGui::Text("%s: %.0f", kCounterNames[i], g_CounterHistory[i][lastFrame]);
+            ImGui::PushID(static_cast<int>(i));
+            PlotHistory("##Counter", g_CounterHistory[i], 30.0f);
+            ImGui::PopID();
+        }
+
+#ifdef BLENDGRAPH_TRACK_ALLOCATIONS
+        ImGui::Separator();
+        bool trackCallSites = AllocTracker::IsCallSiteTracking();
+        if (ImGui::Checkbox("Record allocation call sites", &trackCallSites))
+            AllocTracker::SetCallSiteTracking(trackCallSites);
+        ImGui::SameLine();
+        if (ImGui::Button("Reset"))
+            AllocTracker::ResetCallSites();
+
+        // Symbolizing is slow, so the histogram is only refreshed a few times per second.
+        static std::vector<AllocTracker::CallSite> callSites;
+        static double lastRefresh = 0.0;
+        if (ImGui::GetTime() - lastRefresh > 0.5) {
+            callSites = AllocTracker::GetCallSites(20);
+            lastRefresh = ImGui::GetTime();
+        }
+        if (ImGui::BeginTable("CallSites", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Bytes");
+            ImGui::TableSetupColumn("Call stack");
+            ImGui::TableHeadersRow();
+            for (auto& site : callSites) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(site.count));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(site.bytes));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(site.stack.c_str());
+            }
+            ImGui::EndTable();
+        }
+#endif
+
+        ImGui::End();
+    }
+}
+#endif
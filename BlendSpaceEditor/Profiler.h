@@ -0,0 +1,49 @@
+#pragma once
+#include "Trace.h"
+#include <chrono>
+#include <cstdint>
+
+// Scoped timers and per-frame counters for the hot paths, shown in an overlay window.
+// Everything is compiled out unless BLENDGRAPH_PROFILE is defined; scopes then only feed Trace, which is always available.
+namespace Profiler
+{
+    enum class Counter
+    {
+        NodesDrawn,
+        PinsDrawn,
+        LinksSubmitted,
+        Allocations,
+        Count
+    };
+
+    class ScopedTimer
+    {
+    public:
+        // name must outlive the profiler, e.g. a string literal.
+        explicit ScopedTimer(const char* name);
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Trace::Scope m_Trace;
+        const char* m_Name;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    void AddCount(Counter counter, int64_t value);
+    // Moves this frame's timer and counter totals into the rolling history.
+    void EndFrame();
+    void DrawOverlay(bool* open);
+}
+
+#ifdef BLENDGRAPH_PROFILE
+#define PROFILE_SCOPE(name) ::Profiler::ScopedTimer TRACE_CONCAT(profileScope_, __LINE__){ name }
+#define PROFILE_COUNT(counter, value) ::Profiler::AddCount(::Profiler::Counter::counter, static_cast<int64_t>(value))
+#define PROFILE_FRAME() ::Profiler::EndFrame()
+#else
+#define PROFILE_SCOPE(name) TRACE_SCOPE(name)
+#define PROFILE_COUNT(counter, value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
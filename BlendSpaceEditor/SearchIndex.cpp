@@ -0,0 +1,287 @@
+#include "SearchIndex.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+namespace
+{
+    // Longer text is only found by its first words, which keeps a pasted paragraph from flooding the index.
+    constexpr size_t kMaxWordsPerText = 16;
+
+    bool IsSeparator(char c)
+    {
+        // Bytes of multi-byte UTF-8 characters count as letters.
+        auto byte = static_cast<unsigned char>(c);
+        return byte < 0x80 && !((byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z'));
+    }
+
+    char ToLower(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // The whole text, then the rest of it from each word: after a separator, or at a capital following a
+    // lowercase letter, as in "RunFast".
+    void AppendKeys(std::string_view text, std::vector<std::string>& keys)
+    {
+        if (text.empty())
+            return;
+
+        const auto append = [&](size_t start) {
+            auto& key = keys.emplace_back(text.substr(start));
+            std::transform(key.begin(), key.end(), key.begin(), ToLower);
+        };
+
+        append(0);
+        size_t words = 1;
+        for (size_t i = 1; i < text.size() && words < kMaxWordsPerText; i++) {
+            char c = text[i], previous = text[i - 1];
+            bool camelCase = c >= 'A' && c <= 'Z' && previous >= 'a' && previous <= 'z';
+            if (!IsSeparator(c) && (IsSeparator(previous) || camelCase)) {
+                append(i);
+                words++;
+            }
+        }
+    }
+
+    // With changedPin set, its value is taken from before instead, giving the node's keys ahead of the change.
+    void CollectKeys(const Node& node, const Pin* changedPin, const Pin::ConnectionVariant* before, std::vector<std::string>& keys)
+    {
+        keys.clear();
+        AppendKeys(node.def->typeName, keys);
+        AppendKeys(node.def->name, keys);
+        for (auto& input : node.inputs) {
+            if (input.type != PinType::CustomString)
+                continue;
+            auto& connected = &input == changedPin ? *before : input.connected;
+            AppendKeys(std::get<NodeStringCustomValueConnection>(connected).value, keys);
+        }
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+
+    struct TermKeyLess
+    {
+        template <typename TermT>
+        bool operator()(const TermT& term, std::string_view key) const { return term.key < key; }
+    };
+}
+
+SearchIndex::SearchIndex(Editor& editor) : m_Editor(editor)
+{
+    m_Editor.AddListener(this);
+}
+
+SearchIndex::~SearchIndex()
+{
+    m_Editor.RemoveListener(this);
+}
+
+void SearchIndex::Find(std::string_view query, std::vector<ed::NodeId>& results)
+{
+    PROFILE_SCOPE("SearchIndex::Find");
+    Flush();
+    results.clear();
+
+    size_t wordCount = 0;
+    for (size_t start = 0; start < query.size();) {
+        size_t end = query.find_first_of(" \t", start);
+        if (end == std::string_view::npos)
+            end = query.size();
+        if (end == start) {
+            start++;
+            continue;
+        }
+
+        m_QueryWord.assign(query.substr(start, end - start));
+        std::transform(m_QueryWord.begin(), m_QueryWord.end(), m_QueryWord.begin(), ToLower);
+        SetWordMatches(m_QueryWord);
+        if (wordCount++ == 0) {
+            m_Matches.swap(m_WordMatches);
+        }
+        else {
+            for (size_t i = 0; i < m_Matches.size(); i++)
+                m_Matches[i] &= m_WordMatches[i];
+        }
+        start = end;
+    }
+
+    if (!wordCount)
+        return;
+
+    for (size_t i = 0; i < m_Matches.size(); i++) {
+        for (auto bits = m_Matches[i]; bits; bits &= bits - 1)
+            results.emplace_back(i * 64 + std::countr_zero(bits));
+    }
+}
+
+void SearchIndex::OnGraphReset()
+{
+    m_Revision++;
+    m_RebuildPending = true;
+}
+
+void SearchIndex::OnNodeSpawned(const Node& node, const ImVec2& position)
+{
+    m_Revision++;
+    if (!m_RebuildPending)
+        m_DirtyNodes.insert(node.id.Get());
+}
+
+void SearchIndex::OnNodeDestroying(const Node& node)
+{
+    MarkDirty(node, nullptr, nullptr);
+}
+
+void SearchIndex::OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit)
+{
+    if (pin.type != PinType::CustomString)
+        return;
+    if (auto node = m_Editor.FindNode(pin.node))
+        MarkDirty(*node, &pin, &before);
+}
+
+void SearchIndex::MarkDirty(const Node& node, const Pin* changedPin, const Pin::ConnectionVariant* before)
+{
+    m_Revision++;
+    // A node that's already dirty had its indexed keys queued by its first change.
+    if (m_RebuildPending || !m_DirtyNodes.insert(node.id.Get()).second)
+        return;
+
+    CollectKeys(node, changedPin, before, m_KeyBuffer);
+    for (auto& key : m_KeyBuffer)
+        m_PendingRemovals.emplace_back(std::move(key), node.id.Get());
+}
+
+void SearchIndex::Flush()
+{
+    if (m_RebuildPending) {
+        Rebuild();
+        return;
+    }
+    if (m_DirtyNodes.empty())
+        return;
+
+    PROFILE_SCOPE("SearchIndex::Flush");
+    for (auto id : m_DirtyNodes) {
+        // Nodes destroyed since they were marked only have their removals to apply.
+        auto node = m_Editor.FindNode(id);
+        if (!node)
+            continue;
+
+        CollectKeys(*node, nullptr, nullptr, m_KeyBuffer);
+        for (auto& key : m_KeyBuffer)
+            m_PendingAdditions.emplace_back(std::move(key), id);
+    }
+    m_DirtyNodes.clear();
+
+    ApplyRemovals();
+    ApplyAdditions();
+}
+
+void SearchIndex::Rebuild()
+{
+    PROFILE_SCOPE("SearchIndex::Rebuild");
+    m_Terms.clear();
+    m_DirtyNodes.clear();
+    m_PendingRemovals.clear();
+    m_PendingAdditions.clear();
+    m_RebuildPending = false;
+
+    // Most keys are shared by many nodes, like those of a type, so grouping by key first leaves far fewer to sort.
+    std::unordered_map<std::string, std::vector<uintptr_t>> nodesByKey;
+    for (auto& node : m_Editor.m_Nodes) {
+        CollectKeys(node, nullptr, nullptr, m_KeyBuffer);
+        for (auto& key : m_KeyBuffer)
+            nodesByKey[std::move(key)].push_back(node.id.Get());
+        m_MaxNodeId = std::max(m_MaxNodeId, node.id.Get());
+    }
+
+    m_Terms.reserve(nodesByKey.size());
+    for (auto& [key, nodes] : nodesByKey) {
+        std::sort(nodes.begin(), nodes.end());
+        m_Terms.push_back({ key, std::move(nodes) });
+    }
+    std::sort(m_Terms.begin(), m_Terms.end(), [](const Term& a, const Term& b) { return a.key < b.key; });
+}
+
+void SearchIndex::ApplyRemovals()
+{
+    std::sort(m_PendingRemovals.begin(), m_PendingRemovals.end());
+
+    bool emptiedTerms = false;
+    auto term = m_Terms.begin();
+    for (size_t begin = 0, end = 0; begin < m_PendingRemovals.size(); begin = end) {
+        auto& key = m_PendingRemovals[begin].first;
+        while (end < m_PendingRemovals.size() && m_PendingRemovals[end].first == key)
+            end++;
+
+        term = std::lower_bound(term, m_Terms.end(), key, TermKeyLess{});
+        if (term == m_Terms.end() || term->key != key)
+            continue;
+
+        // Both ID lists are ascending, so one pass drops the removed ones.
+        auto removed = m_PendingRemovals.begin() + begin;
+        auto removedEnd = m_PendingRemovals.begin() + end;
+        std::erase_if(term->nodes, [&](uintptr_t id) {
+            while (removed != removedEnd && removed->second < id)
+                ++removed;
+            return removed != removedEnd && removed->second == id;
+        });
+        emptiedTerms |= term->nodes.empty();
+    }
+    m_PendingRemovals.clear();
+
+    if (emptiedTerms)
+        std::erase_if(m_Terms, [](const Term& term) { return term.nodes.empty(); });
+}
+
+void SearchIndex::ApplyAdditions()
+{
+    std::sort(m_PendingAdditions.begin(), m_PendingAdditions.end());
+
+    std::vector<Term> newTerms;
+    auto term = m_Terms.begin();
+    for (size_t begin = 0, end = 0; begin < m_PendingAdditions.size(); begin = end) {
+        auto& key = m_PendingAdditions[begin].first;
+        while (end < m_PendingAdditions.size() && m_PendingAdditions[end].first == key)
+            end++;
+        m_MaxNodeId = std::max(m_MaxNodeId, m_PendingAdditions[end - 1].second);
+
+        term = std::lower_bound(term, m_Terms.end(), key, TermKeyLess{});
+        std::vector<uintptr_t>* nodes;
+        if (term != m_Terms.end() && term->key == key)
+            nodes = &term->nodes;
+        else
+            nodes = &newTerms.emplace_back(Term{ std::move(key), {} }).nodes;
+
+        auto middle = nodes->size();
+        for (auto i = begin; i < end; i++)
+            nodes->push_back(m_PendingAdditions[i].second);
+        std::inplace_merge(nodes->begin(), nodes->begin() + middle, nodes->end());
+    }
+    m_PendingAdditions.clear();
+
+    if (newTerms.empty())
+        return;
+
+    // New keys arrive sorted, so one merge places them all.
+    std::vector<Term> merged;
+    merged.reserve(m_Terms.size() + newTerms.size());
+    std::merge(std::make_move_iterator(m_Terms.begin()), std::make_move_iterator(m_Terms.end()),
+        std::make_move_iterator(newTerms.begin()), std::make_move_iterator(newTerms.end()),
+        std::back_inserter(merged), [](const Term& a, const Term& b) { return a.key < b.key; });
+    m_Terms = std::move(merged);
+}
+
+void SearchIndex::SetWordMatches(std::string_view word)
+{
+    m_WordMatches.assign(m_MaxNodeId / 64 + 1, 0);
+    auto term = std::lower_bound(m_Terms.begin(), m_Terms.end(), word, TermKeyLess{});
+    for (; term != m_Terms.end() && term->key.starts_with(word); ++term) {
+        for (auto id : term->nodes)
+            m_WordMatches[id / 64] |= uint64_t{ 1 } << (id % 64);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Editor.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Finds an Editor's nodes by type or custom string value, such as an animation file, a bone name or a
+// variable name. Each node is indexed under keys taken from its type name, display name and string values:
+// the whole text and every suffix of it that starts a word, lowercased, so "run" finds "Anims/Run_Fast.glb"
+// and "fast.glb" does too. Keys are kept sorted, which makes every prefix a contiguous range.
+//
+// Changes are picked up as the editor reports them and applied in one batch by the next Find, so a burst of
+// edits, or a delete of thousands of nodes, costs one pass over the keys it touches.
+class SearchIndex : public EditorListener
+{
+public:
+    explicit SearchIndex(Editor& editor);
+    ~SearchIndex() override;
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    // Nodes with a key starting with each whitespace-separated word of query, case-insensitively, in ID order.
+    void Find(std::string_view query, std::vector<ed::NodeId>& results);
+    // Changes whenever the graph does in a way that can change what Find returns.
+    uint64_t GetRevision() const { return m_Revision; }
+
+    void OnGraphReset() override;
+    void OnNodeSpawned(const Node& node, const ImVec2& position) override;
+    void OnNodeDestroying(const Node& node) override;
+    void OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit) override;
+
+private:
+    struct Term
+    {
+        std::string key;
+        // Node IDs, ascending.
+        std::vector<uintptr_t> nodes;
+    };
+
+    using Posting = std::pair<std::string, uintptr_t>;
+
+    // Queues the removal of node's keys, as they were when it was last indexed, and its re-indexing.
+    void MarkDirty(const Node& node, const Pin* changedPin, const Pin::ConnectionVariant* before);
+    void Flush();
+    void Rebuild();
+    void ApplyRemovals();
+    void ApplyAdditions();
+    void SetWordMatches(std::string_view word);
+
+    Editor& m_Editor;
+    std::vector<Term> m_Terms;
+    uint64_t m_Revision = 0;
+    bool m_RebuildPending = true;
+    // Nodes whose keys are queued for removal and that are re-indexed by the next Flush, if they still exist.
+    std::unordered_set<uintptr_t> m_DirtyNodes;
+    std::vector<Posting> m_PendingRemovals;
+    std::vector<Posting> m_PendingAdditions;
+    uintptr_t m_MaxNodeId = 0;
+    // Bit sets indexed by node ID, reused from query to query.
+    std::vector<uint64_t> m_Matches;
+    std::vector<uint64_t> m_WordMatches;
+    std::vector<std::string> m_KeyBuffer;
+    std::string m_QueryWord;
+};
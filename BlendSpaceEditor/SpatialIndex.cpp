@@ -0,0 +1,228 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // One short of the largest int32_t, so loops running up to a range's max cell can step past it.
+    constexpr double kMinCell = std::numeric_limits<int32_t>::min();
+    constexpr double kMaxCell = std::numeric_limits<int32_t>::max() - 1;
+
+    int32_t ToCell(float coordinate, float invCellSize)
+    {
+        // Clamped first, since converting an out of range value to an integer is undefined.
+        return static_cast<int32_t>(std::clamp(std::floor(static_cast<double>(coordinate) * invCellSize), kMinCell, kMaxCell));
+    }
+}
+
+SpatialIndex::SpatialIndex(float cellSize) :
+    m_CellSize(cellSize),
+    m_InvCellSize(1.0f / cellSize)
+{
+}
+
+void SpatialIndex::Clear()
+{
+    m_Entries.clear();
+    m_FreeSlots.clear();
+    m_Slots.clear();
+    m_Cells.clear();
+    ++m_Revision;
+}
+
+void SpatialIndex::Insert(uint64_t id, const Rect& bounds)
+{
+    if (m_Slots.contains(id)) {
+        Update(id, bounds);
+        return;
+    }
+
+    uint32_t slot;
+    if (!m_FreeSlots.empty()) {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<uint32_t>(m_Entries.size());
+        m_Entries.emplace_back();
+    }
+
+    auto& entry = m_Entries[slot];
+    entry.id = id;
+    entry.bounds = bounds;
+    entry.cells = GetCellRange(bounds);
+    entry.stamp = m_QueryStamp;
+    m_Slots.emplace(id, slot);
+    AddToCells(slot);
+    ++m_Revision;
+}
+
+void SpatialIndex::Update(uint64_t id, const Rect& bounds)
+{
+    auto iter = m_Slots.find(id);
+    if (iter == m_Slots.end()) {
+        Insert(id, bounds);
+        return;
+    }
+
+    auto& entry = m_Entries[iter->second];
+    if (entry.bounds.minX == bounds.minX && entry.bounds.minY == bounds.minY &&
+        entry.bounds.maxX == bounds.maxX && entry.bounds.maxY == bounds.maxY) {
+        return;
+    }
+
+    auto cells = GetCellRange(bounds);
+    if (cells == entry.cells) {
+        entry.bounds = bounds;
+    }
+    else {
+        RemoveFromCells(iter->second);
+        entry.bounds = bounds;
+        entry.cells = cells;
+        AddToCells(iter->second);
+    }
+    ++m_Revision;
+}
+
+void SpatialIndex::Remove(uint64_t id)
+{
+    auto iter = m_Slots.find(id);
+    if (iter == m_Slots.end())
+        return;
+
+    RemoveFromCells(iter->second);
+    m_FreeSlots.push_back(iter->second);
+    m_Slots.erase(iter);
+    ++m_Revision;
+}
+
+bool SpatialIndex::Contains(uint64_t id) const
+{
+    return m_Slots.contains(id);
+}
+
+const SpatialIndex::Rect* SpatialIndex::GetBounds(uint64_t id) const
+{
+    auto iter = m_Slots.find(id);
+    if (iter == m_Slots.end())
+        return nullptr;
+
+    return &m_Entries[iter->second].bounds;
+}
+
+void SpatialIndex::QueryRect(const Rect& area, std::vector<uint64_t>& out)
+{
+    if (m_Slots.empty())
+        return;
+
+    ++m_QueryStamp;
+    auto range = GetCellRange(area);
+    // Spans of clamped ranges can exceed int32_t.
+    int64_t rangeWidth = int64_t{ range.maxX } - range.minX + 1;
+    int64_t rangeHeight = int64_t{ range.maxY } - range.minY + 1;
+    if (rangeWidth <= 0 || rangeHeight <= 0)
+        return;
+    uint64_t rangeCells = static_cast<uint64_t>(rangeWidth) * static_cast<uint64_t>(rangeHeight);
+
+    // Large areas (e.g. zoomed far out) would mostly visit empty cells, so walk the occupied ones instead.
+    if (rangeCells > m_Cells.size()) {
+        for (auto& [key, slots] : m_Cells) {
+            int32_t x = static_cast<int32_t>(key >> 32);
+            int32_t y = static_cast<int32_t>(key & 0xFFFFFFFF);
+            if (x >= range.minX && x <= range.maxX && y >= range.minY && y <= range.maxY)
+                VisitCell(key, area, out);
+        }
+        return;
+    }
+
+    for (int32_t y = range.minY; y <= range.maxY; y++) {
+        for (int32_t x = range.minX; x <= range.maxX; x++) {
+            VisitCell(GetCellKey(x, y), area, out);
+        }
+    }
+}
+
+void SpatialIndex::QueryPoint(float x, float y, std::vector<uint64_t>& out)
+{
+    Rect point{ x, y, x, y };
+    QueryRect(point, out);
+}
+
+size_t SpatialIndex::GetSize() const
+{
+    return m_Slots.size();
+}
+
+uint64_t SpatialIndex::GetRevision() const
+{
+    return m_Revision;
+}
+
+SpatialIndex::CellRange SpatialIndex::GetCellRange(const Rect& bounds) const
+{
+    // Bounds with a NaN get an empty range, so they're in no cell and queries with them find nothing.
+    if (std::isnan(bounds.minX) || std::isnan(bounds.minY) || std::isnan(bounds.maxX) || std::isnan(bounds.maxY))
+        return { 0, 0, -1, -1 };
+
+    return {
+        ToCell(bounds.minX, m_InvCellSize),
+        ToCell(bounds.minY, m_InvCellSize),
+        ToCell(bounds.maxX, m_InvCellSize),
+        ToCell(bounds.maxY, m_InvCellSize)
+    };
+}
+
+uint64_t SpatialIndex::GetCellKey(int32_t x, int32_t y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+void SpatialIndex::AddToCells(uint32_t slot)
+{
+    auto& cells = m_Entries[slot].cells;
+    for (int32_t y = cells.minY; y <= cells.maxY; y++) {
+        for (int32_t x = cells.minX; x <= cells.maxX; x++) {
+            m_Cells[GetCellKey(x, y)].push_back(slot);
+        }
+    }
+}
+
+void SpatialIndex::RemoveFromCells(uint32_t slot)
+{
+    auto& cells = m_Entries[slot].cells;
+    for (int32_t y = cells.minY; y <= cells.maxY; y++) {
+        for (int32_t x = cells.minX; x <= cells.maxX; x++) {
+            auto iter = m_Cells.find(GetCellKey(x, y));
+            if (iter == m_Cells.end())
+                continue;
+
+            auto& slots = iter->second;
+            auto slotIter = std::find(slots.begin(), slots.end(), slot);
+            if (slotIter != slots.end()) {
+                *slotIter = slots.back();
+                slots.pop_back();
+            }
+
+            if (slots.empty())
+                m_Cells.erase(iter);
+        }
+    }
+}
+
+void SpatialIndex::VisitCell(uint64_t key, const Rect& area, std::vector<uint64_t>& out)
+{
+    auto iter = m_Cells.find(key);
+    if (iter == m_Cells.end())
+        return;
+
+    for (auto slot : iter->second) {
+        auto& entry = m_Entries[slot];
+        if (entry.stamp == m_QueryStamp)
+            continue;
+
+        entry.stamp = m_QueryStamp;
+        if (entry.bounds.Overlaps(area))
+            out.push_back(entry.id);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over node bounds in canvas space. Entries are keyed by node ID and
+// may span several cells; queries de-duplicate them with a per-query stamp.
+class SpatialIndex
+{
+public:
+    struct Rect
+    {
+        float minX = 0.0f;
+        float minY = 0.0f;
+        float maxX = 0.0f;
+        float maxY = 0.0f;
+
+        inline bool Overlaps(const Rect& other) const
+        {
+            return minX <= other.maxX && maxX >= other.minX && minY <= other.maxY && maxY >= other.minY;
+        }
+
+        inline bool Contains(float x, float y) const
+        {
+            return x >= minX && x <= maxX && y >= minY && y <= maxY;
+        }
+    };
+
+    explicit SpatialIndex(float cellSize = 256.0f);
+
+    void Clear();
+    void Insert(uint64_t id, const Rect& bounds);
+    void Update(uint64_t id, const Rect& bounds);
+    void Remove(uint64_t id);
+    bool Contains(uint64_t id) const;
+    const Rect* GetBounds(uint64_t id) const;
+
+    // Results are appended to out, each ID at most once.
+    void QueryRect(const Rect& area, std::vector<uint64_t>& out);
+    void QueryPoint(float x, float y, std::vector<uint64_t>& out);
+
+    size_t GetSize() const;
+    // Bumped whenever an entry is added, removed or changes bounds.
+    uint64_t GetRevision() const;
+
+private:
+    struct CellRange
+    {
+        int32_t minX, minY, maxX, maxY;
+
+        inline bool operator==(const CellRange& other) const
+        {
+            return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+        }
+    };
+
+    struct Entry
+    {
+        uint64_t id;
+        Rect bounds;
+        CellRange cells;
+        uint32_t stamp;
+    };
+
+    CellRange GetCellRange(const Rect& bounds) const;
+    static uint64_t GetCellKey(int32_t x, int32_t y);
+    void AddToCells(uint32_t slot);
+    void RemoveFromCells(uint32_t slot);
+    void VisitCell(uint64_t key, const Rect& area, std::vector<uint64_t>& out);
+
+    float m_CellSize;
+    float m_InvCellSize;
+    uint32_t m_QueryStamp = 0;
+    uint64_t m_Revision = 0;
+    std::vector<Entry> m_Entries;
+    std::vector<uint32_t> m_FreeSlots;
+    std::unordered_map<uint64_t, uint32_t> m_Slots;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_Cells;
+};
@@ -0,0 +1,77 @@
+#include "StringPool.h"
+#include <cstring>
+#include <functional>
+
+namespace
+{
+    constexpr size_t kBlockSize = 16 * 1024;
+    // Longer strings get a block of their own rather than wasting the rest of the current one.
+    constexpr size_t kMaxSharedLength = kBlockSize / 4;
+    // Recently interned strings per thread, so the common repeats ("output", the same bone name on every
+    // IK node) skip the shard lock.
+    constexpr size_t kRecentCount = 256;
+}
+
+StringPool& StringPool::Get()
+{
+    static StringPool pool;
+    return pool;
+}
+
+std::string_view StringPool::Intern(std::string_view text)
+{
+    m_Requests.fetch_add(1, std::memory_order_relaxed);
+    m_RequestedBytes.fetch_add(text.size(), std::memory_order_relaxed);
+    if (text.empty())
+        return "";
+
+    size_t hash = std::hash<std::string_view>{}(text);
+    thread_local std::array<std::string_view, kRecentCount> recent;
+    auto& cached = recent[hash % kRecentCount];
+    if (cached == text)
+        return cached;
+
+    auto& shard = m_Shards[(hash >> 8) % kShardCount];
+    std::lock_guard lock{ shard.mutex };
+    if (auto it = shard.strings.find(text); it != shard.strings.end())
+        return cached = *it;
+
+    size_t size = text.size() + 1;
+    char* storage;
+    if (size > kMaxSharedLength) {
+        storage = shard.blocks.emplace_back(std::make_unique<char[]>(size)).get();
+        shard.reservedBytes += size;
+    }
+    else {
+        if (size > shard.remaining) {
+            shard.next = shard.blocks.emplace_back(std::make_unique<char[]>(kBlockSize)).get();
+            shard.remaining = kBlockSize;
+            shard.reservedBytes += kBlockSize;
+        }
+        storage = shard.next;
+        shard.next += size;
+        shard.remaining -= size;
+    }
+
+    std::memcpy(storage, text.data(), text.size());
+    storage[text.size()] = '\0';
+    shard.storedBytes += size;
+
+    std::string_view interned{ storage, text.size() };
+    shard.strings.insert(interned);
+    return cached = interned;
+}
+
+StringPool::Stats StringPool::GetStats()
+{
+    Stats stats;
+    stats.requests = m_Requests.load(std::memory_order_relaxed);
+    stats.requestedBytes = m_RequestedBytes.load(std::memory_order_relaxed);
+    for (auto& shard : m_Shards) {
+        std::lock_guard lock{ shard.mutex };
+        stats.strings += shard.strings.size();
+        stats.storedBytes += shard.storedBytes;
+        stats.reservedBytes += shard.reservedBytes;
+    }
+    return stats;
+}
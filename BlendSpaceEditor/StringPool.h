@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Deduplicated, immutable strings for text that repeats across graphs: link type names, bone names,
+// animation paths. Interning equal text always returns the same view, and views stay valid until the
+// process exits, so nodes, undo steps and clipboards can hold them without owning a copy. Views are
+// NUL-terminated. Safe to use from any thread.
+class StringPool
+{
+public:
+    struct Stats
+    {
+        // Intern calls and the total length of the text passed to them.
+        size_t requests = 0;
+        size_t requestedBytes = 0;
+        // Distinct strings stored, and the arena bytes they use including terminators.
+        size_t strings = 0;
+        size_t storedBytes = 0;
+        // Arena bytes allocated.
+        size_t reservedBytes = 0;
+    };
+
+    static StringPool& Get();
+
+    std::string_view Intern(std::string_view text);
+    Stats GetStats();
+
+private:
+    // Strings are spread over shards by hash so that parallel loads rarely wait on the same lock.
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_set<std::string_view> strings;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* next = nullptr;
+        size_t remaining = 0;
+        size_t storedBytes = 0;
+        size_t reservedBytes = 0;
+    };
+
+    static constexpr size_t kShardCount = 16;
+
+    std::array<Shard, kShardCount> m_Shards;
+    std::atomic<size_t> m_Requests{ 0 };
+    std::atomic<size_t> m_RequestedBytes{ 0 };
+};
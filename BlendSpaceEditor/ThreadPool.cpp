@@ -0,0 +1,135 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#undef max
+#undef min
+
+namespace
+{
+    struct ParallelForState
+    {
+        const std::function<void(size_t, size_t)>* fn = nullptr;
+        size_t count = 0;
+        size_t chunkSize = 0;
+        size_t chunkCount = 0;
+        std::atomic<size_t> nextChunk{ 0 };
+
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t completedChunks = 0;
+        size_t failedChunk = SIZE_MAX;
+        std::exception_ptr exception;
+
+        // Runs chunks until none are left. Once the last chunk has completed the caller may return,
+        // so fn is only touched while a claimed chunk is outstanding.
+        void RunChunks()
+        {
+            for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+                size_t begin = chunk * chunkSize;
+                size_t end = std::min(begin + chunkSize, count);
+                std::exception_ptr chunkException;
+                try {
+                    (*fn)(begin, end);
+                }
+                catch (...) {
+                    chunkException = std::current_exception();
+                }
+
+                std::lock_guard lock{ mutex };
+                if (chunkException && chunk < failedChunk) {
+                    failedChunk = chunk;
+                    exception = chunkException;
+                }
+                if (++completedChunks == chunkCount)
+                    done.notify_all();
+            }
+        }
+    };
+}
+
+ThreadPool::ThreadPool(unsigned workerCount)
+{
+    for (unsigned i = 0; i < workerCount; i++)
+        m_Workers.emplace_back(&ThreadPool::WorkerMain, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock{ m_Mutex };
+        m_Stopping = true;
+    }
+    m_WorkReady.notify_all();
+    for (auto& worker : m_Workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::Get()
+{
+    static ThreadPool pool{ std::max(std::thread::hardware_concurrency(), 1u) - 1 };
+    return pool;
+}
+
+unsigned ThreadPool::GetWorkerCount() const
+{
+    return static_cast<unsigned>(m_Workers.size());
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& fn, unsigned maxThreads)
+{
+    if (count == 0)
+        return;
+
+    unsigned threads = GetWorkerCount() + 1;
+    if (maxThreads != 0)
+        threads = std::min(threads, maxThreads);
+
+    // A few chunks per thread keeps threads busy when chunks take uneven time.
+    minChunk = std::max<size_t>(minChunk, 1);
+    size_t chunkCount = std::min((count + minChunk - 1) / minChunk, static_cast<size_t>(threads) * 4);
+    if (threads == 1 || chunkCount <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->fn = &fn;
+    state->count = count;
+    state->chunkSize = (count + chunkCount - 1) / chunkCount;
+    state->chunkCount = (count + state->chunkSize - 1) / state->chunkSize;
+
+    size_t helpers = std::min<size_t>(threads - 1, state->chunkCount - 1);
+    {
+        std::lock_guard lock{ m_Mutex };
+        for (size_t i = 0; i < helpers; i++)
+            m_Queue.emplace_back([state]() { state->RunChunks(); });
+    }
+    m_WorkReady.notify_all();
+
+    state->RunChunks();
+
+    std::unique_lock lock{ state->mutex };
+    state->done.wait(lock, [&]() { return state->completedChunks == state->chunkCount; });
+    if (state->exception)
+        std::rethrow_exception(state->exception);
+}
+
+void ThreadPool::WorkerMain()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{ m_Mutex };
+            m_WorkReady.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+            if (m_Stopping && m_Queue.empty())
+                return;
+
+            task = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread runs chunks as well,
+// so a loop always makes progress even when every worker is busy.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned workerCount);
+    ~ThreadPool();
+
+    // Shared pool with one worker per hardware thread besides the caller, created on first use.
+    static ThreadPool& Get();
+
+    unsigned GetWorkerCount() const;
+
+    // Calls fn(begin, end) over [0, count) in chunks of at least minChunk items, on at most maxThreads
+    // threads including the caller (0 for no limit). Blocks until every chunk has run. If chunks throw,
+    // the exception from the lowest chunk is rethrown, so failures are reported deterministically.
+    void ParallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& fn, unsigned maxThreads = 0);
+
+private:
+    void WorkerMain();
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::deque<std::function<void()>> m_Queue;
+    bool m_Stopping = false;
+};
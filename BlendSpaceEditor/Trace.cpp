@@ -0,0 +1,176 @@
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr uint64_t kBufferCapacity = 1 << 16;
+
+    struct Event
+    {
+        const char* name;
+        int64_t start;
+        int64_t end;
+    };
+
+    // Written only by its owning thread; the writer publishes each event with a release store of written.
+    struct ThreadBuffer
+    {
+        uint32_t tid = 0;
+        std::string name;
+        // Allocated on the first event, so naming a thread that never records stays cheap.
+        std::unique_ptr<Event[]> events;
+        std::atomic<uint64_t> written{ 0 };
+        // Set around each Record, so Stop can wait for events that were being written as it stopped.
+        std::atomic<bool> recording{ false };
+        // The thread that owned it has exited; the buffer goes to the next new thread once its events are stale.
+        bool free = false;
+    };
+
+    // Buffers outlive their threads, so events from threads that have exited can still be written out.
+    std::mutex g_BuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> g_Buffers;
+    int64_t g_StartTime = 0;
+    int64_t g_StopTime = 0;
+
+    // Whether Write would still include any of the buffer's events. Requires g_BuffersMutex.
+    bool HoldsRecordedEvents(const ThreadBuffer& buffer)
+    {
+        uint64_t written = buffer.written.load(std::memory_order_relaxed);
+        return written > 0 && buffer.events[(written - 1) & (kBufferCapacity - 1)].end >= g_StartTime;
+    }
+
+    // Hands the calling thread's buffer back when it exits. Threads such as AsyncGraphLoad's come and go
+    // with each file, so each would otherwise keep a buffer of kBufferCapacity events for good.
+    struct BufferOwner
+    {
+        ThreadBuffer* buffer = nullptr;
+
+        ~BufferOwner()
+        {
+            if (!buffer)
+                return;
+            std::lock_guard lock{ g_BuffersMutex };
+            buffer->free = true;
+        }
+    };
+
+    thread_local BufferOwner t_Owner;
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if (!t_Owner.buffer) {
+            std::lock_guard lock{ g_BuffersMutex };
+            for (auto& buffer : g_Buffers) {
+                if (buffer->free && !HoldsRecordedEvents(*buffer)) {
+                    buffer->free = false;
+                    buffer->name.clear();
+                    buffer->written.store(0, std::memory_order_relaxed);
+                    t_Owner.buffer = buffer.get();
+                    return *t_Owner.buffer;
+                }
+            }
+            auto& buffer = g_Buffers.emplace_back(std::make_unique<ThreadBuffer>());
+            buffer->tid = static_cast<uint32_t>(g_Buffers.size());
+            t_Owner.buffer = buffer.get();
+        }
+        return *t_Owner.buffer;
+    }
+}
+
+namespace Trace
+{
+    std::atomic<bool> g_recording{ false };
+
+    void Start()
+    {
+        std::lock_guard lock{ g_BuffersMutex };
+        g_StartTime = Now();
+        g_StopTime = INT64_MAX;
+        g_recording.store(true, std::memory_order_seq_cst);
+    }
+
+    void Stop()
+    {
+        // Pairs with Record: a thread either sees recording stopped or is seen here still writing.
+        g_recording.store(false, std::memory_order_seq_cst);
+        std::lock_guard lock{ g_BuffersMutex };
+        g_StopTime = Now();
+        for (auto& buffer : g_Buffers) {
+            while (buffer->recording.load(std::memory_order_seq_cst))
+                std::this_thread::yield();
+        }
+    }
+
+    bool Write(const std::filesystem::path& path)
+    {
+        FILE* file = nullptr;
+#ifdef _WIN32
+        _wfopen_s(&file, path.c_str(), L"wb");
+#else
+        file = std::fopen(path.c_str(), "wb");
+#endif
+        if (!file)
+            return false;
+
+        // Every event must be finished before the buffers are read.
+        if (IsRecording())
+            Stop();
+        std::lock_guard lock{ g_BuffersMutex };
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+        bool first = true;
+        for (auto& buffer : g_Buffers) {
+            if (!buffer->name.empty()) {
+                std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",", buffer->tid, buffer->name.c_str());
+                first = false;
+            }
+
+            uint64_t written = buffer->written.load(std::memory_order_acquire);
+            uint64_t begin = written > kBufferCapacity ? written - kBufferCapacity : 0;
+            for (uint64_t i = begin; i < written; i++) {
+                auto& event = buffer->events[i & (kBufferCapacity - 1)];
+                if (event.start < g_StartTime || event.end > g_StopTime)
+                    continue;
+
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",", event.name, buffer->tid, (event.start - g_StartTime) / 1000.0, (event.end - event.start) / 1000.0);
+                first = false;
+            }
+        }
+        std::fputs("]}\n", file);
+        return std::fclose(file) == 0;
+    }
+
+    void SetThreadName(const char* name)
+    {
+        auto& buffer = GetThreadBuffer();
+        std::lock_guard lock{ g_BuffersMutex };
+        buffer.name = name;
+    }
+
+    int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Record(const char* name, int64_t start, int64_t end)
+    {
+        auto& buffer = GetThreadBuffer();
+        buffer.recording.store(true, std::memory_order_seq_cst);
+        if (g_recording.load(std::memory_order_seq_cst)) {
+            if (!buffer.events)
+                buffer.events.reset(new Event[kBufferCapacity]);
+
+            uint64_t index = buffer.written.load(std::memory_order_relaxed);
+            buffer.events[index & (kBufferCapacity - 1)] = { name, start, end };
+            buffer.written.store(index + 1, std::memory_order_release);
+        }
+        buffer.recording.store(false, std::memory_order_release);
+    }
+}
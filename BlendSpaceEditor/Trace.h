@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+// Records named scopes as Chrome Trace Event Format JSON (chrome://tracing, Perfetto). Each thread appends
+// to its own ring buffer without locking, and a scope costs a single atomic load while nothing is recording.
+namespace Trace
+{
+    extern std::atomic<bool> g_recording;
+
+    inline bool IsRecording()
+    {
+        return g_recording.load(std::memory_order_relaxed);
+    }
+
+    void Start();
+    // Returns once every event being recorded as it was called is finished.
+    void Stop();
+    // Writes the events recorded between the last Start and Stop, stopping first if need be. Each thread keeps
+    // only its most recent events. Those of a thread that has exited are kept until a new thread's buffer
+    // replaces them, which happens only once a later Start has made them stale.
+    bool Write(const std::filesystem::path& path);
+    // Names the calling thread in written traces.
+    void SetThreadName(const char* name);
+
+    // Nanoseconds from an arbitrary, monotonic origin.
+    int64_t Now();
+    void Record(const char* name, int64_t start, int64_t end);
+
+    class Scope
+    {
+    public:
+        // name must outlive the recording, e.g. a string literal.
+        explicit Scope(const char* name) : m_Name(IsRecording() ? name : nullptr), m_Start(m_Name ? Now() : 0) {}
+
+        ~Scope()
+        {
+            if (m_Name && IsRecording())
+                Record(m_Name, m_Start, Now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_Name;
+        int64_t m_Start;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::Trace::Scope TRACE_CONCAT(traceScope_, __LINE__){ name }
@@ -0,0 +1,268 @@
+#include "UndoHistory.h"
+#include "Profiler.h"
+
+namespace
+{
+    // Names and string values are views into the definition table and StringPool, so they own nothing.
+    size_t NodeBytes(const Node& node)
+    {
+        size_t bytes = sizeof(Node) + (node.inputs.capacity() + node.outputs.capacity()) * sizeof(Pin);
+        for (auto& pin : node.outputs)
+            bytes += std::get<NodeOutputConnection>(pin.connected).ids.capacity() * sizeof(ed::PinId);
+        return bytes;
+    }
+}
+
+UndoHistory::UndoHistory(Editor& editor, size_t memoryBudget) : m_Editor(editor), m_MemoryBudget(memoryBudget)
+{
+    m_Editor.AddListener(this);
+}
+
+UndoHistory::~UndoHistory()
+{
+    m_Editor.RemoveListener(this);
+}
+
+bool UndoHistory::CanUndo() const
+{
+    return !m_UndoSteps.empty() || !m_OpenStep.commands.empty();
+}
+
+bool UndoHistory::CanRedo() const
+{
+    return !m_RedoSteps.empty();
+}
+
+void UndoHistory::Undo()
+{
+    CommitStep();
+    if (m_UndoSteps.empty())
+        return;
+
+    PROFILE_SCOPE("Undo");
+    m_RedoSteps.push_back(std::move(m_UndoSteps.back()));
+    m_UndoSteps.pop_back();
+    m_CanMergeValue = false;
+    Apply(m_RedoSteps.back(), true);
+}
+
+void UndoHistory::Redo()
+{
+    CommitStep();
+    if (m_RedoSteps.empty())
+        return;
+
+    PROFILE_SCOPE("Redo");
+    m_UndoSteps.push_back(std::move(m_RedoSteps.back()));
+    m_RedoSteps.pop_back();
+    m_CanMergeValue = false;
+    Apply(m_UndoSteps.back(), false);
+}
+
+void UndoHistory::CommitStep()
+{
+    if (m_OpenStep.commands.empty())
+        return;
+
+    for (auto& step : m_RedoSteps)
+        m_MemoryUsage -= step.bytes;
+    m_RedoSteps.clear();
+
+    auto& step = m_OpenStep;
+    step.bytes = step.commands.capacity() * sizeof(Command);
+    for (auto& command : step.commands)
+        step.bytes += EstimateBytes(command);
+    m_MemoryUsage += step.bytes;
+
+    m_CanMergeValue = step.commands.size() == 1 && std::holds_alternative<ValueCommand>(step.commands.front());
+    m_UndoSteps.push_back(std::move(step));
+    m_OpenStep = {};
+    Trim();
+}
+
+void UndoHistory::Clear()
+{
+    m_UndoSteps.clear();
+    m_RedoSteps.clear();
+    m_OpenStep = {};
+    m_MemoryUsage = 0;
+    m_CanMergeValue = false;
+}
+
+void UndoHistory::SetMemoryBudget(size_t bytes)
+{
+    m_MemoryBudget = bytes;
+    Trim();
+}
+
+size_t UndoHistory::GetMemoryUsage() const
+{
+    return m_MemoryUsage;
+}
+
+void UndoHistory::OnGraphReset()
+{
+    Clear();
+}
+
+void UndoHistory::OnNodeSpawned(const Node& node, const ImVec2& position)
+{
+    if (!m_Applying)
+        Record(NodeCommand{ std::make_shared<const Node>(node), position, true });
+}
+
+void UndoHistory::OnNodeDestroying(const Node& node)
+{
+    if (!m_Applying)
+        Record(NodeCommand{ std::make_shared<const Node>(node), ed::GetNodePosition(node.id), false });
+}
+
+void UndoHistory::OnLinkSpawned(const Link& link)
+{
+    if (!m_Applying)
+        Record(LinkCommand{ link.id, link.startPinID, link.endPinID, true });
+}
+
+void UndoHistory::OnLinkDestroying(const Link& link)
+{
+    if (!m_Applying)
+        Record(LinkCommand{ link.id, link.startPinID, link.endPinID, false });
+}
+
+void UndoHistory::OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit)
+{
+    if (m_Applying)
+        return;
+
+    if (continuesEdit) {
+        if (MergeValue(m_OpenStep, pin))
+            return;
+        if (m_CanMergeValue && !m_UndoSteps.empty() && MergeValue(m_UndoSteps.back(), pin))
+            return;
+    }
+
+    Record(ValueCommand{ pin.id, before, pin.connected });
+}
+
+void UndoHistory::OnNodesMoved(std::span<const NodeMove> moves)
+{
+    if (!m_Applying)
+        Record(MoveCommand{ { moves.begin(), moves.end() } });
+}
+
+void UndoHistory::Record(Command&& command)
+{
+    m_OpenStep.commands.push_back(std::move(command));
+}
+
+bool UndoHistory::MergeValue(Step& step, const Pin& pin)
+{
+    for (auto& command : step.commands) {
+        auto value = std::get_if<ValueCommand>(&command);
+        if (!value || value->pinId != pin.id)
+            continue;
+
+        // Open steps are measured when committed; committed ones are kept up to date.
+        size_t oldBytes = EstimateBytes(command);
+        value->after = pin.connected;
+        if (&step != &m_OpenStep) {
+            size_t newBytes = EstimateBytes(command);
+            step.bytes = step.bytes - oldBytes + newBytes;
+            m_MemoryUsage = m_MemoryUsage - oldBytes + newBytes;
+        }
+        return true;
+    }
+    return false;
+}
+
+void UndoHistory::Apply(Step& step, bool undo)
+{
+    m_Applying = true;
+    ed::SetCurrentEditor(m_Editor.m_Editor);
+
+    const auto apply = [this, undo](Command& command) {
+        if (auto node = std::get_if<NodeCommand>(&command)) {
+            if (node->spawned == undo) {
+                // Destroying a node's links always precedes destroying the node, so both kinds
+                // can be collected and flushed together, links first.
+                m_NodeBatch.push_back(node->node->id);
+            }
+            else {
+                FlushDestroys();
+                m_Editor.RestoreNode(*node->node, node->position);
+            }
+        }
+        else if (auto link = std::get_if<LinkCommand>(&command)) {
+            if (link->spawned == undo) {
+                m_LinkBatch.push_back(link->id);
+            }
+            else {
+                FlushDestroys();
+                auto startPin = m_Editor.FindPin(link->startPinId);
+                auto endPin = m_Editor.FindPin(link->endPinId);
+                if (startPin && endPin)
+                    m_Editor.SpawnLink(startPin, endPin, link->id);
+            }
+        }
+        else if (auto value = std::get_if<ValueCommand>(&command)) {
+            FlushDestroys();
+            if (auto pin = m_Editor.FindPin(value->pinId))
+                m_Editor.SetPinValue(*pin, undo ? value->before : value->after);
+        }
+        else if (auto move = std::get_if<MoveCommand>(&command)) {
+            FlushDestroys();
+            if (undo) {
+                m_MoveBuffer.clear();
+                for (auto& m : move->moves)
+                    m_MoveBuffer.push_back({ m.id, m.to, m.from });
+                m_Editor.MoveNodes(m_MoveBuffer);
+            }
+            else {
+                m_Editor.MoveNodes(move->moves);
+            }
+        }
+    };
+
+    if (undo) {
+        for (auto command = step.commands.rbegin(); command != step.commands.rend(); ++command)
+            apply(*command);
+    }
+    else {
+        for (auto& command : step.commands)
+            apply(command);
+    }
+    FlushDestroys();
+
+    ed::SetCurrentEditor(nullptr);
+    m_Applying = false;
+}
+
+void UndoHistory::FlushDestroys()
+{
+    if (!m_LinkBatch.empty()) {
+        m_Editor.DestroyLinks(m_LinkBatch);
+        m_LinkBatch.clear();
+    }
+    if (!m_NodeBatch.empty()) {
+        m_Editor.DestroyNodes(m_NodeBatch);
+        m_NodeBatch.clear();
+    }
+}
+
+void UndoHistory::Trim()
+{
+    // The newest step is kept even when it alone is over budget, so the last action can always be undone.
+    while (m_MemoryUsage > m_MemoryBudget && m_UndoSteps.size() > 1) {
+        m_MemoryUsage -= m_UndoSteps.front().bytes;
+        m_UndoSteps.pop_front();
+    }
+}
+
+size_t UndoHistory::EstimateBytes(const Command& command)
+{
+    if (auto node = std::get_if<NodeCommand>(&command))
+        return NodeBytes(*node->node);
+    if (auto move = std::get_if<MoveCommand>(&command))
+        return move->moves.capacity() * sizeof(NodeMove);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "Editor.h"
+#include <deque>
+#include <memory>
+#include <variant>
+#include <vector>
+
+// Undo and redo for an Editor, kept as reversible commands instead of copies of the graph. Everything
+// changed during one frame forms one step, and continued edits of a value widget merge into the step
+// that started them. Only spawned and destroyed nodes are snapshotted, immutably, so moving steps between
+// the undo and redo stacks never copies graph data. The oldest steps are dropped to stay within the memory budget.
+class UndoHistory : public EditorListener
+{
+public:
+    static constexpr size_t kDefaultMemoryBudget = size_t{ 64 } << 20;
+
+    explicit UndoHistory(Editor& editor, size_t memoryBudget = kDefaultMemoryBudget);
+    ~UndoHistory() override;
+
+    UndoHistory(const UndoHistory&) = delete;
+    UndoHistory& operator=(const UndoHistory&) = delete;
+
+    bool CanUndo() const;
+    bool CanRedo() const;
+    // Apply a whole step, setting the node editor context themselves.
+    void Undo();
+    void Redo();
+    // Ends the step holding the changes made so far. Call once per frame, after the editor.
+    void CommitStep();
+    void Clear();
+    void SetMemoryBudget(size_t bytes);
+    // Approximate bytes held by the undo and redo steps.
+    size_t GetMemoryUsage() const;
+
+    void OnGraphReset() override;
+    void OnNodeSpawned(const Node& node, const ImVec2& position) override;
+    void OnNodeDestroying(const Node& node) override;
+    void OnLinkSpawned(const Link& link) override;
+    void OnLinkDestroying(const Link& link) override;
+    void OnValueChanged(const Pin& pin, const Pin::ConnectionVariant& before, bool continuesEdit) override;
+    void OnNodesMoved(std::span<const NodeMove> moves) override;
+
+private:
+    struct NodeCommand
+    {
+        std::shared_ptr<const Node> node;
+        ImVec2 position;
+        bool spawned;
+    };
+
+    struct LinkCommand
+    {
+        ed::LinkId id;
+        ed::PinId startPinId;
+        ed::PinId endPinId;
+        bool spawned;
+    };
+
+    struct ValueCommand
+    {
+        ed::PinId pinId;
+        Pin::ConnectionVariant before;
+        Pin::ConnectionVariant after;
+    };
+
+    struct MoveCommand
+    {
+        std::vector<NodeMove> moves;
+    };
+
+    using Command = std::variant<NodeCommand, LinkCommand, ValueCommand, MoveCommand>;
+
+    struct Step
+    {
+        std::vector<Command> commands;
+        size_t bytes = 0;
+    };
+
+    void Record(Command&& command);
+    bool MergeValue(Step& step, const Pin& pin);
+    void Apply(Step& step, bool undo);
+    void FlushDestroys();
+    void Trim();
+    static size_t EstimateBytes(const Command& command);
+
+    Editor& m_Editor;
+    std::deque<Step> m_UndoSteps;
+    std::vector<Step> m_RedoSteps;
+    Step m_OpenStep;
+    size_t m_MemoryBudget;
+    size_t m_MemoryUsage = 0;
+    bool m_Applying = false;
+    // The newest undo step is a single value edit that continued changes may still merge into.
+    bool m_CanMergeValue = false;
+
+    // Consecutive destroys within a step are applied together.
+    std::vector<ed::NodeId> m_NodeBatch;
+    std::vector<ed::LinkId> m_LinkBatch;
+    std::vector<NodeMove> m_MoveBuffer;
+};
@@ -0,0 +1,220 @@
+#include "BlendSpaceEditor/ThreadPool.h"
+#include "Common/BtFiles.h"
+#include "Common/BtScan.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lists the animation files that .bt blend graphs reference through Full Animation nodes, for packaging. Only
+// the anim nodes' File values are read from each graph, straight from the text, so thousands of graphs take
+// seconds. Writes a JSON manifest of every referenced file, and which of them don't exist.
+
+namespace
+{
+	constexpr std::string_view kAnimType = "anim";
+	constexpr std::string_view kFilePin = "file";
+
+	struct GraphResult
+	{
+		std::filesystem::path path;
+		// Empty when the graph was read.
+		std::string error;
+		// Normalized, each once.
+		std::vector<std::string> animations;
+	};
+
+	struct Animation
+	{
+		std::vector<size_t> graphs;
+		bool missing = false;
+	};
+
+	std::filesystem::path FromUtf8(std::string_view text)
+	{
+		return std::u8string_view{ reinterpret_cast<const char8_t*>(text.data()), text.size() };
+	}
+
+	std::string ToUtf8(const std::filesystem::path& path)
+	{
+		auto text = path.generic_u8string();
+		return { reinterpret_cast<const char*>(text.data()), text.size() };
+	}
+
+	// Graphs are written on Windows, so either separator may appear; "a/./b.glb" and "a\b.glb" are one file.
+	std::string NormalizePath(std::string_view file)
+	{
+		std::string path{ file };
+		std::replace(path.begin(), path.end(), '\\', '/');
+		return ToUtf8(FromUtf8(path).lexically_normal());
+	}
+
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: bt-deps [options] PATH...\n"
+			"  PATH          A .bt file, or a directory to search for them\n"
+			"  -o PATH       Write the JSON manifest to PATH (default stdout)\n"
+			"  --root DIR    Directory that relative animation paths are checked against (default .)\n"
+			"  --threads N   Maximum files read at once, 0 for one per hardware thread (default 0)\n"
+			"  --quiet       Only print the summary to stderr, not each problem\n"
+			"Exits with 0 if every graph was read and every animation exists, 1 if not, 2 if the files couldn't be listed.\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::filesystem::path> roots;
+	std::filesystem::path outPath;
+	std::filesystem::path animationRoot = ".";
+	unsigned threads = 0;
+	bool quiet = false;
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "-o" && hasValue)
+			outPath = argv[++i];
+		else if (arg == "--root" && hasValue)
+			animationRoot = argv[++i];
+		else if (arg == "--threads" && hasValue) {
+			if (!BtFiles::ParseThreadCount(argv[++i], threads)) {
+				std::fprintf(stderr, "--threads takes a number, not \"%s\".\n", argv[i]);
+				PrintUsage();
+				return 2;
+			}
+		}
+		else if (arg == "--quiet")
+			quiet = true;
+		else if (!arg.starts_with("-"))
+			roots.emplace_back(arg);
+		else {
+			PrintUsage();
+			return arg == "--help" ? 0 : 2;
+		}
+	}
+
+	if (roots.empty()) {
+		PrintUsage();
+		return 2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::filesystem::path> files;
+	std::string error;
+	if (!BtFiles::Collect(roots, files, &error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 2;
+	}
+
+	std::vector<GraphResult> results(files.size());
+	ThreadPool::Get().ParallelFor(files.size(), 1, [&](size_t begin, size_t end) {
+		std::string text;
+		for (size_t i = begin; i < end; i++) {
+			auto& result = results[i];
+			result.path = files[i];
+			if (!BtFiles::Read(files[i], text, &result.error))
+				continue;
+
+			BtScan::ForEachNode(text, [&](const BtScan::Node& node) {
+				if (node.type != kAnimType)
+					return;
+				for (auto& value : node.values) {
+					if (value.pin == kFilePin && !value.value.empty())
+						result.animations.push_back(NormalizePath(value.value));
+				}
+			}, &result.error);
+
+			std::sort(result.animations.begin(), result.animations.end());
+			result.animations.erase(std::unique(result.animations.begin(), result.animations.end()), result.animations.end());
+		}
+	}, threads);
+
+	std::unordered_map<std::string, Animation> animations;
+	size_t references = 0, failedGraphs = 0;
+	for (size_t i = 0; i < results.size(); i++) {
+		// A graph that fails part way still lists what was found before the problem.
+		if (!results[i].error.empty()) {
+			failedGraphs++;
+			if (!quiet)
+				std::fprintf(stderr, "%s: %s\n", results[i].path.generic_string().c_str(), results[i].error.c_str());
+		}
+		for (auto& animation : results[i].animations)
+			animations[animation].graphs.push_back(i);
+		references += results[i].animations.size();
+	}
+
+	std::vector<std::pair<const std::string, Animation>*> sorted;
+	sorted.reserve(animations.size());
+	for (auto& entry : animations)
+		sorted.push_back(&entry);
+	std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+	ThreadPool::Get().ParallelFor(sorted.size(), 16, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			auto path = FromUtf8(sorted[i]->first);
+			std::error_code ec;
+			sorted[i]->second.missing = !std::filesystem::is_regular_file(path.is_absolute() ? path : animationRoot / path, ec);
+		}
+	}, threads);
+
+	size_t missing = 0;
+	nlohmann::json manifest;
+	manifest["tool"] = "bt-deps";
+	manifest["root"] = animationRoot.generic_string();
+	auto& manifestAnimations = manifest["animations"] = nlohmann::json::array();
+	auto& manifestMissing = manifest["missing"] = nlohmann::json::array();
+	for (auto* entry : sorted) {
+		auto& [path, animation] = *entry;
+		manifestAnimations.push_back({ { "path", path }, { "graphs", animation.graphs.size() }, { "missing", animation.missing } });
+		if (!animation.missing)
+			continue;
+
+		// Missing files list where they're referenced from, so the graphs can be fixed.
+		missing++;
+		auto& referencedBy = manifestMissing.emplace_back(nlohmann::json{ { "path", path } })["referencedBy"];
+		for (auto graph : animation.graphs) {
+			referencedBy.push_back(results[graph].path.generic_string());
+			if (!quiet)
+				std::fprintf(stderr, "%s: missing animation %s\n", results[graph].path.generic_string().c_str(), path.c_str());
+		}
+	}
+
+	auto& manifestFailed = manifest["failed"] = nlohmann::json::array();
+	for (auto& result : results) {
+		if (!result.error.empty())
+			manifestFailed.push_back({ { "path", result.path.generic_string() }, { "error", result.error } });
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	manifest["summary"] = {
+		{ "graphs", results.size() },
+		{ "failedGraphs", failedGraphs },
+		{ "animations", animations.size() },
+		{ "missing", missing },
+		{ "references", references },
+		{ "ms", ms }
+	};
+	std::fprintf(stderr, "Scanned %zu graphs in %.1f ms: %zu animations referenced %zu times, %zu missing, %zu graphs failed.\n",
+		results.size(), ms, animations.size(), references, missing, failedGraphs);
+
+	auto text = manifest.dump(2, ' ', false, nlohmann::json::error_handler_t::replace);
+	if (outPath.empty()) {
+		std::cout << text << '\n';
+	}
+	else {
+		std::ofstream outFile{ outPath };
+		if (!outFile.is_open()) {
+			std::fprintf(stderr, "Failed to open %s for writing.\n", outPath.generic_string().c_str());
+			return 2;
+		}
+		outFile << text << '\n';
+	}
+
+	return missing || failedGraphs ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+#include "BlendSpaceEditor/GraphHash.h"
+#include "BlendSpaceEditor/Nodes/NodeDefinitions.h"
+#include "Common/BtFiles.h"
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compares two versions of a .bt blend graph by structure rather than text. Every node gets a structural hash
+// (GraphHash) that ignores IDs and positions, so renumbering by a save doesn't show up. Nodes are paired top
+// down from the actor, then by identical sub-trees, then by identical content; pairs whose own content or
+// links differ are reported as changed, and the nodes left over as removed or added.
+
+namespace
+{
+	using GraphHash::kNoNode;
+
+	struct Document
+	{
+		std::filesystem::path path;
+		GraphFile::Graph graph;
+		GraphHash::Hashes hashes;
+		// The node each node is paired with in the other document.
+		std::vector<uint32_t> pairs;
+	};
+
+	bool LoadDocument(const std::filesystem::path& path, Document& document, std::string& error)
+	{
+		std::string text;
+		if (!BtFiles::Read(path, text, &error))
+			return false;
+
+		try {
+			auto obj = nlohmann::json::parse(text);
+			GraphFile::Parse(obj, document.graph);
+		}
+		catch (const std::exception& ex) {
+			error = std::string{ "Failed to load blend graph file. Error: " } + ex.what();
+			return false;
+		}
+
+		document.path = path;
+		document.hashes = GraphHash::Compute(document.graph);
+		document.pairs.assign(document.graph.nodes.size(), kNoNode);
+		return true;
+	}
+
+	std::string FormatValue(const Pin& pin)
+	{
+		char buffer[32];
+		switch (pin.type) {
+		case PinType::CustomFloat:
+			std::snprintf(buffer, sizeof(buffer), "%.9g", std::get<NodeFloatCustomValueConnection>(pin.connected).value);
+			return buffer;
+		case PinType::CustomInt:
+			return std::to_string(std::get<NodeIntCustomValueConnection>(pin.connected).value);
+		case PinType::CustomString:
+			return nlohmann::json(std::get<NodeStringCustomValueConnection>(pin.connected).value).dump();
+		default:
+			return {};
+		}
+	}
+
+	class Differ
+	{
+	public:
+		struct Change
+		{
+			uint32_t before;
+			uint32_t after;
+			std::vector<std::string> details;
+		};
+
+		Differ(Document& before, Document& after) : m_Before(before), m_After(after)
+		{
+		}
+
+		void Run()
+		{
+			PairActors();
+			PairBy(m_Before.hashes.tree, m_After.hashes.tree);
+			PairBy(m_Before.hashes.local, m_After.hashes.local);
+			Classify();
+		}
+
+		size_t m_Unchanged = 0;
+		// Pairs whose own content and links are the same, but something below them changed.
+		size_t m_Affected = 0;
+		std::vector<Change> m_Changed;
+		std::vector<uint32_t> m_Removed;
+		std::vector<uint32_t> m_Added;
+
+	private:
+		const Node& Before(uint32_t node) const { return m_Before.graph.nodes[node]; }
+		const Node& After(uint32_t node) const { return m_After.graph.nodes[node]; }
+
+		// Pairs two nodes, then the sources of their inputs slot by slot, so whole sub-trees pair consistently.
+		void Pair(uint32_t before, uint32_t after)
+		{
+			m_Pending.emplace_back(before, after);
+			m_Before.pairs[before] = after;
+			m_After.pairs[after] = before;
+
+			while (!m_Pending.empty()) {
+				auto [a, b] = m_Pending.front();
+				m_Pending.pop_front();
+
+				auto sourcesA = m_Before.hashes.GetSources(a);
+				auto sourcesB = m_After.hashes.GetSources(b);
+				for (size_t slot = 0; slot < sourcesA.size() && slot < sourcesB.size(); slot++) {
+					auto sourceA = sourcesA[slot].node;
+					auto sourceB = sourcesB[slot].node;
+					if (sourceA == kNoNode || sourceB == kNoNode || m_Before.pairs[sourceA] != kNoNode || m_After.pairs[sourceB] != kNoNode)
+						continue;
+					if (Before(sourceA).def != After(sourceB).def)
+						continue;
+
+					m_Before.pairs[sourceA] = sourceB;
+					m_After.pairs[sourceB] = sourceA;
+					m_Pending.emplace_back(sourceA, sourceB);
+				}
+			}
+		}
+
+		void PairActors()
+		{
+			std::vector<uint32_t> actorsB;
+			for (uint32_t i = 0; i < m_After.graph.nodes.size(); i++) {
+				if (After(i).def->typeName == "actor")
+					actorsB.push_back(i);
+			}
+
+			size_t nextB = 0;
+			for (uint32_t i = 0; i < m_Before.graph.nodes.size() && nextB < actorsB.size(); i++) {
+				if (Before(i).def->typeName == "actor")
+					Pair(i, actorsB[nextB++]);
+			}
+		}
+
+		// Pairs the remaining nodes that have equal hashes, consumers first so that each pair's sub-tree pairs
+		// along with it.
+		void PairBy(const std::vector<uint64_t>& hashesBefore, const std::vector<uint64_t>& hashesAfter)
+		{
+			std::unordered_map<uint64_t, std::vector<uint32_t>> unpairedAfter;
+			auto& orderAfter = m_After.hashes.order;
+			for (auto iter = orderAfter.rbegin(); iter != orderAfter.rend(); ++iter) {
+				if (m_After.pairs[*iter] == kNoNode)
+					unpairedAfter[hashesAfter[*iter]].push_back(*iter);
+			}
+			// Candidates are taken from the front of each list.
+			for (auto& [hash, nodes] : unpairedAfter)
+				std::reverse(nodes.begin(), nodes.end());
+
+			auto& orderBefore = m_Before.hashes.order;
+			for (auto iter = orderBefore.rbegin(); iter != orderBefore.rend(); ++iter) {
+				auto node = *iter;
+				if (m_Before.pairs[node] != kNoNode)
+					continue;
+
+				auto candidates = unpairedAfter.find(hashesBefore[node]);
+				if (candidates == unpairedAfter.end())
+					continue;
+
+				auto& nodes = candidates->second;
+				while (!nodes.empty() && m_After.pairs[nodes.back()] != kNoNode)
+					nodes.pop_back();
+				if (nodes.empty())
+					continue;
+
+				auto match = nodes.back();
+				nodes.pop_back();
+				if (Before(node).def == After(match).def)
+					Pair(node, match);
+			}
+		}
+
+		void Classify()
+		{
+			for (uint32_t a = 0; a < m_Before.graph.nodes.size(); a++) {
+				auto b = m_Before.pairs[a];
+				if (b == kNoNode) {
+					m_Removed.push_back(a);
+					continue;
+				}
+				if (m_Before.hashes.tree[a] == m_After.hashes.tree[b]) {
+					m_Unchanged++;
+					continue;
+				}
+
+				Change change{ a, b };
+				auto& nodeA = Before(a);
+				auto& nodeB = After(b);
+				auto sourcesA = m_Before.hashes.GetSources(a);
+				auto sourcesB = m_After.hashes.GetSources(b);
+				for (size_t slot = 0; slot < nodeA.inputs.size(); slot++) {
+					auto& pin = *nodeA.inputs[slot].def;
+					std::string name{ pin.typeName };
+					if (pin.type >= PinType::CustomStart) {
+						auto valueA = FormatValue(nodeA.inputs[slot]);
+						auto valueB = FormatValue(nodeB.inputs[slot]);
+						if (valueA != valueB)
+							change.details.push_back("'" + name + "' " + valueA + " -> " + valueB);
+						continue;
+					}
+
+					auto& sourceA = sourcesA[slot];
+					auto& sourceB = sourcesB[slot];
+					if (sourceA.node == kNoNode && sourceB.node == kNoNode)
+						continue;
+					if (sourceA.node == kNoNode)
+						change.details.push_back("'" + name + "' linked");
+					else if (sourceB.node == kNoNode)
+						change.details.push_back("'" + name + "' unlinked");
+					else if (m_Before.pairs[sourceA.node] != sourceB.node || sourceA.output != sourceB.output)
+						change.details.push_back("'" + name + "' relinked");
+				}
+
+				if (change.details.empty())
+					m_Affected++;
+				else
+					m_Changed.push_back(std::move(change));
+			}
+
+			for (uint32_t b = 0; b < m_After.graph.nodes.size(); b++) {
+				if (m_After.pairs[b] == kNoNode)
+					m_Added.push_back(b);
+			}
+		}
+
+		Document& m_Before;
+		Document& m_After;
+		std::deque<std::pair<uint32_t, uint32_t>> m_Pending;
+	};
+
+	std::string Describe(const Node& node)
+	{
+		return std::string{ node.def->name } + " #" + std::to_string(node.id.Get());
+	}
+
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: bt-diff [options] BEFORE.bt AFTER.bt\n"
+			"  --json PATH   Also write the differences as JSON to PATH\n"
+			"Exits with 0 if the graphs are the same, 1 if they differ, 2 if either can't be loaded.\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::filesystem::path> paths;
+	std::filesystem::path jsonPath;
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		if (arg == "--json" && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if (!arg.starts_with("-") && paths.size() < 2)
+			paths.emplace_back(arg);
+		else {
+			PrintUsage();
+			return arg == "--help" ? 0 : 2;
+		}
+	}
+
+	if (paths.size() != 2) {
+		PrintUsage();
+		return 2;
+	}
+
+	Document before, after;
+	std::string error;
+	for (auto [document, path] : { std::pair{ &before, &paths[0] }, std::pair{ &after, &paths[1] } }) {
+		if (!LoadDocument(*path, *document, error)) {
+			std::fprintf(stderr, "%s: %s\n", path->generic_string().c_str(), error.c_str());
+			return 2;
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	Differ differ{ before, after };
+	differ.Run();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("--- %s\n+++ %s\n", before.path.generic_string().c_str(), after.path.generic_string().c_str());
+	for (auto node : differ.m_Removed)
+		std::printf("- %s\n", Describe(before.graph.nodes[node]).c_str());
+	for (auto node : differ.m_Added)
+		std::printf("+ %s\n", Describe(after.graph.nodes[node]).c_str());
+	for (auto& change : differ.m_Changed) {
+		std::string details;
+		for (auto& detail : change.details)
+			details += (details.empty() ? "" : ", ") + detail;
+		std::printf("~ %s -> #%zu: %s\n", Describe(before.graph.nodes[change.before]).c_str(), static_cast<size_t>(after.graph.nodes[change.after].id.Get()), details.c_str());
+	}
+	std::printf("%zu unchanged, %zu changed below, %zu changed, %zu removed, %zu added, compared in %.1f ms.\n",
+		differ.m_Unchanged, differ.m_Affected, differ.m_Changed.size(), differ.m_Removed.size(), differ.m_Added.size(), ms);
+
+	if (!jsonPath.empty()) {
+		nlohmann::json report;
+		report["before"] = before.path.generic_string();
+		report["after"] = after.path.generic_string();
+		report["summary"] = {
+			{ "unchanged", differ.m_Unchanged },
+			{ "changedBelow", differ.m_Affected },
+			{ "changed", differ.m_Changed.size() },
+			{ "removed", differ.m_Removed.size() },
+			{ "added", differ.m_Added.size() }
+		};
+
+		const auto describe = [](const Node& node) {
+			return nlohmann::json{ { "id", node.id.Get() }, { "type", node.def->typeName } };
+		};
+		auto& removed = report["removed"] = nlohmann::json::array();
+		for (auto node : differ.m_Removed)
+			removed.push_back(describe(before.graph.nodes[node]));
+		auto& added = report["added"] = nlohmann::json::array();
+		for (auto node : differ.m_Added)
+			added.push_back(describe(after.graph.nodes[node]));
+		auto& changed = report["changed"] = nlohmann::json::array();
+		for (auto& change : differ.m_Changed) {
+			auto& entry = changed.emplace_back(describe(before.graph.nodes[change.before]));
+			entry["afterId"] = after.graph.nodes[change.after].id.Get();
+			entry["details"] = change.details;
+		}
+
+		std::ofstream outFile{ jsonPath };
+		if (!outFile.is_open()) {
+			std::fprintf(stderr, "Failed to open %s for writing.\n", jsonPath.generic_string().c_str());
+			return 2;
+		}
+		outFile << report.dump(2, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+	}
+
+	bool same = differ.m_Changed.empty() && differ.m_Removed.empty() && differ.m_Added.empty() && differ.m_Affected == 0;
+	return same ? 0 : 1;
+}
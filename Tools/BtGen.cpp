@@ -0,0 +1,74 @@
+#include "Common/BtFiles.h"
+#include "Common/SyntheticGraph.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Writes a synthetic, valid .bt blend graph. The same options and seed always produce the same file.
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: bt-gen [options] [-o PATH]\n"
+			"  --nodes N       Node count, including the actor (default 1000)\n"
+			"  --shape S       chain, tree or wide (default tree)\n"
+			"  --fan-in N      Maximum linked inputs per node, 0 for no limit (default 0)\n"
+			"  --depth N       Maximum link depth, 0 for no limit (default 0)\n"
+			"  --mix SPEC      Node type weights, e.g. anim=4,blend_1d=2,fixed_val=1 (default uniform)\n"
+			"  --seed N        Random seed (default 1)\n"
+			"  -o PATH         Output file (default stdout)\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	SyntheticGraph::Options options;
+	std::string outPath;
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		if (arg == "--nodes" && hasValue)
+			valid = BtFiles::ParseNumberOption(arg, argv[++i], options.nodeCount);
+		else if (arg == "--shape" && hasValue)
+			valid = SyntheticGraph::ParseShape(argv[++i], options.shape);
+		else if (arg == "--fan-in" && hasValue)
+			valid = BtFiles::ParseNumberOption(arg, argv[++i], options.fanIn);
+		else if (arg == "--depth" && hasValue)
+			valid = BtFiles::ParseNumberOption(arg, argv[++i], options.maxDepth);
+		else if (arg == "--mix" && hasValue) {
+			valid = SyntheticGraph::ParseTypeWeights(argv[++i], options.typeWeights);
+			if (!valid)
+				std::fprintf(stderr, "--mix takes TYPE=WEIGHT pairs of node types other than actor and finite weights, at least one above zero, not \"%s\".\n", argv[i]);
+		}
+		else if (arg == "--seed" && hasValue)
+			valid = BtFiles::ParseNumberOption(arg, argv[++i], options.seed);
+		else if (arg == "-o" && hasValue)
+			outPath = argv[++i];
+		else
+			valid = false;
+
+		if (!valid) {
+			PrintUsage();
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+
+	auto text = SyntheticGraph::Generate(options).dump();
+	if (outPath.empty()) {
+		std::cout << text;
+		return 0;
+	}
+
+	std::ofstream outFile{ outPath };
+	if (!outFile.is_open()) {
+		std::fprintf(stderr, "Failed to open %s for writing.\n", outPath.c_str());
+		return 1;
+	}
+	outFile << text;
+	return 0;
+}
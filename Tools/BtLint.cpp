@@ -0,0 +1,215 @@
+#include "BlendSpaceEditor/ThreadPool.h"
+#include "Common/BtFiles.h"
+#include "Common/ContentCache.h"
+#include "Common/GraphLint.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Checks .bt blend graphs in bulk, several files at once, and reports what it finds as JSON. Files whose
+// contents have been checked before by a run with the same --cache directory are not checked again.
+
+namespace
+{
+	// Bump whenever the checks change, so results cached by an older bt-lint aren't reused.
+	constexpr uint32_t kCacheVersion = 2;
+
+	struct FileResult
+	{
+		std::filesystem::path path;
+		bool cached = false;
+		std::vector<GraphLint::Diagnostic> diagnostics;
+	};
+
+	std::string SerializeDiagnostics(const std::vector<GraphLint::Diagnostic>& diagnostics)
+	{
+		auto obj = nlohmann::json::array();
+		for (auto& diagnostic : diagnostics)
+			obj.push_back(GraphLint::ToJson(diagnostic));
+		return obj.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+	}
+
+	bool DeserializeDiagnostics(std::string_view text, std::vector<GraphLint::Diagnostic>& diagnostics)
+	{
+		auto obj = nlohmann::json::parse(text, nullptr, false);
+		if (!obj.is_array())
+			return false;
+
+		diagnostics.resize(obj.size());
+		for (size_t i = 0; i < obj.size(); i++) {
+			if (!GraphLint::FromJson(obj[i], diagnostics[i]))
+				return false;
+		}
+		return true;
+	}
+
+	void PrintDiagnostic(const FileResult& result, const GraphLint::Diagnostic& diagnostic)
+	{
+		std::string location;
+		if (diagnostic.nodeId >= 0)
+			location += " node " + std::to_string(diagnostic.nodeId);
+		if (!diagnostic.pin.empty())
+			location += " pin '" + diagnostic.pin + "'";
+		std::fprintf(stderr, "%s: %s [%s]%s: %s\n", result.path.generic_string().c_str(), GraphLint::GetSeverityName(diagnostic.severity),
+			diagnostic.code.c_str(), location.c_str(), diagnostic.message.c_str());
+	}
+
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: bt-lint [options] PATH...\n"
+			"  PATH          A .bt file, or a directory to search for them\n"
+			"  -o PATH       Write the JSON report to PATH (default stdout)\n"
+			"  --cache DIR   Keep results in DIR, and reuse them for files checked before; may be shared\n"
+			"  --threads N   Maximum files checked at once, 0 for one per hardware thread (default 0)\n"
+			"  --werror      Treat warnings as errors\n"
+			"  --quiet       Only print the summary to stderr, not each problem\n"
+			"Exits with 0 if no errors were found, 1 if some were, 2 if the files couldn't be listed.\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::filesystem::path> roots;
+	std::filesystem::path outPath;
+	std::filesystem::path cachePath;
+	unsigned threads = 0;
+	bool warningsAreErrors = false;
+	bool quiet = false;
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "-o" && hasValue)
+			outPath = argv[++i];
+		else if (arg == "--cache" && hasValue)
+			cachePath = argv[++i];
+		else if (arg == "--threads" && hasValue) {
+			if (!BtFiles::ParseThreadCount(argv[++i], threads)) {
+				std::fprintf(stderr, "--threads takes a number, not \"%s\".\n", argv[i]);
+				PrintUsage();
+				return 2;
+			}
+		}
+		else if (arg == "--werror")
+			warningsAreErrors = true;
+		else if (arg == "--quiet")
+			quiet = true;
+		else if (!arg.starts_with("-"))
+			roots.emplace_back(arg);
+		else {
+			PrintUsage();
+			return arg == "--help" ? 0 : 2;
+		}
+	}
+
+	if (roots.empty()) {
+		PrintUsage();
+		return 2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::filesystem::path> files;
+	std::string error;
+	if (!BtFiles::Collect(roots, files, &error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 2;
+	}
+
+	std::unique_ptr<ContentCache> cache;
+	if (!cachePath.empty())
+		cache = std::make_unique<ContentCache>(cachePath, "bt-lint", kCacheVersion);
+
+	// Each file is checked on one thread; files are spread over the pool.
+	std::vector<FileResult> results(files.size());
+	ThreadPool::Get().ParallelFor(files.size(), 1, [&](size_t begin, size_t end) {
+		std::string text, cached;
+		for (size_t i = begin; i < end; i++) {
+			auto& result = results[i];
+			result.path = files[i];
+			std::string readError;
+			if (!BtFiles::Read(files[i], text, &readError)) {
+				result.diagnostics.push_back({ GraphLint::Severity::Error, "unreadable", readError });
+				continue;
+			}
+
+			if (!cache) {
+				result.diagnostics = GraphLint::CheckText(text);
+				continue;
+			}
+
+			auto key = cache->GetKey(text);
+			if (cache->Find(key, cached) && DeserializeDiagnostics(cached, result.diagnostics)) {
+				result.cached = true;
+				continue;
+			}
+			result.diagnostics = GraphLint::CheckText(text);
+			cache->Store(key, SerializeDiagnostics(result.diagnostics));
+		}
+	}, threads);
+
+	if (cache && cache->GetStats().storeFailures)
+		std::fprintf(stderr, "Failed to store %zu results in %s.\n", cache->GetStats().storeFailures, cachePath.generic_string().c_str());
+
+	size_t errors = 0, warnings = 0, cached = 0, failedFiles = 0;
+	nlohmann::json report;
+	report["tool"] = "bt-lint";
+	auto& reportFiles = report["files"];
+	reportFiles = nlohmann::json::array();
+	for (auto& result : results) {
+		size_t fileErrors = 0, fileWarnings = 0;
+		for (auto& diagnostic : result.diagnostics) {
+			bool isError = diagnostic.severity == GraphLint::Severity::Error || warningsAreErrors;
+			(isError ? fileErrors : fileWarnings)++;
+			if (!quiet)
+				PrintDiagnostic(result, diagnostic);
+		}
+		errors += fileErrors;
+		warnings += fileWarnings;
+		cached += result.cached ? 1 : 0;
+		failedFiles += fileErrors ? 1 : 0;
+		if (result.diagnostics.empty())
+			continue;
+
+		// Clean files are only counted, which keeps the report of a large, mostly clean tree small.
+		auto& entry = reportFiles.emplace_back();
+		entry["path"] = result.path.generic_string();
+		entry["cached"] = result.cached;
+		entry["errors"] = fileErrors;
+		entry["warnings"] = fileWarnings;
+		auto& diagnostics = entry["diagnostics"];
+		for (auto& diagnostic : result.diagnostics)
+			diagnostics.push_back(GraphLint::ToJson(diagnostic));
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	report["summary"] = {
+		{ "files", results.size() },
+		{ "cached", cached },
+		{ "failedFiles", failedFiles },
+		{ "errors", errors },
+		{ "warnings", warnings },
+		{ "ms", ms }
+	};
+	std::fprintf(stderr, "Checked %zu files (%zu unchanged) in %.1f ms: %zu errors and %zu warnings, %zu files failed.\n",
+		results.size(), cached, ms, errors, warnings, failedFiles);
+
+	auto text = report.dump(2, ' ', false, nlohmann::json::error_handler_t::replace);
+	if (outPath.empty()) {
+		std::cout << text << '\n';
+	}
+	else {
+		std::ofstream outFile{ outPath };
+		if (!outFile.is_open()) {
+			std::fprintf(stderr, "Failed to open %s for writing.\n", outPath.generic_string().c_str());
+			return 2;
+		}
+		outFile << text << '\n';
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,293 @@
+#include "BlendSpaceEditor/FileUtil.h"
+#include "BlendSpaceEditor/Nodes/NodeDefinitions.h"
+#include "BlendSpaceEditor/ThreadPool.h"
+#include "Common/BtFiles.h"
+#include "Common/BtScan.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Renames custom string values, such as animation files and bone names, across many .bt blend graphs. The
+// rename map is a JSON object keyed by node type and pin type name:
+//
+//   { "anim.file": { "Anims/old.glb": "Anims/new.glb" }, "ik_2b_adj.start_node": { "bone_1": "spine_1" } }
+//
+// Only the strings being renamed are replaced in the text; every other byte of a file stays as it was, and
+// changed files are replaced atomically. Each value is renamed at most once, so a map from a to b and b to c
+// turns a into b, not c. With --dry-run nothing is written, and the report says what would change.
+
+namespace
+{
+	// Value renames by node type name, then pin type name, then old value.
+	using RenameMap = std::unordered_map<std::string, std::unordered_map<std::string, std::unordered_map<std::string, std::string>>>;
+
+	struct Change
+	{
+		int64_t nodeId;
+		std::string key;
+		std::string from;
+		std::string to;
+	};
+
+	struct FileResult
+	{
+		std::filesystem::path path;
+		// Empty when the file was read, and written if it changed.
+		std::string error;
+		std::vector<Change> changes;
+	};
+
+	bool LoadRenameMap(const std::filesystem::path& path, RenameMap& renames, std::string& error)
+	{
+		std::string text;
+		if (!BtFiles::Read(path, text, &error))
+			return false;
+
+		auto obj = nlohmann::json::parse(text, nullptr, false);
+		if (!obj.is_object()) {
+			error = "The rename map must be a JSON object.";
+			return false;
+		}
+
+		for (auto& [key, values] : obj.items()) {
+			// Keys name a custom string input of a known node type, so a typo can't silently match nothing.
+			auto dot = key.find('.');
+			auto def = dot != std::string::npos ? NodeDefinitions::FindDef(std::string_view{ key }.substr(0, dot)) : nullptr;
+			if (!def) {
+				error = "Unknown node type in \"" + key + "\"; keys are written as type.pin, like anim.file.";
+				return false;
+			}
+			auto pinName = std::string_view{ key }.substr(dot + 1);
+			auto pin = std::find_if(def->inputs.begin(), def->inputs.end(), [&](const auto& pin) { return pin.typeName == pinName; });
+			if (pin == def->inputs.end() || pin->type != PinType::CustomString) {
+				error = "\"" + key + "\" doesn't name a string value of " + std::string{ def->name } + ".";
+				return false;
+			}
+			if (!values.is_object()) {
+				error = "The renames for \"" + key + "\" must be a JSON object.";
+				return false;
+			}
+
+			auto& pinRenames = renames[std::string{ def->typeName }][std::string{ pinName }];
+			for (auto& [from, to] : values.items()) {
+				if (!to.is_string()) {
+					error = "The new value for \"" + from + "\" in \"" + key + "\" must be a string.";
+					return false;
+				}
+				pinRenames[from] = to.get<std::string>();
+			}
+		}
+		return true;
+	}
+
+	// Finds the values to rename in text and, if there are any, writes the renamed text to newText.
+	bool Rewrite(std::string_view text, const RenameMap& renames, FileResult& result, std::string& newText)
+	{
+		struct Edit
+		{
+			size_t offset;
+			size_t length;
+			std::string replacement;
+		};
+
+		std::vector<Edit> edits;
+		bool scanned = BtScan::ForEachNode(text, [&](const BtScan::Node& node) {
+			auto type = renames.find(node.type);
+			if (type == renames.end())
+				return;
+
+			for (auto& value : node.values) {
+				auto pin = type->second.find(value.pin);
+				if (pin == type->second.end())
+					continue;
+				auto rename = pin->second.find(value.value);
+				if (rename == pin->second.end() || rename->second == value.value)
+					continue;
+
+				// Written the way saving escapes strings.
+				edits.push_back({ value.offset, value.length, nlohmann::json(rename->second).dump() });
+				result.changes.push_back({ node.id, node.type + '.' + value.pin, value.value, rename->second });
+			}
+		}, &result.error);
+
+		// A file that can't be read whole is left alone rather than half renamed.
+		if (!scanned) {
+			result.changes.clear();
+			return false;
+		}
+		if (edits.empty())
+			return true;
+
+		// Edits come in file order, so the text between them is copied through in one pass.
+		newText.clear();
+		size_t copied = 0;
+		for (auto& edit : edits) {
+			newText.append(text.substr(copied, edit.offset - copied));
+			newText.append(edit.replacement);
+			copied = edit.offset + edit.length;
+		}
+		newText.append(text.substr(copied));
+		return true;
+	}
+
+	void PrintUsage()
+	{
+		std::printf(
+			"Usage: bt-rewrite [options] --map MAP.json PATH...\n"
+			"  PATH          A .bt file, or a directory to search for them\n"
+			"  --map PATH    JSON renames keyed by type.pin, e.g. {\"anim.file\": {\"old.glb\": \"new.glb\"}}\n"
+			"  --dry-run     Report what would change without writing anything\n"
+			"  -o PATH       Write the JSON change report to PATH (default stdout)\n"
+			"  --threads N   Maximum files rewritten at once, 0 for one per hardware thread (default 0)\n"
+			"  --quiet       Only print the summary to stderr, not each change\n"
+			"Exits with 0 if every file was handled, 1 if some couldn't be read or written, 2 on bad arguments.\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::filesystem::path> roots;
+	std::filesystem::path mapPath;
+	std::filesystem::path outPath;
+	unsigned threads = 0;
+	bool dryRun = false;
+	bool quiet = false;
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--map" && hasValue)
+			mapPath = argv[++i];
+		else if (arg == "-o" && hasValue)
+			outPath = argv[++i];
+		else if (arg == "--threads" && hasValue) {
+			if (!BtFiles::ParseThreadCount(argv[++i], threads)) {
+				std::fprintf(stderr, "--threads takes a number, not \"%s\".\n", argv[i]);
+				PrintUsage();
+				return 2;
+			}
+		}
+		else if (arg == "--dry-run")
+			dryRun = true;
+		else if (arg == "--quiet")
+			quiet = true;
+		else if (!arg.starts_with("-"))
+			roots.emplace_back(arg);
+		else {
+			PrintUsage();
+			return arg == "--help" ? 0 : 2;
+		}
+	}
+
+	if (roots.empty() || mapPath.empty()) {
+		PrintUsage();
+		return 2;
+	}
+
+	RenameMap renames;
+	std::string error;
+	if (!LoadRenameMap(mapPath, renames, error)) {
+		std::fprintf(stderr, "%s: %s\n", mapPath.generic_string().c_str(), error.c_str());
+		return 2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::filesystem::path> files;
+	if (!BtFiles::Collect(roots, files, &error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 2;
+	}
+
+	std::vector<FileResult> results(files.size());
+	ThreadPool::Get().ParallelFor(files.size(), 1, [&](size_t begin, size_t end) {
+		std::string text, newText;
+		for (size_t i = begin; i < end; i++) {
+			auto& result = results[i];
+			result.path = files[i];
+			if (!BtFiles::Read(files[i], text, &result.error) || !Rewrite(text, renames, result, newText))
+				continue;
+			if (!dryRun && !result.changes.empty() && !FileUtil_WriteAtomic(files[i], newText, &result.error))
+				result.error = "Failed to write file. " + result.error;
+		}
+	}, threads);
+
+	size_t changes = 0, changedFiles = 0, failedFiles = 0;
+	std::set<std::pair<std::string, std::string>> used;
+	nlohmann::json report;
+	report["tool"] = "bt-rewrite";
+	report["dryRun"] = dryRun;
+	auto& reportFiles = report["files"] = nlohmann::json::array();
+	auto& reportFailed = report["failed"] = nlohmann::json::array();
+	for (auto& result : results) {
+		auto path = result.path.generic_string();
+		if (!result.error.empty()) {
+			failedFiles++;
+			reportFailed.push_back({ { "path", path }, { "error", result.error } });
+			if (!quiet)
+				std::fprintf(stderr, "%s: %s\n", path.c_str(), result.error.c_str());
+		}
+		if (result.changes.empty())
+			continue;
+
+		changedFiles++;
+		changes += result.changes.size();
+		auto& entry = reportFiles.emplace_back(nlohmann::json{ { "path", path }, { "written", !dryRun && result.error.empty() } });
+		auto& entryChanges = entry["changes"];
+		for (auto& change : result.changes) {
+			used.emplace(change.key, change.from);
+			entryChanges.push_back({ { "node", change.nodeId }, { "key", change.key }, { "from", change.from }, { "to", change.to } });
+			if (!quiet) {
+				std::fprintf(stderr, "%s: node %lld %s %s -> %s\n", path.c_str(), static_cast<long long>(change.nodeId), change.key.c_str(),
+					nlohmann::json(change.from).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace).c_str(), nlohmann::json(change.to).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace).c_str());
+			}
+		}
+	}
+
+	// Renames that matched nothing are often typos, or files that were already renamed.
+	std::set<std::pair<std::string, std::string>> unusedRenames;
+	for (auto& [type, pins] : renames) {
+		for (auto& [pin, values] : pins) {
+			auto key = type + '.' + pin;
+			for (auto& [from, to] : values) {
+				if (!used.contains({ key, from }))
+					unusedRenames.emplace(key, from);
+			}
+		}
+	}
+	auto& unused = report["unused"] = nlohmann::json::array();
+	for (auto& [key, from] : unusedRenames)
+		unused.push_back({ { "key", key }, { "from", from } });
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	report["summary"] = {
+		{ "files", results.size() },
+		{ "changedFiles", changedFiles },
+		{ "changes", changes },
+		{ "failedFiles", failedFiles },
+		{ "unusedRenames", unused.size() },
+		{ "ms", ms }
+	};
+	std::fprintf(stderr, "%s %zu values in %zu of %zu files in %.1f ms, %zu files failed, %zu renames unused.\n",
+		dryRun ? "Would rename" : "Renamed", changes, changedFiles, results.size(), ms, failedFiles, unused.size());
+
+	auto text = report.dump(2, ' ', false, nlohmann::json::error_handler_t::replace);
+	if (outPath.empty()) {
+		std::cout << text << '\n';
+	}
+	else {
+		std::ofstream outFile{ outPath };
+		if (!outFile.is_open()) {
+			std::fprintf(stderr, "Failed to open %s for writing.\n", outPath.generic_string().c_str());
+			return 2;
+		}
+		outFile << text << '\n';
+	}
+
+	return failedFiles ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#include "BtFiles.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <system_error>
+
+namespace BtFiles
+{
+	bool Collect(const std::vector<std::filesystem::path>& roots, std::vector<std::filesystem::path>& files, std::string* error)
+	{
+		namespace fs = std::filesystem;
+		const auto fail = [error](const std::string& reason) {
+			if (error)
+				*error = reason;
+			return false;
+		};
+
+		for (auto& root : roots) {
+			std::error_code ec;
+			if (fs::is_regular_file(root, ec)) {
+				files.push_back(root.lexically_normal());
+				continue;
+			}
+			if (!fs::is_directory(root, ec))
+				return fail("No such file or directory: " + root.generic_string());
+
+			fs::recursive_directory_iterator iter{ root, fs::directory_options::skip_permission_denied, ec };
+			for (; !ec && iter != fs::recursive_directory_iterator{}; iter.increment(ec)) {
+				if (iter->path().extension() == ".bt" && iter->is_regular_file(ec))
+					files.push_back(iter->path().lexically_normal());
+			}
+			if (ec)
+				return fail("Failed to list " + root.generic_string() + ": " + ec.message());
+		}
+
+		std::sort(files.begin(), files.end());
+		files.erase(std::unique(files.begin(), files.end()), files.end());
+		return true;
+	}
+
+	bool Read(const std::filesystem::path& path, std::string& text, std::string* error)
+	{
+		std::ifstream inFile{ path, std::ios::binary };
+		if (!inFile.is_open()) {
+			if (error)
+				*error = "Failed to open file.";
+			return false;
+		}
+
+		inFile.seekg(0, std::ios::end);
+		text.resize(static_cast<size_t>(std::max<std::streamoff>(inFile.tellg(), 0)));
+		inFile.seekg(0, std::ios::beg);
+		inFile.read(text.data(), static_cast<std::streamsize>(text.size()));
+		text.resize(static_cast<size_t>(inFile.gcount()));
+		if (inFile.bad()) {
+			if (error)
+				*error = "Failed to read file.";
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseThreadCount(std::string_view text, unsigned& threads)
+	{
+		return ParseNumber(text, threads);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Finding and reading .bt files, and parsing the options they share, for the batch tools.
+namespace BtFiles
+{
+	// Expands each root into the .bt files below it if it's a directory, or itself if it's a file, and returns
+	// them sorted with duplicates removed. On a root that doesn't exist or can't be listed, returns false with
+	// the reason in error.
+	bool Collect(const std::vector<std::filesystem::path>& roots, std::vector<std::filesystem::path>& files, std::string* error = nullptr);
+	// Reads the whole file into text, as AsyncGraphLoad does.
+	bool Read(const std::filesystem::path& path, std::string& text, std::string* error = nullptr);
+	// Parses the value of --threads, which must be a whole decimal number and nothing else.
+	bool ParseThreadCount(std::string_view text, unsigned& threads);
+
+	// Parses the value of a numeric option, which must be a whole decimal number in range and nothing else.
+	template<typename T>
+	bool ParseNumber(std::string_view text, T& value)
+	{
+		auto end = text.data() + text.size();
+		auto [parsed, ec] = std::from_chars(text.data(), end, value);
+		return ec == std::errc{} && parsed == end;
+	}
+
+	// ParseNumber for the value of option, saying what's wrong with it on stderr if it isn't a number.
+	template<typename T>
+	bool ParseNumberOption(std::string_view option, std::string_view text, T& value)
+	{
+		if (ParseNumber(text, value))
+			return true;
+		std::fprintf(stderr, "%.*s takes a number, not \"%.*s\".\n", static_cast<int>(option.size()), option.data(), static_cast<int>(text.size()), text.data());
+		return false;
+	}
+}
@@ -0,0 +1,386 @@
+#include "BtScan.h"
+#include <vector>
+
+namespace BtScan
+{
+	namespace
+	{
+		// Deeper nesting than any graph has; keeps malformed input from exhausting the stack.
+		constexpr int kMaxDepth = 256;
+
+		class Scanner
+		{
+		public:
+			Scanner(std::string_view text, const std::function<void(const Node&)>& onNode) :
+				m_Text(text), m_OnNode(onNode)
+			{
+			}
+
+			bool Run(std::string* error)
+			{
+				bool ok = ScanDocument();
+				if (!ok && error)
+					*error = m_Error + " at offset " + std::to_string(m_Pos) + ".";
+				return ok;
+			}
+
+		private:
+			bool Fail(const char* reason)
+			{
+				m_Error = reason;
+				return false;
+			}
+
+			void SkipSpace()
+			{
+				while (m_Pos < m_Text.size()) {
+					char c = m_Text[m_Pos];
+					if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+						break;
+					m_Pos++;
+				}
+			}
+
+			// Skips whitespace and consumes c if it's next.
+			bool Consume(char c)
+			{
+				SkipSpace();
+				if (m_Pos < m_Text.size() && m_Text[m_Pos] == c) {
+					m_Pos++;
+					return true;
+				}
+				return false;
+			}
+
+			bool PeekIs(char c)
+			{
+				SkipSpace();
+				return m_Pos < m_Text.size() && m_Text[m_Pos] == c;
+			}
+
+			static int HexDigit(char c)
+			{
+				if (c >= '0' && c <= '9')
+					return c - '0';
+				if (c >= 'a' && c <= 'f')
+					return c - 'a' + 10;
+				if (c >= 'A' && c <= 'F')
+					return c - 'A' + 10;
+				return -1;
+			}
+
+			bool ReadHex4(uint32_t& code)
+			{
+				if (m_Text.size() - m_Pos < 4)
+					return Fail("Truncated \\u escape");
+				code = 0;
+				for (int i = 0; i < 4; i++) {
+					int digit = HexDigit(m_Text[m_Pos++]);
+					if (digit < 0)
+						return Fail("Invalid \\u escape");
+					code = code * 16 + static_cast<uint32_t>(digit);
+				}
+				return true;
+			}
+
+			static void AppendUtf8(std::string& out, uint32_t code)
+			{
+				if (code < 0x80) {
+					out += static_cast<char>(code);
+				}
+				else if (code < 0x800) {
+					out += static_cast<char>(0xC0 | (code >> 6));
+					out += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else if (code < 0x10000) {
+					out += static_cast<char>(0xE0 | (code >> 12));
+					out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					out += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else {
+					out += static_cast<char>(0xF0 | (code >> 18));
+					out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+					out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					out += static_cast<char>(0x80 | (code & 0x3F));
+				}
+			}
+
+			// Reads the string at the current position into out, unescaped. With out null, only skips it.
+			bool ReadString(std::string* out)
+			{
+				if (!Consume('"'))
+					return Fail("Expected a string");
+				if (out)
+					out->clear();
+
+				while (true) {
+					// Copy the run up to the next quote or escape in one go.
+					size_t runStart = m_Pos;
+					while (m_Pos < m_Text.size() && m_Text[m_Pos] != '"' && m_Text[m_Pos] != '\\') {
+						if (static_cast<unsigned char>(m_Text[m_Pos]) < 0x20)
+							return Fail("Control character in string");
+						m_Pos++;
+					}
+					if (out)
+						out->append(m_Text.substr(runStart, m_Pos - runStart));
+					if (m_Pos >= m_Text.size())
+						return Fail("Unterminated string");
+					if (m_Text[m_Pos++] == '"')
+						return true;
+
+					if (m_Pos >= m_Text.size())
+						return Fail("Unterminated string");
+					char escape = m_Text[m_Pos++];
+					char plain = 0;
+					switch (escape) {
+					case '"': plain = '"'; break;
+					case '\\': plain = '\\'; break;
+					case '/': plain = '/'; break;
+					case 'b': plain = '\b'; break;
+					case 'f': plain = '\f'; break;
+					case 'n': plain = '\n'; break;
+					case 'r': plain = '\r'; break;
+					case 't': plain = '\t'; break;
+					case 'u': {
+						uint32_t code;
+						if (!ReadHex4(code))
+							return false;
+						if (code >= 0xD800 && code <= 0xDBFF) {
+							uint32_t low;
+							if (m_Text.substr(m_Pos, 2) != "\\u")
+								return Fail("Unpaired surrogate in \\u escape");
+							m_Pos += 2;
+							if (!ReadHex4(low))
+								return false;
+							if (low < 0xDC00 || low > 0xDFFF)
+								return Fail("Unpaired surrogate in \\u escape");
+							code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+						}
+						else if (code >= 0xDC00 && code <= 0xDFFF) {
+							return Fail("Unpaired surrogate in \\u escape");
+						}
+						if (out)
+							AppendUtf8(*out, code);
+						continue;
+					}
+					default:
+						return Fail("Invalid escape in string");
+					}
+					if (out)
+						*out += plain;
+				}
+			}
+
+			bool ReadLiteral(std::string_view literal)
+			{
+				if (m_Text.substr(m_Pos, literal.size()) != literal)
+					return Fail("Invalid value");
+				m_Pos += literal.size();
+				return true;
+			}
+
+			// Reads a number, storing it in integer if it's one that fits.
+			bool ReadNumber(int64_t* integer)
+			{
+				size_t start = m_Pos;
+				bool isInteger = true;
+				if (m_Pos < m_Text.size() && m_Text[m_Pos] == '-')
+					m_Pos++;
+				size_t digitsStart = m_Pos;
+				while (m_Pos < m_Text.size() && m_Text[m_Pos] >= '0' && m_Text[m_Pos] <= '9')
+					m_Pos++;
+				if (m_Pos == digitsStart)
+					return Fail("Invalid value");
+
+				while (m_Pos < m_Text.size()) {
+					char c = m_Text[m_Pos];
+					if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+						isInteger = false;
+					else if (c < '0' || c > '9')
+						break;
+					m_Pos++;
+				}
+
+				if (integer && isInteger && m_Pos - start <= 18) {
+					int64_t value = 0;
+					for (size_t i = digitsStart; i < m_Pos; i++)
+						value = value * 10 + (m_Text[i] - '0');
+					*integer = m_Text[start] == '-' ? -value : value;
+				}
+				return true;
+			}
+
+			bool SkipValue(int depth)
+			{
+				if (depth > kMaxDepth)
+					return Fail("Nesting too deep");
+
+				SkipSpace();
+				if (m_Pos >= m_Text.size())
+					return Fail("Unexpected end of file");
+
+				switch (m_Text[m_Pos]) {
+				case '"':
+					return ReadString(nullptr);
+				case '{':
+					m_Pos++;
+					if (Consume('}'))
+						return true;
+					do {
+						if (!ReadString(nullptr))
+							return false;
+						if (!Consume(':'))
+							return Fail("Expected ':'");
+						if (!SkipValue(depth + 1))
+							return false;
+					} while (Consume(','));
+					return Consume('}') || Fail("Expected ',' or '}'");
+				case '[':
+					m_Pos++;
+					if (Consume(']'))
+						return true;
+					do {
+						if (!SkipValue(depth + 1))
+							return false;
+					} while (Consume(','));
+					return Consume(']') || Fail("Expected ',' or ']'");
+				case 't':
+					return ReadLiteral("true");
+				case 'f':
+					return ReadLiteral("false");
+				case 'n':
+					return ReadLiteral("null");
+				default:
+					return ReadNumber(nullptr);
+				}
+			}
+
+			bool ScanValues()
+			{
+				if (!Consume('{'))
+					return Fail("Expected \"values\" to be an object");
+				if (Consume('}'))
+					return true;
+
+				do {
+					if (m_ValueCount == m_Values.size())
+						m_Values.emplace_back();
+					auto& entry = m_Values[m_ValueCount];
+					if (!ReadString(&entry.pin))
+						return false;
+					if (!Consume(':'))
+						return Fail("Expected ':'");
+
+					if (!PeekIs('"')) {
+						if (!SkipValue(3))
+							return false;
+						continue;
+					}
+
+					entry.offset = m_Pos;
+					if (!ReadString(&entry.value))
+						return false;
+					entry.length = m_Pos - entry.offset;
+					m_ValueCount++;
+				} while (Consume(','));
+				return Consume('}') || Fail("Expected ',' or '}'");
+			}
+
+			bool ScanNode()
+			{
+				if (!Consume('{'))
+					return Fail("Expected a node object");
+
+				// The type can come after the values, so the node is only reported once it's complete.
+				m_Node.id = -1;
+				m_Node.type.clear();
+				m_ValueCount = 0;
+				if (!Consume('}')) {
+					do {
+						if (!ReadString(&m_Key))
+							return false;
+						if (!Consume(':'))
+							return Fail("Expected ':'");
+
+						bool ok;
+						if (m_Key == "type" && PeekIs('"'))
+							ok = ReadString(&m_Node.type);
+						else if (m_Key == "id" && !PeekIs('"') && !PeekIs('{') && !PeekIs('['))
+							ok = ReadNumber(&m_Node.id);
+						else if (m_Key == "values")
+							ok = ScanValues();
+						else
+							ok = SkipValue(2);
+						if (!ok)
+							return false;
+					} while (Consume(','));
+					if (!Consume('}'))
+						return Fail("Expected ',' or '}'");
+				}
+
+				m_Node.values = { m_Values.data(), m_ValueCount };
+				m_OnNode(m_Node);
+				return true;
+			}
+
+			bool ScanNodes()
+			{
+				if (!Consume('['))
+					return Fail("Expected \"nodes\" to be an array");
+				if (Consume(']'))
+					return true;
+
+				do {
+					if (!ScanNode())
+						return false;
+				} while (Consume(','));
+				return Consume(']') || Fail("Expected ',' or ']'");
+			}
+
+			bool ScanDocument()
+			{
+				if (!Consume('{'))
+					return Fail("Expected the document to be an object");
+
+				bool hasNodes = false;
+				if (!Consume('}')) {
+					do {
+						if (!ReadString(&m_Key))
+							return false;
+						if (!Consume(':'))
+							return Fail("Expected ':'");
+
+						bool isNodes = m_Key == "nodes" && !hasNodes;
+						if (!(isNodes ? ScanNodes() : SkipValue(1)))
+							return false;
+						hasNodes |= isNodes;
+					} while (Consume(','));
+					if (!Consume('}'))
+						return Fail("Expected ',' or '}'");
+				}
+
+				SkipSpace();
+				if (m_Pos != m_Text.size())
+					return Fail("Unexpected text after the document");
+				if (!hasNodes)
+					return Fail("Missing \"nodes\" array");
+				return true;
+			}
+
+			std::string_view m_Text;
+			const std::function<void(const Node&)>& m_OnNode;
+			size_t m_Pos = 0;
+			std::string m_Error;
+			std::string m_Key;
+			Node m_Node;
+			// Reused from node to node; only the first m_ValueCount belong to the current one.
+			std::vector<StringValue> m_Values;
+			size_t m_ValueCount = 0;
+		};
+	}
+
+	bool ForEachNode(std::string_view text, const std::function<void(const Node&)>& onNode, std::string* error)
+	{
+		return Scanner{ text, onNode }.Run(error);
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Reads the custom string values of a .bt file's nodes straight from the text, without building a JSON
+// document or any nodes, for batch tools that only need a few values from each of many files. Each value
+// comes with the position of its string in the text, so it can be replaced in place.
+namespace BtScan
+{
+	struct StringValue
+	{
+		std::string pin;
+		// Unescaped.
+		std::string value;
+		// The quoted string as it appears in the text.
+		size_t offset = 0;
+		size_t length = 0;
+	};
+
+	struct Node
+	{
+		// -1 if the node has no integer ID.
+		int64_t id = -1;
+		std::string type;
+		// The string entries of its "values" object, in file order.
+		std::span<const StringValue> values;
+	};
+
+	// Calls onNode for each element of the document's "nodes" array, in order; what it's passed is only valid
+	// for the call. Returns false with the reason in error if the text isn't valid JSON or isn't shaped like a
+	// graph, after the calls for the nodes before the problem.
+	bool ForEachNode(std::string_view text, const std::function<void(const Node&)>& onNode, std::string* error = nullptr);
+}
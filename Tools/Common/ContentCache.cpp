@@ -0,0 +1,110 @@
+#include "ContentCache.h"
+#include "BtFiles.h"
+#include "FileUtil.h"
+#include "Nodes/NodeDefinitions.h"
+#include <cstdio>
+#include <system_error>
+#include <xxhash.h>
+
+namespace
+{
+	constexpr std::string_view kEntryMagic = "bt-cache";
+
+	// Everything about the definitions that a tool's results can depend on: type names and pins.
+	uint64_t HashDefinitions()
+	{
+		std::string text;
+		const auto appendPins = [&text](std::span<const NodeDefinitions::PinDef> pins) {
+			for (auto& pin : pins) {
+				text += pin.typeName;
+				text += ':' + std::to_string(static_cast<int>(pin.type)) + ',';
+			}
+		};
+
+		for (auto& def : NodeDefinitions::GetDefs()) {
+			text += def.typeName;
+			text += '(';
+			appendPins(def.inputs);
+			text += ")(";
+			appendPins(def.outputs);
+			text += ");";
+		}
+		return XXH3_64bits(text.data(), text.size());
+	}
+
+	std::string ToHex(const ContentCache::Key& key)
+	{
+		char buffer[33];
+		std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(key.high), static_cast<unsigned long long>(key.low));
+		return buffer;
+	}
+
+	// An entry's first line names its key and the size of the result after it, which catches entries that were
+	// cut short or copied to the wrong name.
+	std::string GetEntryHeader(const ContentCache::Key& key, size_t resultSize)
+	{
+		return std::string{ kEntryMagic } + ' ' + ToHex(key) + ' ' + std::to_string(resultSize) + '\n';
+	}
+}
+
+ContentCache::ContentCache(std::filesystem::path directory, std::string_view tool, uint32_t toolVersion) :
+	m_Directory(std::move(directory))
+{
+	auto salt = std::string{ tool } + '\0' + std::to_string(toolVersion);
+	m_Seed = XXH3_64bits_withSeed(salt.data(), salt.size(), HashDefinitions());
+}
+
+ContentCache::Key ContentCache::GetKey(std::string_view content) const
+{
+	auto hash = XXH3_128bits_withSeed(content.data(), content.size(), m_Seed);
+	return { hash.low64, hash.high64 };
+}
+
+bool ContentCache::Find(const Key& key, std::string& result)
+{
+	std::string text;
+	auto path = GetEntryPath(key);
+	std::error_code ec;
+	if (!std::filesystem::exists(path, ec) || !BtFiles::Read(path, text)) {
+		m_Misses++;
+		return false;
+	}
+
+	auto headerEnd = text.find('\n');
+	if (headerEnd == std::string::npos || std::string_view{ text }.substr(0, headerEnd + 1) != GetEntryHeader(key, text.size() - headerEnd - 1)) {
+		m_Misses++;
+		return false;
+	}
+
+	result.assign(text, headerEnd + 1);
+	m_Hits++;
+	return true;
+}
+
+bool ContentCache::Store(const Key& key, std::string_view result, std::string* error)
+{
+	auto path = GetEntryPath(key);
+	std::error_code ec;
+	std::filesystem::create_directories(path.parent_path(), ec);
+	auto text = GetEntryHeader(key, result.size());
+	text += result;
+	if (!FileUtil_WriteAtomic(path, text, error)) {
+		m_StoreFailures++;
+		return false;
+	}
+
+	m_Stores++;
+	return true;
+}
+
+ContentCache::Stats ContentCache::GetStats() const
+{
+	return { m_Hits.load(), m_Misses.load(), m_Stores.load(), m_StoreFailures.load() };
+}
+
+std::filesystem::path ContentCache::GetEntryPath(const Key& key) const
+{
+	// The first byte picks one of 256 subdirectories, which keeps each directory small.
+	auto name = ToHex(key);
+	return m_Directory / name.substr(0, 2) / name.substr(2);
+}
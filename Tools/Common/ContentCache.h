@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Keeps what a batch tool computed from a file, such as validation results, in a directory on disk keyed by a
+// hash of the file's contents, so a later run pays one hash and one lookup for each file that hasn't changed.
+// Keys are XXH3 128-bit hashes seeded by the tool's name and version and by the node definition table, so a
+// new tool version or changed definitions never reuse old results.
+//
+// Every entry is its own file, written with FileUtil_WriteAtomic, so any number of threads and processes can
+// share a directory: readers see an entry whole or not at all, and a damaged one is treated as missing.
+// Entries are never removed; delete the directory to reclaim the space.
+class ContentCache
+{
+public:
+	struct Key
+	{
+		uint64_t low = 0;
+		uint64_t high = 0;
+	};
+
+	struct Stats
+	{
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t stores = 0;
+		size_t storeFailures = 0;
+	};
+
+	// toolVersion should change whenever the tool's results would.
+	ContentCache(std::filesystem::path directory, std::string_view tool, uint32_t toolVersion);
+
+	Key GetKey(std::string_view content) const;
+	// Thread-safe. Returns false if there's no entry for key.
+	bool Find(const Key& key, std::string& result);
+	// Thread-safe. Replaces any entry for key, such as a damaged one that Find passed over.
+	bool Store(const Key& key, std::string_view result, std::string* error = nullptr);
+
+	Stats GetStats() const;
+
+private:
+	std::filesystem::path GetEntryPath(const Key& key) const;
+
+	std::filesystem::path m_Directory;
+	uint64_t m_Seed = 0;
+	std::atomic<size_t> m_Hits{ 0 };
+	std::atomic<size_t> m_Misses{ 0 };
+	std::atomic<size_t> m_Stores{ 0 };
+	std::atomic<size_t> m_StoreFailures{ 0 };
+};
@@ -0,0 +1,472 @@
+#include "GraphLint.h"
+#include "GraphFile.h"
+#include "Nodes/NodeDefinitions.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace GraphLint
+{
+	namespace
+	{
+		constexpr uint32_t kUnvisited = UINT32_MAX;
+		// Node IDs a cycle diagnostic lists before it's cut short.
+		constexpr size_t kMaxCycleIdsShown = 8;
+
+		struct LintNode
+		{
+			int64_t id = -1;
+			// Null if the node's type is unknown; links to such a node aren't checked.
+			const NodeDefinitions::NodeDef* def = nullptr;
+		};
+
+		// An input's [nodeId, typeName] entry, resolved once every node's ID is known.
+		struct Reference
+		{
+			uint32_t consumer;
+			const NodeDefinitions::PinDef* input;
+			uint64_t producerId;
+			std::string_view outputTypeName;
+		};
+
+		// A link as Parse would make it, from an output of producer to an input of consumer.
+		struct LintLink
+		{
+			uint32_t producer;
+			uint32_t consumer;
+		};
+
+		const char* GetPinTypeName(PinType type)
+		{
+			switch (type) {
+			case PinType::Flow: return "Flow";
+			case PinType::Bool: return "Bool";
+			case PinType::Int: return "Int";
+			case PinType::Pose: return "Pose";
+			case PinType::String: return "String";
+			case PinType::Object: return "Object";
+			case PinType::Float: return "Float";
+			case PinType::Delegate: return "Delegate";
+			default: return "Custom";
+			}
+		}
+
+		std::string Quote(std::string_view text)
+		{
+			return "'" + std::string{ text } + "'";
+		}
+
+		class Checker
+		{
+		public:
+			explicit Checker(std::vector<Diagnostic>& diagnostics) : m_Diagnostics(diagnostics)
+			{
+			}
+
+			// Whether GraphFile::Parse can be expected to load the document.
+			bool IsLoadable() const { return m_Loadable; }
+
+			void Run(nlohmann::json& doc)
+			{
+				if (!doc.is_object()) {
+					Report(Severity::Error, "malformed-document", "The document isn't a JSON object.");
+					m_Loadable = false;
+					return;
+				}
+
+				// Parse iterates whatever "nodes" holds, so this does too, and reports anything but an array.
+				if (auto nodesIter = doc.find("nodes"); nodesIter != doc.end()) {
+					if (!nodesIter->is_array())
+						Report(Severity::Error, "malformed-document", "\"nodes\" isn't an array.");
+
+					size_t entry = 0;
+					for (auto& obj : *nodesIter)
+						ReadNode(obj, entry++);
+				}
+
+				CheckIdRange();
+				ResolveReferences();
+				CheckCycles();
+				CheckActors();
+			}
+
+		private:
+			void Report(Severity severity, const char* code, std::string message, int64_t nodeId = -1, std::string_view pin = {})
+			{
+				m_Diagnostics.push_back({ severity, code, std::move(message), nodeId, std::string{ pin } });
+			}
+
+			// Reports a node that FromJson would throw on.
+			void ReportMalformed(std::string message, int64_t nodeId = -1, std::string_view pin = {})
+			{
+				Report(Severity::Error, "malformed-node", std::move(message), nodeId, pin);
+				m_Loadable = false;
+			}
+
+			void ReadNode(const nlohmann::json& obj, size_t entry)
+			{
+				if (!obj.is_object()) {
+					Report(Severity::Warning, "malformed-node", "Entry " + std::to_string(entry) + " of \"nodes\" isn't an object, so it's skipped.");
+					return;
+				}
+
+				auto idIter = obj.find("id");
+				if (idIter == obj.end() || !idIter->is_number_unsigned()) {
+					ReportMalformed("Entry " + std::to_string(entry) + " of \"nodes\" has no valid \"id\".");
+					return;
+				}
+
+				uint64_t id = idIter->get<uint64_t>();
+				auto nodeId = static_cast<int64_t>(std::min<uint64_t>(id, INT64_MAX));
+				m_MaxNodeId = std::max(m_MaxNodeId, id);
+				if (id > INT32_MAX) {
+					Report(Severity::Error, "id-overflow", "Node ID exceeds maximum value.", nodeId);
+					m_Loadable = false;
+				}
+
+				auto typeIter = obj.find("type");
+				if (typeIter == obj.end() || !typeIter->is_string()) {
+					ReportMalformed("Node has no \"type\".", nodeId);
+					return;
+				}
+
+				auto index = static_cast<uint32_t>(m_Nodes.size());
+				auto& node = m_Nodes.emplace_back(LintNode{ nodeId, NodeDefinitions::FindDef(typeIter->get_ref<const std::string&>()) });
+				// As in Parse, links to a repeated ID go to the first node with it.
+				if (!m_NodeIndices.try_emplace(id, index).second)
+					Report(Severity::Error, "duplicate-id", "Node ID is also used by an earlier node.", nodeId);
+
+				auto posIter = obj.find("pos");
+				if (posIter == obj.end() || !posIter->is_array() || posIter->size() < 2 || !(*posIter)[0].is_number() || !(*posIter)[1].is_number())
+					ReportMalformed("Node has no valid \"pos\".", nodeId);
+
+				if (!node.def) {
+					Report(Severity::Error, "unknown-type", "Node has unknown type " + Quote(typeIter->get_ref<const std::string&>()) + ".", nodeId);
+					m_Loadable = false;
+					return;
+				}
+
+				m_PinCount += node.def->inputs.size() + node.def->outputs.size();
+				ReadInputs(obj, index);
+			}
+
+			void ReadInputs(const nlohmann::json& obj, uint32_t index)
+			{
+				auto& node = m_Nodes[index];
+				// Parse looks pins up in "inputs" and "values" only if they're objects.
+				const auto findMember = [&obj](const char* name) -> const nlohmann::json* {
+					auto iter = obj.find(name);
+					return iter != obj.end() && iter->is_object() ? &*iter : nullptr;
+				};
+				const auto findEntry = [](const nlohmann::json* members, const std::string& key) -> const nlohmann::json* {
+					if (!members)
+						return nullptr;
+					auto iter = members->find(key);
+					return iter != members->end() ? &*iter : nullptr;
+				};
+				const nlohmann::json* links = findMember("inputs");
+				const nlohmann::json* values = findMember("values");
+
+				const auto findPin = [&node](const std::string& typeName, bool custom) {
+					return std::any_of(node.def->inputs.begin(), node.def->inputs.end(), [&](const NodeDefinitions::PinDef& pin) {
+						return pin.typeName == typeName && (pin.type >= PinType::CustomStart) == custom;
+					});
+				};
+
+				for (auto& input : node.def->inputs) {
+					std::string key{ input.typeName };
+					if (input.type >= PinType::CustomStart) {
+						auto value = findEntry(values, key);
+						bool valid = !value || (input.type == PinType::CustomString ? value->is_string() : value->is_number());
+						if (!valid)
+							ReportMalformed("Value " + Quote(key) + " should be a " + (input.type == PinType::CustomString ? "string." : "number."), node.id, key);
+						continue;
+					}
+
+					auto link = findEntry(links, key);
+					if (link && (!link->is_array() || link->size() < 2 || !(*link)[0].is_number_unsigned() || !(*link)[1].is_string())) {
+						ReportMalformed("Input " + Quote(key) + " should be a [nodeId, typeName] pair.", node.id, key);
+						continue;
+					}
+
+					// The editor writes [0, ""] for an input it has no link for, so node 0 means the same as no entry.
+					auto producerId = link ? (*link)[0].get<uint64_t>() : 0;
+					if (producerId == 0) {
+						if (input.type == PinType::Pose)
+							Report(Severity::Error, "unconnected-pose", "Pose input " + Quote(key) + " isn't linked.", node.id, key);
+						continue;
+					}
+					m_References.push_back({ index, &input, producerId, (*link)[1].get_ref<const std::string&>() });
+				}
+
+				// Parse ignores entries that don't name one of the node's pins; they're most likely typos.
+				if (links) {
+					for (auto& item : links->items()) {
+						if (!findPin(item.key(), false))
+							Report(Severity::Warning, "unknown-pin", "Input " + Quote(item.key()) + " isn't an input of " + std::string{ node.def->name } + ", so it's ignored.", node.id, item.key());
+					}
+				}
+				if (values) {
+					for (auto& item : values->items()) {
+						if (!findPin(item.key(), true))
+							Report(Severity::Warning, "unknown-pin", "Value " + Quote(item.key()) + " isn't a value of " + std::string{ node.def->name } + ", so it's ignored.", node.id, item.key());
+					}
+				}
+			}
+
+			// Pins are numbered after the highest node ID and links after the pins, as Parse numbers them.
+			void CheckIdRange()
+			{
+				if (m_MaxNodeId <= INT32_MAX && m_MaxNodeId + m_PinCount > INT32_MAX) {
+					Report(Severity::Error, "id-overflow", "Pin IDs exceed maximum value.");
+					m_Loadable = false;
+				}
+			}
+
+			void ResolveReferences()
+			{
+				for (auto& reference : m_References) {
+					auto& consumer = m_Nodes[reference.consumer];
+					auto key = reference.input->typeName;
+
+					auto producerIter = m_NodeIndices.find(reference.producerId);
+					if (producerIter == m_NodeIndices.end()) {
+						Report(Severity::Error, "dangling-reference", "Input " + Quote(key) + " refers to node " + std::to_string(reference.producerId) + ", which doesn't exist.", consumer.id, key);
+						continue;
+					}
+
+					auto& producer = m_Nodes[producerIter->second];
+					if (!producer.def)
+						continue;
+
+					auto output = std::find_if(producer.def->outputs.begin(), producer.def->outputs.end(), [&](const NodeDefinitions::PinDef& pin) { return pin.typeName == reference.outputTypeName; });
+					if (output == producer.def->outputs.end()) {
+						Report(Severity::Error, "dangling-reference", "Input " + Quote(key) + " refers to output " + Quote(reference.outputTypeName) + " of node " + std::to_string(producer.id) + ", which " + std::string{ producer.def->name } + " doesn't have.", consumer.id, key);
+						continue;
+					}
+
+					if (output->type != reference.input->type) {
+						Report(Severity::Error, "type-mismatch", "Input " + Quote(key) + " (" + GetPinTypeName(reference.input->type) + ") is linked to output " + Quote(output->typeName) + " (" + GetPinTypeName(output->type) + ") of node " + std::to_string(producer.id) + ".", consumer.id, key);
+					}
+					if (producerIter->second == reference.consumer) {
+						Report(Severity::Error, "cycle", "Input " + Quote(key) + " is linked to the node's own output.", consumer.id, key);
+						continue;
+					}
+
+					m_Links.push_back({ producerIter->second, reference.consumer });
+				}
+
+				if (m_MaxNodeId <= INT32_MAX && m_MaxNodeId + m_PinCount <= INT32_MAX && m_MaxNodeId + m_PinCount + m_Links.size() > INT32_MAX) {
+					Report(Severity::Error, "id-overflow", "Link IDs exceed maximum value.");
+					m_Loadable = false;
+				}
+			}
+
+			// Adjacency from each consumer to its producers, in compressed rows.
+			void BuildProducerLists()
+			{
+				m_ProducerOffsets.assign(m_Nodes.size() + 1, 0);
+				for (auto& link : m_Links)
+					m_ProducerOffsets[link.consumer + 1]++;
+				for (size_t i = 0; i < m_Nodes.size(); i++)
+					m_ProducerOffsets[i + 1] += m_ProducerOffsets[i];
+
+				m_Producers.resize(m_Links.size());
+				auto next = m_ProducerOffsets;
+				for (auto& link : m_Links)
+					m_Producers[next[link.consumer]++] = link.producer;
+			}
+
+			// Finds strongly connected components with an iterative Tarjan's algorithm, so deep chains can't
+			// overflow the stack, and reports each one with more than a node as a cycle.
+			void CheckCycles()
+			{
+				BuildProducerLists();
+
+				size_t count = m_Nodes.size();
+				std::vector<uint32_t> order(count, kUnvisited);
+				std::vector<uint32_t> lowLink(count, 0);
+				std::vector<bool> onStack(count, false);
+				std::vector<uint32_t> stack;
+				// Node being visited and the next of its producers to follow.
+				std::vector<std::pair<uint32_t, uint32_t>> callStack;
+				uint32_t nextOrder = 0;
+
+				const auto visit = [&](uint32_t node) {
+					order[node] = lowLink[node] = nextOrder++;
+					stack.push_back(node);
+					onStack[node] = true;
+					callStack.emplace_back(node, m_ProducerOffsets[node]);
+				};
+
+				for (uint32_t root = 0; root < count; root++) {
+					if (order[root] != kUnvisited)
+						continue;
+
+					visit(root);
+					while (!callStack.empty()) {
+						auto [node, edge] = callStack.back();
+						if (edge < m_ProducerOffsets[node + 1]) {
+							callStack.back().second++;
+							uint32_t next = m_Producers[edge];
+							if (order[next] == kUnvisited)
+								visit(next);
+							else if (onStack[next])
+								lowLink[node] = std::min(lowLink[node], order[next]);
+							continue;
+						}
+
+						callStack.pop_back();
+						if (!callStack.empty()) {
+							auto parent = callStack.back().first;
+							lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+						}
+						if (lowLink[node] != order[node])
+							continue;
+
+						std::vector<uint32_t> component;
+						uint32_t member;
+						do {
+							member = stack.back();
+							stack.pop_back();
+							onStack[member] = false;
+							component.push_back(member);
+						} while (member != node);
+
+						if (component.size() > 1)
+							ReportCycle(component);
+					}
+				}
+			}
+
+			void ReportCycle(std::vector<uint32_t>& component)
+			{
+				std::sort(component.begin(), component.end());
+				std::string ids;
+				for (size_t i = 0; i < component.size() && i < kMaxCycleIdsShown; i++)
+					ids += (i ? ", " : "") + std::to_string(m_Nodes[component[i]].id);
+				if (component.size() > kMaxCycleIdsShown)
+					ids += " and " + std::to_string(component.size() - kMaxCycleIdsShown) + " more";
+				Report(Severity::Error, "cycle", "Nodes " + ids + " form a cycle.", m_Nodes[component.front()].id);
+			}
+
+			// Everything the actor evaluates is reached by following inputs back from it.
+			void CheckActors()
+			{
+				std::vector<uint32_t> pending;
+				for (uint32_t i = 0; i < m_Nodes.size(); i++) {
+					if (m_Nodes[i].def && m_Nodes[i].def->typeName == "actor")
+						pending.push_back(i);
+				}
+
+				if (pending.empty()) {
+					Report(Severity::Error, "missing-actor", "The graph has no Actor node.");
+					return;
+				}
+				if (pending.size() > 1)
+					Report(Severity::Warning, "multiple-actors", "The graph has " + std::to_string(pending.size()) + " Actor nodes.", m_Nodes[pending[1]].id);
+
+				std::vector<bool> reached(m_Nodes.size(), false);
+				for (auto actor : pending)
+					reached[actor] = true;
+				while (!pending.empty()) {
+					auto node = pending.back();
+					pending.pop_back();
+					for (auto i = m_ProducerOffsets[node]; i < m_ProducerOffsets[node + 1]; i++) {
+						if (!reached[m_Producers[i]]) {
+							reached[m_Producers[i]] = true;
+							pending.push_back(m_Producers[i]);
+						}
+					}
+				}
+
+				// Only the ends of each unused branch are reported; the rest of it follows from them, and a
+				// warning per node would bury everything else in a graph with large unused parts.
+				std::vector<bool> consumed(m_Nodes.size(), false);
+				for (auto& link : m_Links)
+					consumed[link.producer] = true;
+				for (size_t i = 0; i < m_Nodes.size(); i++) {
+					if (!reached[i] && !consumed[i] && m_Nodes[i].def)
+						Report(Severity::Warning, "unreachable", std::string{ m_Nodes[i].def->name } + " node isn't connected to the actor and nothing uses its output, so it and any nodes used only by it are never evaluated.", m_Nodes[i].id);
+				}
+			}
+
+			std::vector<Diagnostic>& m_Diagnostics;
+			bool m_Loadable = true;
+			std::vector<LintNode> m_Nodes;
+			std::unordered_map<uint64_t, uint32_t> m_NodeIndices;
+			std::vector<Reference> m_References;
+			std::vector<LintLink> m_Links;
+			std::vector<uint32_t> m_ProducerOffsets;
+			std::vector<uint32_t> m_Producers;
+			uint64_t m_MaxNodeId = 0;
+			uint64_t m_PinCount = 0;
+		};
+	}
+
+	std::vector<Diagnostic> Check(nlohmann::json& doc)
+	{
+		std::vector<Diagnostic> diagnostics;
+		Checker checker{ diagnostics };
+		checker.Run(doc);
+		if (!checker.IsLoadable())
+			return diagnostics;
+
+		// The checks above are meant to catch everything that stops a load; this makes sure of it.
+		try {
+			GraphFile::Graph graph;
+			GraphFile::Parse(doc, graph, 1);
+		}
+		catch (const std::exception& ex) {
+			diagnostics.push_back({ Severity::Error, "load-failed", std::string{ "Failed to load blend graph file. Error: " } + ex.what() });
+		}
+		return diagnostics;
+	}
+
+	std::vector<Diagnostic> CheckText(std::string_view text)
+	{
+		nlohmann::json doc;
+		try {
+			doc = nlohmann::json::parse(text);
+		}
+		catch (const std::exception& ex) {
+			return { { Severity::Error, "invalid-json", std::string{ "Failed to parse blend graph file. Error: " } + ex.what() } };
+		}
+		return Check(doc);
+	}
+
+	const char* GetSeverityName(Severity severity)
+	{
+		return severity == Severity::Error ? "error" : "warning";
+	}
+
+	nlohmann::json ToJson(const Diagnostic& diagnostic)
+	{
+		nlohmann::json obj{
+			{ "severity", GetSeverityName(diagnostic.severity) },
+			{ "code", diagnostic.code },
+			{ "message", diagnostic.message }
+		};
+		if (diagnostic.nodeId >= 0)
+			obj["node"] = diagnostic.nodeId;
+		if (!diagnostic.pin.empty())
+			obj["pin"] = diagnostic.pin;
+		return obj;
+	}
+
+	bool FromJson(const nlohmann::json& obj, Diagnostic& diagnostic)
+	{
+		if (!obj.is_object() || !obj.contains("severity") || !obj.contains("code") || !obj.contains("message"))
+			return false;
+
+		auto& severity = obj["severity"];
+		if (severity != "error" && severity != "warning")
+			return false;
+
+		diagnostic.severity = severity == "error" ? Severity::Error : Severity::Warning;
+		diagnostic.code = obj["code"].get<std::string>();
+		diagnostic.message = obj["message"].get<std::string>();
+		diagnostic.nodeId = obj.value("node", int64_t{ -1 });
+		diagnostic.pin = obj.value("pin", std::string{});
+		return true;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Checks .bt documents for problems that stop them loading in the editor, and for graphs that load but can't
+// be evaluated as intended: broken or mistyped links, cycles, missing poses and nodes the actor never reaches.
+namespace GraphLint
+{
+	enum class Severity
+	{
+		Warning,
+		Error
+	};
+
+	struct Diagnostic
+	{
+		Severity severity = Severity::Error;
+		// Short, stable name for the kind of problem, such as "type-mismatch".
+		std::string code;
+		std::string message;
+		// The node the problem is on, or -1 for the document as a whole.
+		int64_t nodeId = -1;
+		// Type name of the pin the problem is on, if any.
+		std::string pin;
+	};
+
+	// Reports every problem in doc. The checks work from the JSON, so one bad node doesn't hide the others. If
+	// none of them would stop the document loading, it's then loaded with GraphFile::Parse, on the calling thread
+	// only, exactly as the editor would load it; that modifies doc.
+	std::vector<Diagnostic> Check(nlohmann::json& doc);
+	// Parses text as AsyncGraphLoad does, then checks it.
+	std::vector<Diagnostic> CheckText(std::string_view text);
+
+	const char* GetSeverityName(Severity severity);
+	nlohmann::json ToJson(const Diagnostic& diagnostic);
+	// Returns false if obj wasn't written by ToJson.
+	bool FromJson(const nlohmann::json& obj, Diagnostic& diagnostic);
+}
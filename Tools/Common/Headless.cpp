@@ -0,0 +1,37 @@
+#include "Headless.h"
+#include "BlendSpaceEditor/AllocTracker.h"
+#include "BlendSpaceEditor/Main.h"
+
+namespace Main
+{
+	ImFont* g_mainFont{ nullptr };
+	ImFont* g_mainFontSmall{ nullptr };
+	ImFont* g_mainFontMedium{ nullptr };
+	ImTextureID(*updateTexture)(ImTextureID texture, const void* pixels, int width, int height) { nullptr };
+}
+
+namespace Headless
+{
+	void CreateContext(const ImVec2& displaySize)
+	{
+#ifdef BLENDGRAPH_TRACK_ALLOCATIONS
+		ImGui::SetAllocatorFunctions(AllocTracker::ImGuiAlloc, AllocTracker::ImGuiFree);
+#endif
+		ImGui::CreateContext();
+		ImGuiIO& io = ImGui::GetIO();
+		io.IniFilename = nullptr;
+		io.DisplaySize = displaySize;
+		io.DeltaTime = 1.0f / 60.0f;
+
+		auto font = io.Fonts->AddFontDefault();
+		unsigned char* pixels = nullptr;
+		int width = 0, height = 0;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+		Main::g_mainFont = Main::g_mainFontSmall = Main::g_mainFontMedium = font;
+	}
+
+	void DestroyContext()
+	{
+		ImGui::DestroyContext();
+	}
+}
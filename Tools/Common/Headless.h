@@ -0,0 +1,11 @@
+#pragma once
+#include "imgui.h"
+
+// ImGui setup for tools that run editor code without a window or renderer backend.
+namespace Headless
+{
+	// Creates an ImGui context with a built default font atlas, and provides the fonts
+	// and texture hook that Editor otherwise gets from the Win32-only Main.cpp.
+	void CreateContext(const ImVec2& displaySize = ImVec2(1920.0f, 1080.0f));
+	void DestroyContext();
+}
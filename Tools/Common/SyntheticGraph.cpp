@@ -0,0 +1,191 @@
+#include "SyntheticGraph.h"
+#include "Nodes/NodeDefinitions.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <random>
+
+namespace SyntheticGraph
+{
+	namespace
+	{
+		struct Producer
+		{
+			size_t nodeId;
+			size_t depth;
+			std::string_view outputTypeName;
+		};
+
+		// Producers of one pin type that may still be linked without exceeding the depth limit.
+		struct ProducerPool
+		{
+			std::vector<Producer> all;
+			std::deque<Producer> unconsumed;
+		};
+
+		void SetCustomValue(nlohmann::json& values, const NodeDefinitions::PinDef& pin, std::mt19937& rng)
+		{
+			std::string key{ pin.typeName };
+			switch (pin.type) {
+			case PinType::CustomInt:
+				values[key] = static_cast<int>(rng() % 8);
+				break;
+			case PinType::CustomFloat:
+				values[key] = std::uniform_real_distribution<float>{ -1.0f, 1.0f }(rng);
+				break;
+			case PinType::CustomString:
+				if (pin.typeName == "file") {
+					char buffer[64];
+					std::snprintf(buffer, sizeof(buffer), "Animations/synthetic_%04u.glb", static_cast<unsigned>(rng() % 2000));
+					values[key] = buffer;
+				}
+				else if (pin.typeName == "name") {
+					values[key] = "var_" + std::to_string(rng() % 64);
+				}
+				else {
+					values[key] = "bone_" + std::to_string(rng() % 120);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	bool ParseShape(std::string_view name, Shape& out)
+	{
+		if (name == "chain")
+			out = Shape::Chain;
+		else if (name == "tree")
+			out = Shape::Tree;
+		else if (name == "wide")
+			out = Shape::Wide;
+		else
+			return false;
+
+		return true;
+	}
+
+	bool ParseTypeWeights(std::string_view spec, std::vector<std::pair<std::string, double>>& out)
+	{
+		out.clear();
+		double totalWeight = 0.0;
+		while (!spec.empty()) {
+			auto end = spec.find(',');
+			auto entry = spec.substr(0, end);
+			spec = end == std::string_view::npos ? std::string_view{} : spec.substr(end + 1);
+
+			auto eq = entry.find('=');
+			if (eq == std::string_view::npos)
+				return false;
+
+			std::string typeName{ entry.substr(0, eq) };
+			if (!NodeDefinitions::FindDef(typeName) || typeName == "actor")
+				return false;
+
+			// Weights feed std::discrete_distribution, which needs them finite, not negative and not all zero.
+			auto text = entry.substr(eq + 1);
+			double weight = 0.0;
+			auto [parsed, ec] = std::from_chars(text.data(), text.data() + text.size(), weight);
+			if (ec != std::errc{} || parsed != text.data() + text.size() || !std::isfinite(weight) || weight < 0.0)
+				return false;
+			out.emplace_back(std::move(typeName), weight);
+			totalWeight += weight;
+		}
+		return !out.empty() && totalWeight > 0.0 && std::isfinite(totalWeight);
+	}
+
+	nlohmann::json Generate(const Options& options)
+	{
+		std::mt19937 rng{ options.seed };
+
+		auto actorDef = NodeDefinitions::FindDef("actor");
+		std::vector<const NodeDefinitions::NodeDef*> candidates;
+		std::vector<double> weights;
+		if (options.typeWeights.empty()) {
+			for (auto& d : NodeDefinitions::GetDefs()) {
+				if (&d != actorDef) {
+					candidates.push_back(&d);
+					weights.push_back(1.0);
+				}
+			}
+		}
+		else {
+			for (auto& [typeName, weight] : options.typeWeights) {
+				if (auto d = NodeDefinitions::FindDef(typeName); d && d != actorDef) {
+					candidates.push_back(d);
+					weights.push_back(weight);
+				}
+			}
+		}
+		std::discrete_distribution<size_t> typeDist{ weights.begin(), weights.end() };
+
+		std::map<PinType, ProducerPool> pools;
+		std::map<size_t, size_t> nodesPerDepth;
+
+		nlohmann::json obj;
+		obj["version"] = 1;
+		auto& nodes = obj["nodes"];
+		nodes = nlohmann::json::array();
+
+		size_t bodyCount = options.nodeCount > 1 ? options.nodeCount - 1 : 0;
+		for (size_t i = 0; i <= bodyCount; i++) {
+			bool isActor = i == bodyCount;
+			auto def = isActor ? actorDef : candidates[typeDist(rng)];
+			auto& n = nodes.emplace_back();
+			n["id"] = i + 1;
+			n["type"] = def->typeName;
+
+			size_t depth = 0;
+			size_t linkedInputs = 0;
+			for (auto& pin : def->inputs) {
+				if (pin.type > PinType::CustomStart) {
+					SetCustomValue(n["values"], pin, rng);
+					continue;
+				}
+
+				auto& pool = pools[pin.type];
+				if (pool.all.empty() || (options.fanIn != 0 && linkedInputs >= options.fanIn))
+					continue;
+
+				Producer source;
+				if (isActor || options.shape == Shape::Chain) {
+					source = pool.all.back();
+				}
+				else if (options.shape == Shape::Tree && !pool.unconsumed.empty()) {
+					source = pool.unconsumed.front();
+					pool.unconsumed.pop_front();
+				}
+				else {
+					source = pool.all[rng() % pool.all.size()];
+				}
+
+				auto& link = n["inputs"][std::string{ pin.typeName }];
+				link.push_back(source.nodeId);
+				link.push_back(source.outputTypeName);
+				depth = std::max(depth, source.depth + 1);
+				++linkedInputs;
+			}
+
+			// Nodes at the depth limit are left out of the pools, so nothing can be stacked on top of them.
+			bool canBeLinked = options.maxDepth == 0 || depth + 1 < options.maxDepth;
+			for (auto& pin : def->outputs) {
+				if (!canBeLinked)
+					break;
+
+				Producer p{ i + 1, depth, pin.typeName };
+				auto& pool = pools[pin.type];
+				pool.all.push_back(p);
+				pool.unconsumed.push_back(p);
+			}
+
+			auto& pos = n["pos"];
+			pos.push_back(static_cast<float>(depth) * 420.0f);
+			pos.push_back(static_cast<float>(nodesPerDepth[depth]++) * 260.0f);
+		}
+
+		return obj;
+	}
+}
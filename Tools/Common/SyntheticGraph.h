@@ -0,0 +1,40 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Generates valid .bt documents for benchmarks. Nodes are emitted in topological order and only link to
+// earlier nodes whose output type matches the input pin, so every graph is acyclic and loads cleanly.
+namespace SyntheticGraph
+{
+	enum class Shape
+	{
+		// Each node consumes the most recently produced value, giving long dependency chains.
+		Chain,
+		// Producers are consumed oldest-first, giving a balanced tree towards the actor.
+		Tree,
+		// Inputs pick any earlier producer, giving heavy output fan-out.
+		Wide
+	};
+
+	struct Options
+	{
+		size_t nodeCount = 1000;
+		Shape shape = Shape::Tree;
+		uint32_t seed = 1;
+		// Maximum number of linked inputs per node, 0 for no limit.
+		size_t fanIn = 0;
+		// Maximum link depth below the actor, 0 for no limit.
+		size_t maxDepth = 0;
+		// Relative weight per node type name; types not listed are never generated. Empty means uniform.
+		std::vector<std::pair<std::string, double>> typeWeights;
+	};
+
+	bool ParseShape(std::string_view name, Shape& out);
+	// Parses "anim=4,blend_1d=1,..." into typeWeights, rejecting unknown type names, weights that aren't finite
+	// and at least zero, and lists whose weights add up to zero.
+	bool ParseTypeWeights(std::string_view spec, std::vector<std::pair<std::string, double>>& out);
+	nlohmann::json Generate(const Options& options);
+}
@@ -0,0 +1,281 @@
+#include "BlendSpaceEditor/AllocTracker.h"
+#include "BlendSpaceEditor/Editor.h"
+#include "BlendSpaceEditor/GraphFile.h"
+#include "BlendSpaceEditor/Trace.h"
+#include "Common/BtFiles.h"
+#include "Common/Headless.h"
+#include "Common/SyntheticGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Drives Editor::OnFrame headlessly (ImGui context without a renderer backend) over a synthetic graph
+// with scripted pans, zooms and link drags, and reports per-phase frame timings. With --assert-no-alloc
+// it then checks that idle frames make no heap allocations, and fails with a call site report if they do.
+
+namespace
+{
+    constexpr int kSegmentFrames = 120;
+    constexpr int kWarmupFrames = 10;
+    constexpr int kIdleSettleFrames = 30;
+    constexpr int kIdleCheckFrames = 60;
+
+    struct Samples
+    {
+        const char* name;
+        std::vector<double> values;
+
+        double Percentile(double p)
+        {
+            if (values.empty())
+                return 0.0;
+
+            std::sort(values.begin(), values.end());
+            auto index = static_cast<size_t>(std::ceil(p * values.size())) - 1;
+            return values[std::min(index, values.size() - 1)];
+        }
+    };
+
+    enum class Segment
+    {
+        Idle,
+        Pan,
+        Zoom,
+        LinkDrag
+    };
+
+    // Approximate screen positions of a node's first input and output pin, from its canvas bounds.
+    ImVec2 GetPinScreenPos(ed::NodeId id, bool output)
+    {
+        auto pos = ed::GetNodePosition(id);
+        auto size = ed::GetNodeSize(id);
+        float x = output ? pos.x + size.x - 16.0f : pos.x + 16.0f;
+        return ed::CanvasToScreen(ImVec2(x, pos.y + 44.0f));
+    }
+
+    class InputScript
+    {
+    public:
+        InputScript(Editor& editor, uint32_t seed) : m_Editor(editor), m_Rng(seed) {}
+
+        void Apply(ImGuiIO& io, int frame)
+        {
+            auto segment = static_cast<Segment>((frame / kSegmentFrames) % 4);
+            int step = frame % kSegmentFrames;
+            float t = static_cast<float>(step) / (kSegmentFrames - 1);
+            ImVec2 center{ io.DisplaySize.x * 0.5f, io.DisplaySize.y * 0.5f };
+
+            switch (segment) {
+            case Segment::Idle:
+                io.AddMousePosEvent(center.x, center.y);
+                break;
+            case Segment::Pan:
+                io.AddMousePosEvent(center.x + std::sin(t * 6.2831f) * 400.0f, center.y + std::cos(t * 6.2831f) * 200.0f);
+                if (step == 0)
+                    io.AddMouseButtonEvent(ImGuiMouseButton_Right, true);
+                else if (step == kSegmentFrames - 1)
+                    io.AddMouseButtonEvent(ImGuiMouseButton_Right, false);
+                break;
+            case Segment::Zoom:
+                io.AddMousePosEvent(center.x, center.y);
+                if (step % 4 == 0)
+                    io.AddMouseWheelEvent(0.0f, step < kSegmentFrames / 2 ? -1.0f : 1.0f);
+                break;
+            case Segment::LinkDrag:
+            {
+                if (step == 0)
+                    BeginLinkDrag();
+
+                ImVec2 pos{ m_DragFrom.x + (m_DragTo.x - m_DragFrom.x) * t, m_DragFrom.y + (m_DragTo.y - m_DragFrom.y) * t };
+                io.AddMousePosEvent(pos.x, pos.y);
+                if (step == 1)
+                    io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+                else if (step == kSegmentFrames - 2)
+                    io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+                else if (step == kSegmentFrames - 1)
+                    io.AddKeyEvent(ImGuiKey_Escape, true); // Dismiss the "Create New Node" popup if the drop missed a pin.
+                break;
+            }
+            }
+
+            if (segment != Segment::LinkDrag && step == 0)
+                io.AddKeyEvent(ImGuiKey_Escape, false);
+        }
+
+    private:
+        void BeginLinkDrag()
+        {
+            auto& nodes = m_Editor.m_Nodes;
+            if (nodes.size() < 2)
+                return;
+
+            ed::SetCurrentEditor(m_Editor.m_Editor);
+            m_DragFrom = GetPinScreenPos(nodes[m_Rng() % nodes.size()].id, true);
+            m_DragTo = GetPinScreenPos(nodes[m_Rng() % nodes.size()].id, false);
+            ed::SetCurrentEditor(nullptr);
+        }
+
+        Editor& m_Editor;
+        std::mt19937 m_Rng;
+        ImVec2 m_DragFrom;
+        ImVec2 m_DragTo;
+    };
+
+    void PrintUsage()
+    {
+        std::printf(
+            "Usage: EditorFrameBench [--nodes N] [--shape chain|tree|wide] [--frames N] [--seed N] [--trace PATH] [--assert-no-alloc]\n"
+            "  --nodes   Number of nodes in the synthetic graph (default 1000)\n"
+            "  --shape   Graph shape (default tree)\n"
+            "  --frames  Frames to run after warm-up (default 480)\n"
+            "  --seed    Generator and input script seed (default 1)\n"
+            "  --trace   Record the measured frames as a Chrome trace to PATH\n"
+            "  --assert-no-alloc  Exit with an error if an idle frame allocates\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    SyntheticGraph::Options graphOptions;
+    int frameCount = kSegmentFrames * 4;
+    std::filesystem::path tracePath;
+    bool assertNoAlloc = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--nodes" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], graphOptions.nodeCount)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--shape" && hasValue) {
+            if (!SyntheticGraph::ParseShape(argv[++i], graphOptions.shape)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--frames" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], frameCount)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--seed" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], graphOptions.seed)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--assert-no-alloc") {
+            assertNoAlloc = true;
+        }
+        else {
+            PrintUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Headless::CreateContext();
+    Trace::SetThreadName("Main");
+    ImGuiIO& io = ImGui::GetIO();
+    int result = 0;
+
+    {
+        Editor editor;
+        auto document = SyntheticGraph::Generate(graphOptions);
+        ed::SetCurrentEditor(editor.m_Editor);
+        GraphFile::Load(editor, document);
+        ed::SetCurrentEditor(nullptr);
+
+        InputScript script{ editor, graphOptions.seed };
+        Samples frame{ "Frame" };
+        Samples renderNodes{ "OnFrame_RenderNodes" };
+        Samples renderLinks{ "OnFrame_RenderLinks" };
+        Samples creations{ "OnFrame_UpdatePendingCreations" };
+        Samples deletions{ "OnFrame_UpdatePendingDeletions" };
+
+        const auto runFrame = [&]() {
+            TRACE_SCOPE("Frame");
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("Main", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize);
+            editor.OnFrame(io);
+            ImGui::End();
+            ImGui::Render();
+        };
+
+        for (int f = 0; f < frameCount + kWarmupFrames; f++) {
+            bool measured = f >= kWarmupFrames;
+            if (measured)
+                script.Apply(io, f - kWarmupFrames);
+            if (f == kWarmupFrames && !tracePath.empty())
+                Trace::Start();
+
+            auto start = std::chrono::steady_clock::now();
+            runFrame();
+            double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (measured) {
+                frame.values.push_back(frameMs);
+                renderNodes.values.push_back(editor.m_LastFrameTimings.renderNodes);
+                renderLinks.values.push_back(editor.m_LastFrameTimings.renderLinks);
+                creations.values.push_back(editor.m_LastFrameTimings.updatePendingCreations);
+                deletions.values.push_back(editor.m_LastFrameTimings.updatePendingDeletions);
+            }
+        }
+
+        if (Trace::IsRecording()) {
+            Trace::Stop();
+            if (!Trace::Write(tracePath))
+                std::fprintf(stderr, "Failed to write %s\n", tracePath.string().c_str());
+        }
+
+        std::printf("%zu nodes, %zu links, %d frames\n", editor.m_Nodes.size(), editor.m_Links.size(), frameCount);
+        std::printf("sizeof Node %zu, Pin %zu, Link %zu bytes\n", sizeof(Node), sizeof(Pin), sizeof(Link));
+        std::printf("%-32s %10s %10s %10s\n", "Phase (ms)", "p50", "p99", "max");
+        for (auto samples : { &frame, &renderNodes, &renderLinks, &creations, &deletions }) {
+            std::printf("%-32s %10.3f %10.3f %10.3f\n", samples->name,
+                samples->Percentile(0.50), samples->Percentile(0.99), samples->Percentile(1.0));
+        }
+
+        if (assertNoAlloc) {
+            for (int f = 0; f < kIdleSettleFrames; f++)
+                runFrame();
+
+            uint64_t worstFrame = 0;
+            for (int f = 0; f < kIdleCheckFrames; f++) {
+                auto before = AllocTracker::GetThreadTotals().count;
+                runFrame();
+                worstFrame = std::max(worstFrame, AllocTracker::GetThreadTotals().count - before);
+            }
+
+            if (worstFrame == 0) {
+                std::printf("Idle frames: no heap allocations\n");
+            }
+            else {
+                std::printf("Idle frames: up to %llu heap allocations per frame\n", static_cast<unsigned long long>(worstFrame));
+                AllocTracker::ResetCallSites();
+                AllocTracker::SetCallSiteTracking(true);
+                runFrame();
+                AllocTracker::SetCallSiteTracking(false);
+                for (auto& site : AllocTracker::GetCallSites(10))
+                    std::printf("%8llu allocs %10llu bytes  %s\n", static_cast<unsigned long long>(site.count),
+                        static_cast<unsigned long long>(site.bytes), site.stack.c_str());
+                result = 2;
+            }
+        }
+    }
+
+    Headless::DestroyContext();
+    return result;
+}
@@ -0,0 +1,283 @@
+#include "BlendSpaceEditor/AllocTracker.h"
+#include "BlendSpaceEditor/Editor.h"
+#include "BlendSpaceEditor/GraphBatch.h"
+#include "Common/BtFiles.h"
+#include "Common/Headless.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Compares building a graph one item at a time (Editor::SpawnNode and SpawnLink, as the New Node menu does)
+// with building it through GraphBatch, and with pasting a copy of it (Editor::PasteNodes). All paths build
+// the same tree of nodes and links; the tool checks that they match and reports time and heap allocations.
+
+namespace
+{
+    struct Result
+    {
+        std::string path;
+        size_t nodes = 0;
+        size_t links = 0;
+        double ms = 0.0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+
+        double NodesPerSecond() const { return ms > 0.0 ? nodes / (ms / 1000.0) : 0.0; }
+    };
+
+    // The graph to build: node i gets defs[i % count] and, when possible, a link from one of the outputs
+    // of node (i - 1) / 2.
+    struct Plan
+    {
+        struct PlannedLink
+        {
+            size_t startNode;
+            size_t startSlot;
+            size_t endNode;
+            size_t endSlot;
+        };
+
+        std::vector<const NodeDefinitions::NodeDef*> defs;
+        std::vector<ImVec2> positions;
+        std::vector<PlannedLink> links;
+    };
+
+    Plan MakePlan(size_t nodeCount)
+    {
+        auto defList = NodeDefinitions::GetDefs();
+        Plan plan;
+        plan.defs.reserve(nodeCount);
+        plan.positions.reserve(nodeCount);
+        for (size_t i = 0; i < nodeCount; i++) {
+            plan.defs.push_back(&defList[i % defList.size()]);
+            plan.positions.emplace_back(static_cast<float>(i % 100) * 420.0f, static_cast<float>(i / 100) * 260.0f);
+        }
+
+        for (size_t i = 1; i < nodeCount; i++) {
+            size_t parent = (i - 1) / 2;
+            auto& outputs = plan.defs[parent]->outputs;
+            auto& inputs = plan.defs[i]->inputs;
+            bool linked = false;
+            for (size_t o = 0; o < outputs.size() && !linked; o++) {
+                for (size_t n = 0; n < inputs.size() && !linked; n++) {
+                    if (inputs[n].type < PinType::CustomStart && inputs[n].type == outputs[o].type) {
+                        plan.links.push_back({ parent, o, i, n });
+                        linked = true;
+                    }
+                }
+            }
+        }
+        return plan;
+    }
+
+    void ResetEditor(Editor& editor)
+    {
+        editor.m_LastId = 0;
+        editor.Clear();
+    }
+
+    // Hash of the graph's shape in terms of node order and pin slots, which doesn't depend on how IDs were handed out.
+    uint64_t GetShapeFingerprint(Editor& editor)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        const auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+        mix(editor.m_Nodes.size());
+        for (auto& node : editor.m_Nodes)
+            mix(reinterpret_cast<uintptr_t>(node.def));
+        for (auto& link : editor.m_Links) {
+            auto start = *editor.LookupId(link.startPinID.Get());
+            auto end = *editor.LookupId(link.endPinID.Get());
+            mix(start.index);
+            mix(start.slot);
+            mix(end.index);
+            mix(end.slot);
+        }
+        return hash;
+    }
+
+    // Runs op `iterations` times, keeping the fastest time; setup runs untimed before each iteration.
+    Result Measure(const char* path, size_t nodes, size_t links, int iterations, const std::function<void()>& setup, const std::function<void()>& op)
+    {
+        Result result{ path, nodes, links };
+        result.ms = 1e30;
+        for (int i = 0; i < iterations; i++) {
+            if (setup)
+                setup();
+
+            auto allocationsBefore = AllocTracker::GetTotals();
+            auto start = std::chrono::steady_clock::now();
+            op();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            auto allocationsAfter = AllocTracker::GetTotals();
+
+            result.ms = std::min(result.ms, ms);
+            result.allocations = allocationsAfter.count - allocationsBefore.count;
+            result.allocatedBytes = allocationsAfter.bytes - allocationsBefore.bytes;
+        }
+        return result;
+    }
+
+    // Parses a comma-separated list of node counts, saying what's wrong with it on stderr if it isn't one.
+    bool ParseSizes(std::string_view spec, std::vector<size_t>& sizes)
+    {
+        sizes.clear();
+        for (auto rest = spec;;) {
+            auto end = rest.find(',');
+            if (!BtFiles::ParseNumber(rest.substr(0, end), sizes.emplace_back())) {
+                std::fprintf(stderr, "--sizes takes a comma-separated list of numbers, not \"%.*s\".\n", static_cast<int>(spec.size()), spec.data());
+                return false;
+            }
+            if (end == std::string_view::npos)
+                return true;
+            rest = rest.substr(end + 1);
+        }
+    }
+
+    void PrintUsage()
+    {
+        std::printf(
+            "Usage: GraphBuildBench [--sizes N,N,...] [--iterations N] [--threads N] [--json PATH]\n"
+            "  --sizes       Node counts to benchmark (default 100,1000,10000,100000)\n"
+            "  --iterations  Runs per measurement, fastest is reported (default 3)\n"
+            "  --threads     Maximum threads for GraphBatch, 0 for all (default 0)\n"
+            "  --json        Also write the results as JSON to PATH\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes{ 100, 1000, 10000, 100000 };
+    int iterations = 3;
+    unsigned threads = 0;
+    int result = 0;
+    std::filesystem::path jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            if (!ParseSizes(argv[++i], sizes)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--iterations" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], iterations)) {
+                PrintUsage();
+                return 1;
+            }
+            iterations = std::max(1, iterations);
+        }
+        else if (arg == "--threads" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], threads)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        }
+        else {
+            PrintUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Headless::CreateContext();
+    std::vector<Result> results;
+
+    {
+        Editor editor;
+        ed::SetCurrentEditor(editor.m_Editor);
+        GraphBatch batch{ editor };
+
+        for (auto size : sizes) {
+            auto plan = MakePlan(size);
+            auto links = plan.links.size();
+
+            results.push_back(Measure("SpawnNode", size, links, iterations, [&]() { ResetEditor(editor); }, [&]() {
+                for (size_t i = 0; i < size; i++)
+                    editor.SpawnNode(plan.defs[i], plan.positions[i]);
+                for (auto& link : plan.links)
+                    editor.SpawnLink(&editor.m_Nodes[link.startNode].outputs[link.startSlot], &editor.m_Nodes[link.endNode].inputs[link.endSlot]);
+            }));
+            auto spawnFingerprint = GetShapeFingerprint(editor);
+
+            std::vector<ed::NodeId> nodes;
+            std::string error;
+            for (auto [path, maxThreads] : { std::pair{ "GraphBatch_Serial", 1u }, std::pair{ "GraphBatch", threads } }) {
+                results.push_back(Measure(path, size, links, iterations, [&]() { ResetEditor(editor); nodes.clear(); nodes.reserve(size); }, [&]() {
+                    batch.Reserve(size, links);
+                    for (size_t i = 0; i < size; i++)
+                        nodes.push_back(batch.AddNode(plan.defs[i], plan.positions[i]));
+                    for (auto& link : plan.links)
+                        batch.AddLink(batch.GetOutputId(nodes[link.startNode], link.startSlot), batch.GetInputId(nodes[link.endNode], link.endSlot));
+                    if (!batch.Commit(&error, maxThreads))
+                        std::fprintf(stderr, "Batch of %zu nodes failed: %s\n", size, error.c_str());
+                }));
+                if (GetShapeFingerprint(editor) != spawnFingerprint) {
+                    std::fprintf(stderr, "%s of %zu nodes differs from the one-at-a-time build\n", path, size);
+                    result = 1;
+                }
+            }
+
+            GraphFile::Graph clipboard;
+            std::vector<ed::NodeId> ids;
+            for (auto& node : editor.m_Nodes)
+                ids.push_back(node.id);
+            editor.CopyNodes(ids, clipboard);
+
+            results.push_back(Measure("PasteNodes", size, links, iterations, [&]() { ResetEditor(editor); }, [&]() {
+                editor.PasteNodes(clipboard, ImVec2(0.0f, 0.0f));
+            }));
+            if (GetShapeFingerprint(editor) != spawnFingerprint) {
+                std::fprintf(stderr, "Paste of %zu nodes differs from the one-at-a-time build\n", size);
+                result = 1;
+            }
+        }
+
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    Headless::DestroyContext();
+
+    std::printf("%-18s %8s %8s %10s %12s %12s %14s\n", "Path", "Nodes", "Links", "ms", "Nodes/s", "Allocs", "AllocBytes");
+    for (auto& r : results) {
+        std::printf("%-18s %8zu %8zu %10.3f %12.0f %12llu %14llu\n", r.path.c_str(), r.nodes, r.links, r.ms, r.NodesPerSecond(),
+            static_cast<unsigned long long>(r.allocations), static_cast<unsigned long long>(r.allocatedBytes));
+    }
+
+    if (!jsonPath.empty()) {
+        nlohmann::json report;
+        report["benchmark"] = "GraphBuildBench";
+        report["iterations"] = iterations;
+        report["threads"] = threads;
+        auto& entries = report["results"];
+        entries = nlohmann::json::array();
+        for (auto& r : results) {
+            entries.push_back({
+                { "path", r.path },
+                { "nodes", r.nodes },
+                { "links", r.links },
+                { "ms", r.ms },
+                { "nodesPerSec", r.NodesPerSecond() },
+                { "allocations", r.allocations },
+                { "allocatedBytes", r.allocatedBytes }
+            });
+        }
+
+        std::ofstream outFile{ jsonPath };
+        if (!outFile.is_open()) {
+            std::fprintf(stderr, "Failed to write %s\n", jsonPath.string().c_str());
+            return 1;
+        }
+        outFile << report.dump(2) << '\n';
+    }
+
+    return result;
+}
@@ -0,0 +1,333 @@
+#include "BlendSpaceEditor/AllocTracker.h"
+#include "BlendSpaceEditor/Editor.h"
+#include "BlendSpaceEditor/FileUtil.h"
+#include "BlendSpaceEditor/GraphFile.h"
+#include "BlendSpaceEditor/StringPool.h"
+#include "Common/BtFiles.h"
+#include "Common/Headless.h"
+#include "Common/SyntheticGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Measures throughput of the .bt load/save paths (the steps of Main::LoadData/SaveData, and Node::FromJson,
+// Node::ToJson and Node::CompactJsonIds on their own) over synthetic graphs, including heap allocations and
+// peak RSS, and reports how much the string pool deduplicated. Results can be written as JSON for CI to diff.
+
+namespace
+{
+    struct Result
+    {
+        std::string path;
+        size_t nodes = 0;
+        size_t bytes = 0;
+        double ms = 0.0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t peakRssKb = 0;
+
+        double MegabytesPerSecond() const { return ms > 0.0 ? (bytes / (1024.0 * 1024.0)) / (ms / 1000.0) : 0.0; }
+        double NodesPerSecond() const { return ms > 0.0 ? nodes / (ms / 1000.0) : 0.0; }
+    };
+
+    // Resets the kernel's peak RSS counter where supported, so each measurement reports its own peak.
+    void ResetPeakRss()
+    {
+#ifdef __linux__
+        if (auto file = std::fopen("/proc/self/clear_refs", "w")) {
+            std::fputs("5", file);
+            std::fclose(file);
+        }
+#endif
+    }
+
+    uint64_t GetPeakRssKb()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize / 1024;
+#else
+#ifdef __linux__
+        if (auto file = std::fopen("/proc/self/status", "r")) {
+            char line[256];
+            uint64_t value = 0;
+            while (std::fgets(line, sizeof(line), file)) {
+                if (std::sscanf(line, "VmHWM: %lu kB", &value) == 1)
+                    break;
+            }
+            std::fclose(file);
+            if (value)
+                return value;
+        }
+#endif
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+    }
+
+    // Runs op `iterations` times, keeping the fastest time; setup runs untimed before each iteration.
+    Result Measure(const char* path, size_t nodes, size_t bytes, int iterations, const std::function<void()>& setup, const std::function<void()>& op)
+    {
+        Result result{ path, nodes, bytes };
+        result.ms = 1e30;
+        for (int i = 0; i < iterations; i++) {
+            if (setup)
+                setup();
+
+            ResetPeakRss();
+            auto allocationsBefore = AllocTracker::GetTotals();
+            auto start = std::chrono::steady_clock::now();
+            op();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            auto allocationsAfter = AllocTracker::GetTotals();
+
+            result.ms = std::min(result.ms, ms);
+            result.allocations = allocationsAfter.count - allocationsBefore.count;
+            result.allocatedBytes = allocationsAfter.bytes - allocationsBefore.bytes;
+            result.peakRssKb = GetPeakRssKb();
+        }
+        return result;
+    }
+
+    // Hash of every ID and connection in the editor's graph, to check that loads are deterministic.
+    uint64_t GetGraphFingerprint(const Editor& editor)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        const auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+        for (auto& node : editor.m_Nodes) {
+            mix(node.id.Get());
+            for (auto& input : node.inputs)
+                mix(input.id.Get());
+            for (auto& output : node.outputs) {
+                mix(output.id.Get());
+                for (auto id : std::get<NodeOutputConnection>(output.connected).ids)
+                    mix(id.Get());
+            }
+        }
+        for (auto& link : editor.m_Links) {
+            mix(link.id.Get());
+            mix(link.startPinID.Get());
+            mix(link.endPinID.Get());
+        }
+        mix(editor.m_LastId);
+        return hash;
+    }
+
+    // Parses a comma-separated list of node counts, saying what's wrong with it on stderr if it isn't one.
+    bool ParseSizes(std::string_view spec, std::vector<size_t>& sizes)
+    {
+        sizes.clear();
+        for (auto rest = spec;;) {
+            auto end = rest.find(',');
+            if (!BtFiles::ParseNumber(rest.substr(0, end), sizes.emplace_back())) {
+                std::fprintf(stderr, "--sizes takes a comma-separated list of numbers, not \"%.*s\".\n", static_cast<int>(spec.size()), spec.data());
+                return false;
+            }
+            if (end == std::string_view::npos)
+                return true;
+            rest = rest.substr(end + 1);
+        }
+    }
+
+    void PrintUsage()
+    {
+        std::printf(
+            "Usage: GraphIOBench [--sizes N,N,...] [--iterations N] [--shape chain|tree|wide] [--seed N] [--threads N] [--json PATH]\n"
+            "  --sizes       Node counts to benchmark (default 10,100,1000,10000,100000)\n"
+            "  --iterations  Runs per measurement, fastest is reported (default 3)\n"
+            "  --threads     Maximum load threads, 0 for all (default 0)\n"
+            "  --json        Also write the results as JSON to PATH\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes{ 10, 100, 1000, 10000, 100000 };
+    SyntheticGraph::Options graphOptions;
+    int iterations = 3;
+    unsigned threads = 0;
+    int result = 0;
+    std::filesystem::path jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            if (!ParseSizes(argv[++i], sizes)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--iterations" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], iterations)) {
+                PrintUsage();
+                return 1;
+            }
+            iterations = std::max(1, iterations);
+        }
+        else if (arg == "--shape" && hasValue) {
+            if (!SyntheticGraph::ParseShape(argv[++i], graphOptions.shape)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--seed" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], graphOptions.seed)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--threads" && hasValue) {
+            if (!BtFiles::ParseNumberOption(arg, argv[++i], threads)) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        }
+        else {
+            PrintUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Headless::CreateContext();
+    std::vector<Result> results;
+    auto tempPath = std::filesystem::temp_directory_path() / "GraphIOBench.bt";
+
+    {
+        Editor editor;
+        ed::SetCurrentEditor(editor.m_Editor);
+
+        for (auto size : sizes) {
+            graphOptions.nodeCount = size;
+            auto document = SyntheticGraph::Generate(graphOptions);
+            auto text = document.dump();
+            {
+                std::ofstream file{ tempPath, std::ios::binary };
+                file << text;
+            }
+
+            results.push_back(Measure("LoadData_Serial", size, text.size(), iterations, nullptr, [&]() {
+                std::ifstream inFile{ tempPath };
+                auto obj = nlohmann::json::parse(inFile);
+                GraphFile::Load(editor, obj, 1);
+            }));
+            auto serialFingerprint = GetGraphFingerprint(editor);
+
+            results.push_back(Measure("LoadData", size, text.size(), iterations, nullptr, [&]() {
+                std::ifstream inFile{ tempPath };
+                auto obj = nlohmann::json::parse(inFile);
+                GraphFile::Load(editor, obj, threads);
+            }));
+            if (GetGraphFingerprint(editor) != serialFingerprint) {
+                std::fprintf(stderr, "Parallel load of %zu nodes differs from the serial load\n", size);
+                result = 1;
+            }
+
+            // The part of a save that still blocks the UI thread. Each save captures into a new snapshot.
+            std::optional<GraphFile::Graph> snapshot;
+            results.push_back(Measure("CaptureGraph", size, text.size(), iterations, [&]() { snapshot.reset(); }, [&]() {
+                GraphFile::Capture(editor, snapshot.emplace());
+            }));
+
+            results.push_back(Measure("SaveData", size, text.size(), iterations, nullptr, [&]() {
+                nlohmann::json obj;
+                GraphFile::Save(editor, obj);
+                if (!FileUtil_WriteAtomic(tempPath, obj.dump()))
+                    std::fprintf(stderr, "Failed to write %s\n", tempPath.string().c_str());
+            }));
+
+            std::vector<Node> nodes;
+            results.push_back(Measure("FromJson", size, text.size(), iterations, [&]() { nodes.clear(); nodes.reserve(size); }, [&]() {
+                size_t maxId = 0;
+                ImVec2 position;
+                for (auto& n : document["nodes"])
+                    nodes.emplace_back().FromJson(n, maxId, position);
+            }));
+
+            nlohmann::json saved;
+            results.push_back(Measure("ToJson", size, text.size(), iterations, [&]() { saved = nlohmann::json::array(); }, [&]() {
+                for (auto& node : editor.m_Nodes)
+                    node.ToJson(saved.emplace_back(), ed::GetNodePosition(node.id));
+            }));
+
+            nlohmann::json compacted;
+            results.push_back(Measure("CompactJsonIds", size, text.size(), iterations, [&]() { compacted = saved; }, [&]() {
+                Node::CompactJsonIds(compacted);
+            }));
+        }
+
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    std::filesystem::remove(tempPath);
+    Headless::DestroyContext();
+
+    std::printf("%-16s %8s %10s %10s %10s %12s %12s %14s %10s\n", "Path", "Nodes", "Bytes", "ms", "MB/s", "Nodes/s", "Allocs", "AllocBytes", "PeakRSS KB");
+    for (auto& r : results) {
+        std::printf("%-16s %8zu %10zu %10.3f %10.1f %12.0f %12llu %14llu %10llu\n", r.path.c_str(), r.nodes, r.bytes, r.ms,
+            r.MegabytesPerSecond(), r.NodesPerSecond(), static_cast<unsigned long long>(r.allocations),
+            static_cast<unsigned long long>(r.allocatedBytes), static_cast<unsigned long long>(r.peakRssKb));
+    }
+
+    // Every load interns the same text again, so requests add up across runs while storage doesn't.
+    auto pool = StringPool::Get().GetStats();
+    std::printf("\nString pool: %zu requests for %zu bytes of text, stored as %zu distinct strings in %zu bytes (%zu reserved)\n",
+        pool.requests, pool.requestedBytes, pool.strings, pool.storedBytes, pool.reservedBytes);
+
+    if (!jsonPath.empty()) {
+        nlohmann::json report;
+        report["benchmark"] = "GraphIOBench";
+        report["seed"] = graphOptions.seed;
+        report["iterations"] = iterations;
+        report["threads"] = threads;
+        auto& entries = report["results"];
+        entries = nlohmann::json::array();
+        for (auto& r : results) {
+            entries.push_back({
+                { "path", r.path },
+                { "nodes", r.nodes },
+                { "bytes", r.bytes },
+                { "ms", r.ms },
+                { "mbPerSec", r.MegabytesPerSecond() },
+                { "nodesPerSec", r.NodesPerSecond() },
+                { "allocations", r.allocations },
+                { "allocatedBytes", r.allocatedBytes },
+                { "peakRssKb", r.peakRssKb }
+            });
+        }
+
+        std::ofstream outFile{ jsonPath };
+        if (!outFile.is_open()) {
+            std::fprintf(stderr, "Failed to write %s\n", jsonPath.string().c_str());
+            return 1;
+        }
+        report["stringPool"] = {
+            { "requests", pool.requests },
+            { "requestedBytes", pool.requestedBytes },
+            { "strings", pool.strings },
+            { "storedBytes", pool.storedBytes },
+            { "reservedBytes", pool.reservedBytes }
+        };
+        outFile << report.dump(2) << '\n';
+    }
+
+    return result;
+}
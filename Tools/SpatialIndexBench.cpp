@@ -0,0 +1,120 @@
+#include "BlendSpaceEditor/SpatialIndex.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Compares SpatialIndex rectangle/point queries and incremental updates against a linear
+// scan over every node's bounds, which is what callers did before the index existed.
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void RunBenchmark(size_t nodeCount, size_t queryCount)
+    {
+        std::mt19937 rng{ 1234 };
+        // Keep density roughly constant so a viewport sees a similar number of nodes at every size.
+        float extent = std::sqrt(static_cast<float>(nodeCount)) * 400.0f;
+        std::uniform_real_distribution<float> posDist{ 0.0f, extent };
+        std::uniform_real_distribution<float> widthDist{ 150.0f, 350.0f };
+        std::uniform_real_distribution<float> heightDist{ 80.0f, 300.0f };
+        std::uniform_real_distribution<float> moveDist{ -40.0f, 40.0f };
+
+        std::vector<SpatialIndex::Rect> bounds(nodeCount);
+        for (auto& b : bounds) {
+            b.minX = posDist(rng);
+            b.minY = posDist(rng);
+            b.maxX = b.minX + widthDist(rng);
+            b.maxY = b.minY + heightDist(rng);
+        }
+
+        SpatialIndex index;
+        auto start = Clock::now();
+        for (size_t i = 0; i < nodeCount; i++)
+            index.Insert(i + 1, bounds[i]);
+        double buildMs = ElapsedMs(start);
+
+        std::vector<SpatialIndex::Rect> viewports(queryCount);
+        for (auto& v : viewports) {
+            v.minX = posDist(rng);
+            v.minY = posDist(rng);
+            v.maxX = v.minX + 1920.0f;
+            v.maxY = v.minY + 1080.0f;
+        }
+
+        std::vector<uint64_t> results;
+        size_t linearHits = 0;
+        start = Clock::now();
+        for (auto& v : viewports) {
+            results.clear();
+            for (size_t i = 0; i < nodeCount; i++) {
+                if (bounds[i].Overlaps(v))
+                    results.push_back(i + 1);
+            }
+            linearHits += results.size();
+        }
+        double linearRectMs = ElapsedMs(start);
+
+        size_t indexHits = 0;
+        start = Clock::now();
+        for (auto& v : viewports) {
+            results.clear();
+            index.QueryRect(v, results);
+            indexHits += results.size();
+        }
+        double indexRectMs = ElapsedMs(start);
+
+        start = Clock::now();
+        for (auto& v : viewports) {
+            results.clear();
+            for (size_t i = 0; i < nodeCount; i++) {
+                if (bounds[i].Contains(v.minX, v.minY))
+                    results.push_back(i + 1);
+            }
+        }
+        double linearPointMs = ElapsedMs(start);
+
+        start = Clock::now();
+        for (auto& v : viewports) {
+            results.clear();
+            index.QueryPoint(v.minX, v.minY, results);
+        }
+        double indexPointMs = ElapsedMs(start);
+
+        std::uniform_int_distribution<size_t> nodeDist{ 0, nodeCount - 1 };
+        start = Clock::now();
+        for (size_t i = 0; i < queryCount; i++) {
+            auto n = nodeDist(rng);
+            float dx = moveDist(rng);
+            float dy = moveDist(rng);
+            auto& b = bounds[n];
+            b = { b.minX + dx, b.minY + dy, b.maxX + dx, b.maxY + dy };
+            index.Update(n + 1, b);
+        }
+        double updateMs = ElapsedMs(start);
+
+        if (linearHits != indexHits)
+            std::printf("  WARNING: result mismatch (linear %zu, index %zu)\n", linearHits, indexHits);
+
+        std::printf("%8zu nodes | build %8.2f ms | rect: linear %8.4f ms, index %8.4f ms (%6.1fx) | point: linear %8.4f ms, index %8.4f ms (%6.1fx) | update %8.4f us\n",
+            nodeCount, buildMs,
+            linearRectMs / queryCount, indexRectMs / queryCount, linearRectMs / indexRectMs,
+            linearPointMs / queryCount, indexPointMs / queryCount, linearPointMs / indexPointMs,
+            updateMs * 1000.0 / queryCount);
+    }
+}
+
+int main()
+{
+    for (size_t nodeCount : { 1000, 10000, 100000 })
+        RunBenchmark(nodeCount, 1000);
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include "BlendSpaceEditor/AsyncGraphSaver.h"
+#include "BlendSpaceEditor/AutosaveJournal.h"
+#include "BlendSpaceEditor/Editor.h"
+#include "BlendSpaceEditor/StringPool.h"
+#include "Common/Headless.h"
+#include "Common/SyntheticGraph.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+// Journals every kind of change to a graph, recovers it into another editor and compares the two. Then
+// damages the end of the journal, as a crash part way through a write would, and checks that recovery
+// stops at the last intact change, and that counts the file can't hold are rejected. Last, saves the graph
+// as the editor does, and checks that the journal is kept when the save fails or the graph changed after
+// it was taken.
+
+namespace
+{
+    // Every ID, position, connection and value in the editor's graph, as text.
+    std::string Describe(Editor& editor)
+    {
+        std::ostringstream out;
+        ed::SetCurrentEditor(editor.m_Editor);
+        for (auto& node : editor.m_Nodes) {
+            auto position = ed::GetNodePosition(node.id);
+            out << "node " << node.id.Get() << ' ' << node.def->typeName << " at " << position.x << ',' << position.y << '\n';
+            for (auto& input : node.inputs) {
+                out << "  in " << input.id.Get() << ' ';
+                std::visit([&](auto& connection) {
+                    using T = std::decay_t<decltype(connection)>;
+                    if constexpr (std::is_same_v<T, NodeInputConnection>)
+                        out << "<- " << connection.id.Get();
+                    else if constexpr (std::is_same_v<T, NodeStringCustomValueConnection>)
+                        out << '"' << connection.value << '"';
+                    else if constexpr (std::is_same_v<T, NodeIntCustomValueConnection> || std::is_same_v<T, NodeFloatCustomValueConnection>)
+                        out << connection.value;
+                }, input.connected);
+                out << '\n';
+            }
+            for (auto& output : node.outputs) {
+                out << "  out " << output.id.Get() << " ->";
+                for (auto id : std::get<NodeOutputConnection>(output.connected).ids)
+                    out << ' ' << id.Get();
+                out << '\n';
+            }
+        }
+        for (auto& link : editor.m_Links)
+            out << "link " << link.id.Get() << ' ' << link.startPinID.Get() << " -> " << link.endPinID.Get() << '\n';
+        out << "last id " << editor.m_LastId << '\n';
+        ed::SetCurrentEditor(nullptr);
+        return out.str();
+    }
+
+    // Recovers path into a new editor and describes the result, or returns an empty string.
+    std::string Recover(const std::filesystem::path& path)
+    {
+        Editor editor;
+        std::string error;
+        ed::SetCurrentEditor(editor.m_Editor);
+        bool recovered = AutosaveJournal::Recover(editor, path, &error);
+        ed::SetCurrentEditor(nullptr);
+        if (!CHECK(recovered)) {
+            std::fprintf(stderr, "Recovering %s: %s\n", path.generic_string().c_str(), error.c_str());
+            return {};
+        }
+        return Describe(editor);
+    }
+
+    // Links the first output of from into the first input of to that accepts it.
+    bool LinkAny(Editor& editor, ed::NodeId from, ed::NodeId to)
+    {
+        auto source = editor.FindNode(from);
+        auto target = editor.FindNode(to);
+        for (auto& output : source->outputs) {
+            for (auto& input : target->inputs) {
+                if (editor.CanCreateLink(&output, &input))
+                    return editor.SpawnLink(&output, &input) != nullptr;
+            }
+        }
+        return false;
+    }
+
+    // Sets every custom value of node, escapes and non-ASCII text included.
+    void EditValues(Editor& editor, ed::NodeId id)
+    {
+        for (auto& input : editor.FindNode(id)->inputs) {
+            Pin::ConnectionVariant value = input.connected;
+            if (auto text = std::get_if<NodeStringCustomValueConnection>(&value))
+                text->value = StringPool::Get().Intern("Anims/\"Run\" \\ Fast\t\xC3\xA9.glb");
+            else if (auto number = std::get_if<NodeIntCustomValueConnection>(&value))
+                number->value = -42;
+            else if (auto real = std::get_if<NodeFloatCustomValueConnection>(&value))
+                real->value = 2.5f;
+            else
+                continue;
+            editor.SetPinValue(input, value);
+        }
+    }
+
+    std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::string& bytes)
+    {
+        std::ofstream{ path, std::ios::binary | std::ios::trunc }.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    template<typename T>
+    void Append(std::string& out, T value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // A journal holding just a checkpoint record with these counts, checksummed as AutosaveJournal does.
+    std::string MakeCheckpointJournal(uint32_t lastId, uint32_t nodeCount, uint32_t linkCount)
+    {
+        std::string record;
+        Append(record, uint8_t{ 1 });
+        Append(record, uint32_t{ 13 });
+        Append(record, lastId);
+        Append(record, nodeCount);
+        Append(record, linkCount);
+        Append(record, uint8_t{ 1 });
+        uint32_t checksum = 2166136261u;
+        for (char c : record)
+            checksum = (checksum ^ static_cast<uint8_t>(c)) * 16777619u;
+        Append(record, checksum);
+
+        std::string journal;
+        Append(journal, uint32_t{ 0x4A414742 });
+        Append(journal, uint32_t{ 1 });
+        return journal + record;
+    }
+
+    // Saves the editor's graph to documentPath, changing it once more after the snapshot when changeAfter is
+    // set, and closes the journal once the save finished, as quitting does. Returns whether the journal was kept.
+    bool SaveAndClose(const std::filesystem::path& documentPath, const std::filesystem::path& journalPath, bool changeAfter)
+    {
+        Editor editor;
+        AutosaveJournal journal{ editor };
+        journal.Open(journalPath, false);
+        journal.Update();
+
+        ed::SetCurrentEditor(editor.m_Editor);
+        editor.SpawnNode(NodeDefinitions::FindDef("anim"), ImVec2(5.0f, 6.0f));
+        GraphFile::Graph graph;
+        GraphFile::Capture(editor, graph);
+        auto revision = journal.GetRevision();
+        if (changeAfter)
+            editor.SpawnNode(NodeDefinitions::FindDef("anim"), ImVec2(50.0f, 60.0f));
+        ed::SetCurrentEditor(nullptr);
+
+        AsyncGraphSaver saver;
+        saver.Submit(documentPath, std::move(graph), revision);
+        saver.Finish();
+        auto results = saver.TakeResults();
+        CHECK(results.size() == 1);
+        for (auto& result : results) {
+            CHECK(result.revision == revision);
+            if (result.error.empty())
+                journal.MarkSaved(result.revision);
+            else
+                journal.MarkUnsaved();
+        }
+        journal.Close();
+        return journal.HasUnsavedChanges();
+    }
+}
+
+int main()
+{
+    Headless::CreateContext();
+    auto journalPath = std::filesystem::temp_directory_path() / "AutosaveJournalTest.bt.autosave";
+    auto damagedPath = std::filesystem::temp_directory_path() / "AutosaveJournalTest-damaged.bt.autosave";
+
+    std::string beforeLastChange, live;
+    {
+        Editor editor;
+        ed::SetCurrentEditor(editor.m_Editor);
+        SyntheticGraph::Options options;
+        options.nodeCount = 300;
+        auto document = SyntheticGraph::Generate(options);
+        GraphFile::Load(editor, document);
+        ed::SetCurrentEditor(nullptr);
+
+        AutosaveJournal journal{ editor };
+        journal.Open(journalPath, false);
+        journal.Update();
+
+        ed::SetCurrentEditor(editor.m_Editor);
+        auto anim = editor.SpawnNode(NodeDefinitions::FindDef("anim"), ImVec2(5.0f, 6.0f))->id;
+        EditValues(editor, anim);
+        // The first node type that takes the animation as an input.
+        ed::NodeId target = 0;
+        for (auto& def : NodeDefinitions::GetDefs()) {
+            auto id = editor.SpawnNode(&def, ImVec2(50.0f, 60.0f))->id;
+            if (LinkAny(editor, anim, id)) {
+                target = id;
+                break;
+            }
+            editor.DestroyNode(id);
+        }
+        CHECK(target);
+        EditValues(editor, target);
+        NodeMove moves[] = { { anim, ImVec2(5.0f, 6.0f), ImVec2(100.0f, 200.0f) }, { target, ImVec2(50.0f, 60.0f), ImVec2(-30.0f, 12.5f) } };
+        editor.MoveNodes(moves);
+        editor.DestroyLink(editor.m_Links.front().id);
+        editor.DestroyNode(editor.m_Nodes[3].id);
+        editor.SpawnNode(NodeDefinitions::GetDefs().data(), ImVec2(7.0f, 7.0f));
+        ed::SetCurrentEditor(nullptr);
+        journal.Update();
+        beforeLastChange = Describe(editor);
+
+        // A frame with a single change, so damaging the end of the journal loses only that.
+        ed::SetCurrentEditor(editor.m_Editor);
+        NodeMove lastMove[] = { { anim, ImVec2(100.0f, 200.0f), ImVec2(300.0f, 400.0f) } };
+        editor.MoveNodes(lastMove);
+        ed::SetCurrentEditor(nullptr);
+        journal.Update();
+        live = Describe(editor);
+        CHECK(live != beforeLastChange);
+        // Destroying the journal without closing it leaves the file as a crash would.
+    }
+
+    CHECK(AutosaveJournal::HasUnsavedChanges(journalPath));
+    CHECK(Recover(journalPath) == live);
+
+    auto journal = ReadFile(journalPath);
+    CHECK(journal.size() > 16);
+
+    // A record cut short.
+    WriteFile(damagedPath, journal.substr(0, journal.size() - 3));
+    CHECK(Recover(damagedPath) == beforeLastChange);
+
+    // A record whose checksum doesn't match.
+    auto corrupted = journal;
+    corrupted[corrupted.size() - 6] ^= 0x5A;
+    WriteFile(damagedPath, corrupted);
+    CHECK(Recover(damagedPath) == beforeLastChange);
+
+    // The start of a record that was never finished.
+    WriteFile(damagedPath, journal + std::string("\x03\xFF\x00", 3));
+    CHECK(Recover(damagedPath) == live);
+
+    // Counts in the checkpoint that the file can't back are damage, and never sizes for an allocation.
+    WriteFile(damagedPath, MakeCheckpointJournal(INT32_MAX, 0, 0));
+    CHECK(!Recover(damagedPath).empty());
+    WriteFile(damagedPath, MakeCheckpointJournal(INT32_MAX, UINT32_MAX, UINT32_MAX));
+    {
+        Editor editor;
+        ed::SetCurrentEditor(editor.m_Editor);
+        CHECK(!AutosaveJournal::Recover(editor, damagedPath, nullptr));
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    std::filesystem::remove(journalPath);
+    std::filesystem::remove(damagedPath);
+
+    // A save that succeeds discards the journal once the writer gets to it, which destroying it waits for.
+    auto documentPath = std::filesystem::temp_directory_path() / "AutosaveJournalTest.bt";
+    CHECK(!SaveAndClose(documentPath, journalPath, false));
+    CHECK(!std::filesystem::exists(journalPath));
+
+    // One that fails, here for want of a directory to write to, keeps it for recovery.
+    CHECK(SaveAndClose(std::filesystem::temp_directory_path() / "AutosaveJournalTest-missing" / "Graph.bt", journalPath, false));
+    CHECK(AutosaveJournal::HasUnsavedChanges(journalPath));
+    std::filesystem::remove(journalPath);
+
+    // So does one of a graph that changed after it was taken.
+    CHECK(SaveAndClose(documentPath, journalPath, true));
+    CHECK(AutosaveJournal::HasUnsavedChanges(journalPath));
+
+    std::filesystem::remove(journalPath);
+    std::filesystem::remove(documentPath);
+    Headless::DestroyContext();
+    return TestCheck::Result();
+}
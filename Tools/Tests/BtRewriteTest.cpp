@@ -0,0 +1,152 @@
+#include "Common/BtFiles.h"
+#include "TestCheck.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+// Runs bt-rewrite over a copy of the fixture graphs in Fixtures/BtRewrite. Checks that a dry run writes
+// nothing, and that a real run leaves files without renames byte for byte as they were, keeps the layout of
+// the rest, and that they read back with exactly the renamed values, escaped strings included.
+//
+// Usage: BtRewriteTest BT_REWRITE FIXTURES_DIR
+
+namespace
+{
+    // Changes made to the fixture graphs by Fixtures/BtRewrite/map.json, and the renames in it that match nothing.
+    constexpr size_t kExpectedChanges = 7;
+    constexpr size_t kExpectedChangedFiles = 2;
+    constexpr size_t kExpectedUnused = 1;
+
+    std::string Quote(const std::filesystem::path& path)
+    {
+        return '"' + path.string() + '"';
+    }
+
+    // Runs command and returns its exit status, or -1 if it couldn't be run.
+    int Run(const std::string& command)
+    {
+#ifdef _WIN32
+        // cmd.exe drops the first and last quote of a command that starts with one.
+        return std::system(('"' + command + '"').c_str());
+#else
+        int status = std::system(command.c_str());
+        return status != -1 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+    }
+
+    std::string Read(const std::filesystem::path& path)
+    {
+        std::string text;
+        std::string error;
+        if (!CHECK(BtFiles::Read(path, text, &error)))
+            std::fprintf(stderr, "  %s: %s\n", path.generic_string().c_str(), error.c_str());
+        return text;
+    }
+
+    // The graph with every renamed value changed, each once, as bt-rewrite should leave it.
+    nlohmann::json ApplyRenames(nlohmann::json graph, const nlohmann::json& map)
+    {
+        for (auto& node : graph["nodes"]) {
+            if (!node.contains("values"))
+                continue;
+            for (auto& [pin, value] : node["values"].items()) {
+                auto key = node["type"].get<std::string>() + '.' + pin;
+                if (value.is_string() && map.contains(key) && map[key].contains(value.get<std::string>()))
+                    value = map[key][value.get<std::string>()];
+            }
+        }
+        return graph;
+    }
+
+    // The fixture graphs, relative to the graphs directory.
+    std::vector<std::filesystem::path> ListGraphs(const std::filesystem::path& root)
+    {
+        std::vector<std::filesystem::path> graphs;
+        for (auto& entry : std::filesystem::recursive_directory_iterator{ root }) {
+            if (entry.is_regular_file() && entry.path().extension() == ".bt")
+                graphs.push_back(entry.path().lexically_relative(root));
+        }
+        std::sort(graphs.begin(), graphs.end());
+        return graphs;
+    }
+
+    nlohmann::json ReadSummary(const std::filesystem::path& reportPath)
+    {
+        auto report = nlohmann::json::parse(Read(reportPath), nullptr, false);
+        if (!CHECK(report.is_object() && report["summary"].is_object()))
+            return nlohmann::json::object();
+        return report["summary"];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: BtRewriteTest BT_REWRITE FIXTURES_DIR\n");
+        return 2;
+    }
+
+    std::filesystem::path tool = argv[1];
+    std::filesystem::path fixtures = argv[2];
+    auto sourceGraphs = fixtures / "graphs";
+    auto mapPath = fixtures / "map.json";
+    auto work = std::filesystem::temp_directory_path() / "BtRewriteTest";
+    auto graphs = work / "graphs";
+    auto reportPath = work / "report.json";
+
+    std::filesystem::remove_all(work);
+    std::filesystem::create_directories(work);
+    std::filesystem::copy(sourceGraphs, graphs, std::filesystem::copy_options::recursive);
+    auto map = nlohmann::json::parse(Read(mapPath));
+    auto files = ListGraphs(sourceGraphs);
+    CHECK(files.size() == 3);
+
+    auto command = Quote(tool) + " --quiet --map " + Quote(mapPath) + " -o " + Quote(reportPath) + ' ' + Quote(graphs);
+
+    // A dry run reports the changes without making them.
+    CHECK(Run(command + " --dry-run") == 0);
+    auto summary = ReadSummary(reportPath);
+    CHECK(summary.value("changes", size_t{ 0 }) == kExpectedChanges);
+    for (auto& file : files)
+        CHECK(Read(graphs / file) == Read(sourceGraphs / file));
+
+    CHECK(Run(command) == 0);
+    summary = ReadSummary(reportPath);
+    CHECK(summary.value("changes", size_t{ 0 }) == kExpectedChanges);
+    CHECK(summary.value("changedFiles", size_t{ 0 }) == kExpectedChangedFiles);
+    CHECK(summary.value("failedFiles", size_t{ 1 }) == 0);
+    CHECK(summary.value("unusedRenames", size_t{ 0 }) == kExpectedUnused);
+
+    size_t changedFiles = 0;
+    for (auto& file : files) {
+        auto before = Read(sourceGraphs / file);
+        auto after = Read(graphs / file);
+        auto original = nlohmann::json::parse(before);
+        auto expected = ApplyRenames(original, map);
+
+        if (expected == original) {
+            if (!CHECK(after == before))
+                std::fprintf(stderr, "  %s changed without any renames\n", file.generic_string().c_str());
+            continue;
+        }
+
+        changedFiles++;
+        auto reread = nlohmann::json::parse(after, nullptr, false);
+        if (!CHECK(reread == expected))
+            std::fprintf(stderr, "  %s reads back as %s\n", file.generic_string().c_str(), reread.dump().c_str());
+        // Renamed values are written escaped, so the lines and their endings stay as they were.
+        CHECK(std::count(after.begin(), after.end(), '\n') == std::count(before.begin(), before.end(), '\n'));
+        CHECK(std::count(after.begin(), after.end(), '\r') == std::count(before.begin(), before.end(), '\r'));
+    }
+    CHECK(changedFiles == kExpectedChangedFiles);
+
+    std::filesystem::remove_all(work);
+    return TestCheck::Result();
+}
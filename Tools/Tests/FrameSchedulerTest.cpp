@@ -0,0 +1,160 @@
+#include "BlendSpaceEditor/FrameScheduler.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <vector>
+
+// Runs FrameScheduler against a fake clock, as the main loop would: wait for as long as it says, render when
+// it says to, and stop where it would block until the next OS event.
+
+namespace
+{
+    constexpr double kTail = 0.5;
+    constexpr double kInterval = 1.0 / 60.0;
+    // Slack for the rounding in adding up frame intervals.
+    constexpr double kEpsilon = 1e-9;
+
+    struct FakeClock : FrameScheduler::Clock
+    {
+        double now = 100.0;
+
+        double Now() const override { return now; }
+    };
+
+    // Times of the frames rendered until the scheduler goes idle or the clock reaches until.
+    std::vector<double> RunLoop(FrameScheduler& scheduler, FakeClock& clock, double until)
+    {
+        std::vector<double> frames;
+        // Bounds the loop should the scheduler never go idle or stop asking for frames.
+        for (int i = 0; i < 100000 && clock.now < until; i++) {
+            double timeout = scheduler.GetWaitTimeout();
+            if (timeout < 0.0)
+                break;
+
+            clock.now = std::min(clock.now + timeout, until);
+            if (scheduler.ShouldRender()) {
+                scheduler.OnFrameRendered();
+                frames.push_back(clock.now);
+            }
+        }
+        return frames;
+    }
+
+    bool IsCapped(const std::vector<double>& frames)
+    {
+        for (size_t i = 1; i < frames.size(); i++) {
+            if (frames[i] - frames[i - 1] < kInterval - kEpsilon)
+                return false;
+        }
+        return true;
+    }
+
+    void TestStartupAndIdle()
+    {
+        FakeClock clock;
+        FrameScheduler scheduler{ clock, kTail, kInterval };
+        double start = clock.now;
+
+        // The first frame is drawn straight away, and frames keep coming for the tail.
+        CHECK(scheduler.ShouldRender());
+        auto frames = RunLoop(scheduler, clock, start + 10.0);
+        CHECK(!frames.empty() && frames.front() == start);
+        CHECK(!frames.empty() && frames.back() >= start + kTail && frames.back() < start + kTail + kInterval + kEpsilon);
+        CHECK(IsCapped(frames));
+
+        // Then nothing is scheduled, however long the loop waits.
+        CHECK(scheduler.GetWaitTimeout() < 0.0);
+        clock.now += 100.0;
+        CHECK(scheduler.GetWaitTimeout() < 0.0);
+        CHECK(!scheduler.ShouldRender());
+    }
+
+    void TestInputTail()
+    {
+        FakeClock clock;
+        FrameScheduler scheduler{ clock, kTail, kInterval };
+        RunLoop(scheduler, clock, clock.now + 10.0);
+        clock.now += 5.0;
+
+        // Input after a long idle stretch is drawn at once, then frames continue for the tail after it.
+        double input = clock.now;
+        scheduler.NotifyActivity();
+        CHECK(scheduler.ShouldRender());
+        auto frames = RunLoop(scheduler, clock, input + 10.0);
+        CHECK(!frames.empty() && frames.front() == input);
+        CHECK(!frames.empty() && frames.back() >= input + kTail && frames.back() < input + kTail + kInterval + kEpsilon);
+        CHECK(scheduler.GetWaitTimeout() < 0.0);
+
+        // Input during the tail extends it from the latest input.
+        clock.now += 1.0;
+        scheduler.NotifyActivity();
+        RunLoop(scheduler, clock, clock.now + 0.3);
+        double lateInput = clock.now;
+        scheduler.NotifyActivity();
+        frames = RunLoop(scheduler, clock, lateInput + 10.0);
+        CHECK(!frames.empty() && frames.back() >= lateInput + kTail);
+    }
+
+    void TestFrameCap()
+    {
+        FakeClock clock;
+        FrameScheduler scheduler{ clock, kTail, kInterval };
+        scheduler.SetContinuous(true);
+
+        scheduler.OnFrameRendered();
+        double rendered = clock.now;
+        clock.now += kInterval / 4.0;
+        CHECK(!scheduler.ShouldRender());
+        double timeout = scheduler.GetWaitTimeout();
+        CHECK(timeout > 0.0 && timeout <= kInterval);
+        CHECK(rendered + kInterval - clock.now - timeout < kEpsilon);
+
+        // However often the loop asks, frames come no faster than the cap, and no slower while there's work.
+        auto frames = RunLoop(scheduler, clock, clock.now + 1.0);
+        CHECK(IsCapped(frames));
+        CHECK(frames.size() >= 59 && frames.size() <= 61);
+    }
+
+    void TestPendingWork()
+    {
+        FakeClock clock;
+        FrameScheduler scheduler{ clock, kTail, kInterval };
+        RunLoop(scheduler, clock, clock.now + 10.0);
+        clock.now += 5.0;
+
+        // Continuous work keeps frames coming long after the tail.
+        double start = clock.now;
+        scheduler.SetContinuous(true);
+        CHECK(scheduler.ShouldRender());
+        auto frames = RunLoop(scheduler, clock, start + 5.0);
+        CHECK(frames.size() >= 299 && frames.size() <= 301);
+        CHECK(scheduler.GetWaitTimeout() >= 0.0);
+
+        // Once it finishes, the loop goes idle without owing a frame.
+        scheduler.SetContinuous(false);
+        CHECK(scheduler.GetWaitTimeout() < 0.0);
+
+        // Requested frames are drawn for as long as asked.
+        double request = clock.now;
+        scheduler.RequestFrames(2.0);
+        frames = RunLoop(scheduler, clock, request + 10.0);
+        CHECK(!frames.empty() && frames.back() >= request + 2.0 && frames.back() < request + 2.0 + kInterval + kEpsilon);
+        CHECK(IsCapped(frames));
+        CHECK(scheduler.GetWaitTimeout() < 0.0);
+
+        // A shorter request doesn't cut a longer one short.
+        request = clock.now;
+        scheduler.RequestFrames(2.0);
+        scheduler.RequestFrames(0.1);
+        frames = RunLoop(scheduler, clock, request + 10.0);
+        CHECK(!frames.empty() && frames.back() >= request + 2.0);
+    }
+}
+
+int main()
+{
+    TestStartupAndIdle();
+    TestInputTail();
+    TestFrameCap();
+    TestPendingWork();
+    return TestCheck::Result();
+}
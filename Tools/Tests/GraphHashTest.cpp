@@ -0,0 +1,188 @@
+#include "BlendSpaceEditor/GraphHash.h"
+#include "Common/BtFiles.h"
+#include "Common/SyntheticGraph.h"
+#include "TestCheck.h"
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+// Deduplicates graphs with repeated sub-trees and checks that the copies are merged and their consumers
+// relinked, and that nodes differing in any value are kept. Then runs bt-diff on a generated graph and its
+// re-serialization, which Deduplicate leaves as it is, and checks that it reports no changes.
+//
+// Usage: GraphHashTest BT_DIFF
+
+namespace
+{
+    std::string Quote(const std::filesystem::path& path)
+    {
+        return '"' + path.string() + '"';
+    }
+
+    // Runs command and returns its exit status, or -1 if it couldn't be run.
+    int Run(const std::string& command)
+    {
+#ifdef _WIN32
+        // cmd.exe drops the first and last quote of a command that starts with one.
+        return std::system(('"' + command + '"').c_str());
+#else
+        int status = std::system(command.c_str());
+        return status != -1 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+    }
+
+    GraphFile::Graph Parse(nlohmann::json document)
+    {
+        GraphFile::Graph graph;
+        GraphFile::Parse(document, graph);
+        return graph;
+    }
+
+    nlohmann::json Serialize(const GraphFile::Graph& graph)
+    {
+        nlohmann::json document;
+        GraphFile::Serialize(graph, document);
+        return document;
+    }
+
+    // The node that input of node reads from, or null if it isn't linked to one in document.
+    const nlohmann::json* FindSource(const nlohmann::json& document, const nlohmann::json& node, const char* input)
+    {
+        if (!node.contains("inputs") || !node["inputs"].contains(input))
+            return nullptr;
+        auto& source = node["inputs"][input];
+        for (auto& other : document["nodes"]) {
+            if (other["id"] == source[0] && source[1] == "output")
+                return &other;
+        }
+        return nullptr;
+    }
+
+    size_t CountType(const nlohmann::json& document, const char* type)
+    {
+        size_t count = 0;
+        for (auto& node : document["nodes"])
+            count += node["type"] == type;
+        return count;
+    }
+
+    void TestMergesIdenticalSubtrees()
+    {
+        // Two blends of the same two animations, one with its inputs swapped, blended together.
+        auto graph = Parse(nlohmann::json::parse(R"({ "version": 1, "nodes": [
+            { "id": 1, "pos": [0, 0], "type": "anim", "values": { "file": "walk.glb", "syncId": 1 } },
+            { "id": 2, "pos": [0, 0], "type": "anim", "values": { "file": "walk.glb", "syncId": 1 } },
+            { "id": 3, "pos": [0, 0], "type": "blend_1d", "inputs": { "1": [1, "output"], "2": [2, "output"] } },
+            { "id": 4, "pos": [0, 0], "type": "blend_1d", "inputs": { "1": [2, "output"], "2": [1, "output"] } },
+            { "id": 5, "pos": [0, 0], "type": "blend_1d", "inputs": { "1": [3, "output"], "2": [4, "output"] } },
+            { "id": 6, "pos": [0, 0], "type": "actor", "inputs": { "input": [5, "output"] } }
+        ] })"));
+
+        // The second animation and the second blend go, and everything that read them reads the first.
+        CHECK(GraphHash::Deduplicate(graph) == 2);
+        CHECK(graph.nodes.size() == 4);
+        CHECK(graph.positions.size() == graph.nodes.size());
+
+        auto document = Serialize(graph);
+        CHECK(CountType(document, "anim") == 1);
+        CHECK(CountType(document, "blend_1d") == 2);
+        const nlohmann::json* actor = nullptr;
+        for (auto& node : document["nodes"]) {
+            if (node["type"] == "actor")
+                actor = &node;
+        }
+        if (!CHECK(actor))
+            return;
+        auto outer = FindSource(document, *actor, "input");
+        if (!CHECK(outer && (*outer)["type"] == "blend_1d"))
+            return;
+        auto blend = FindSource(document, *outer, "1");
+        if (!CHECK(blend && blend != outer && blend == FindSource(document, *outer, "2")))
+            return;
+        auto anim = FindSource(document, *blend, "1");
+        CHECK(anim && (*anim)["type"] == "anim" && anim == FindSource(document, *blend, "2"));
+
+        // What's left reads back and has nothing more to merge.
+        auto reread = Parse(document);
+        CHECK(reread.nodes.size() == 4);
+        CHECK(GraphHash::Deduplicate(reread) == 0);
+    }
+
+    void TestKeepsDifferentValues()
+    {
+        // The same animation file under another sync ID, and another file under the same one.
+        auto graph = Parse(nlohmann::json::parse(R"({ "version": 1, "nodes": [
+            { "id": 1, "pos": [0, 0], "type": "anim", "values": { "file": "walk.glb", "syncId": 1 } },
+            { "id": 2, "pos": [0, 0], "type": "anim", "values": { "file": "walk.glb", "syncId": 2 } },
+            { "id": 3, "pos": [0, 0], "type": "anim", "values": { "file": "run.glb", "syncId": 1 } },
+            { "id": 4, "pos": [0, 0], "type": "blend_1d", "inputs": { "1": [1, "output"], "2": [2, "output"] } },
+            { "id": 5, "pos": [0, 0], "type": "blend_1d", "inputs": { "1": [1, "output"], "2": [3, "output"] } },
+            { "id": 6, "pos": [0, 0], "type": "blend_1d", "inputs": { "1": [4, "output"], "2": [5, "output"] } },
+            { "id": 7, "pos": [0, 0], "type": "actor", "inputs": { "input": [6, "output"] } }
+        ] })"));
+
+        CHECK(GraphHash::Deduplicate(graph) == 0);
+        CHECK(graph.nodes.size() == 7);
+    }
+
+    bool Write(const std::filesystem::path& path, const nlohmann::json& document)
+    {
+        std::ofstream file{ path };
+        file << document.dump(4) << '\n';
+        return CHECK(file.good());
+    }
+
+    void TestDiffOfReserialization(const std::filesystem::path& tool)
+    {
+        auto work = std::filesystem::temp_directory_path() / "GraphHashTest";
+        auto beforePath = work / "before.bt";
+        auto afterPath = work / "after.bt";
+        auto reportPath = work / "report.json";
+        std::filesystem::remove_all(work);
+        std::filesystem::create_directories(work);
+
+        // A generated graph has no repeated sub-trees, so it's written back with only its IDs and layout changed.
+        SyntheticGraph::Options options;
+        options.nodeCount = 2000;
+        auto before = SyntheticGraph::Generate(options);
+        auto graph = Parse(before);
+        CHECK(GraphHash::Deduplicate(graph) == 0);
+        auto after = Serialize(graph);
+        if (!Write(beforePath, before) || !Write(afterPath, after))
+            return;
+
+        CHECK(Run(Quote(tool) + ' ' + Quote(beforePath) + ' ' + Quote(afterPath) + " --json " + Quote(reportPath)) == 0);
+        std::string text;
+        CHECK(BtFiles::Read(reportPath, text));
+        auto report = nlohmann::json::parse(text, nullptr, false);
+        if (!CHECK(report.is_object() && report["summary"].is_object()))
+            return;
+        auto& summary = report["summary"];
+        CHECK(summary.value("unchanged", size_t{ 0 }) == graph.nodes.size());
+        CHECK(summary.value("changedBelow", size_t{ 1 }) == 0);
+        CHECK(summary.value("changed", size_t{ 1 }) == 0);
+        CHECK(summary.value("removed", size_t{ 1 }) == 0);
+        CHECK(summary.value("added", size_t{ 1 }) == 0);
+
+        std::filesystem::remove_all(work);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: GraphHashTest BT_DIFF\n");
+        return 2;
+    }
+
+    TestMergesIdenticalSubtrees();
+    TestKeepsDifferentValues();
+    TestDiffOfReserialization(argv[1]);
+    return TestCheck::Result();
+}
@@ -0,0 +1,84 @@
+#include "BlendSpaceEditor/Editor.h"
+#include "BlendSpaceEditor/GraphFile.h"
+#include "Common/GraphLint.h"
+#include "Common/Headless.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Lints graphs as the editor saves them, unlinked inputs and all, and checks that each is reported for
+// exactly what is wrong with it and nothing else.
+
+namespace
+{
+    std::vector<GraphLint::Diagnostic> LintSaved(Editor& editor)
+    {
+        nlohmann::json doc;
+        ed::SetCurrentEditor(editor.m_Editor);
+        GraphFile::Save(editor, doc);
+        ed::SetCurrentEditor(nullptr);
+        return GraphLint::Check(doc);
+    }
+
+    // The codes of the errors among diagnostics, printing any that weren't expected.
+    std::vector<std::string> GetErrors(const std::vector<GraphLint::Diagnostic>& diagnostics, const std::vector<std::string>& expected)
+    {
+        std::vector<std::string> errors;
+        for (auto& diagnostic : diagnostics) {
+            if (diagnostic.severity != GraphLint::Severity::Error)
+                continue;
+            errors.push_back(diagnostic.code);
+            if (std::find(expected.begin(), expected.end(), diagnostic.code) == expected.end())
+                std::fprintf(stderr, "  %s\n", GraphLint::ToJson(diagnostic).dump().c_str());
+        }
+        return errors;
+    }
+
+    void CheckErrors(Editor& editor, const std::vector<std::string>& expected)
+    {
+        CHECK(GetErrors(LintSaved(editor), expected) == expected);
+    }
+
+    Link* LinkAnimToActor(Editor& editor)
+    {
+        Pin* output = nullptr;
+        Pin* input = nullptr;
+        for (auto& node : editor.m_Nodes) {
+            if (node.def == NodeDefinitions::FindDef("anim"))
+                output = &node.outputs.front();
+            else if (node.def == NodeDefinitions::FindDef("actor"))
+                input = &node.inputs.front();
+        }
+        if (!CHECK(output && input && editor.CanCreateLink(output, input)))
+            return nullptr;
+        return editor.SpawnLink(output, input);
+    }
+}
+
+int main()
+{
+    Headless::CreateContext();
+    Editor editor;
+
+    // A new document saves its unlinked inputs as links to node 0. Only the actor's pose is an error.
+    editor.InitNew();
+    CheckErrors(editor, { "unconnected-pose" });
+
+    ed::SetCurrentEditor(editor.m_Editor);
+    auto link = LinkAnimToActor(editor);
+    ed::SetCurrentEditor(nullptr);
+    CheckErrors(editor, {});
+
+    // Unlinking writes the same as never having linked.
+    if (link) {
+        ed::SetCurrentEditor(editor.m_Editor);
+        editor.DestroyLink(link->id);
+        ed::SetCurrentEditor(nullptr);
+        CheckErrors(editor, { "unconnected-pose" });
+    }
+
+    Headless::DestroyContext();
+    return TestCheck::Result();
+}
@@ -0,0 +1,177 @@
+#include "BlendSpaceEditor/SearchIndex.h"
+#include "BlendSpaceEditor/StringPool.h"
+#include "Common/Headless.h"
+#include "Common/SyntheticGraph.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Applies random spawns, deletes and string value edits to a graph, and after each batch checks that
+// SearchIndex finds exactly what a scan of every node's text finds.
+
+namespace
+{
+    constexpr size_t kNodeCount = 2000;
+    constexpr int kRounds = 300;
+    constexpr int kRoundsPerCheck = 5;
+    // As in SearchIndex: only this many words of each text can be found.
+    constexpr size_t kMaxWordsPerText = 16;
+
+    std::string ToLower(std::string_view text)
+    {
+        std::string lower{ text };
+        for (auto& c : lower) {
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+        }
+        return lower;
+    }
+
+    bool IsLetterOrDigit(char c)
+    {
+        auto byte = static_cast<unsigned char>(c);
+        return byte >= 0x80 || (byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z');
+    }
+
+    // Whether text has word, already lowercased, at its start or at the start of one of its first words.
+    bool TextMatches(std::string_view text, std::string_view word)
+    {
+        auto lower = ToLower(text);
+        size_t words = 0;
+        for (size_t i = 0; i < text.size() && words < kMaxWordsPerText; i++) {
+            bool camelCase = i > 0 && text[i] >= 'A' && text[i] <= 'Z' && text[i - 1] >= 'a' && text[i - 1] <= 'z';
+            if (i > 0 && !(IsLetterOrDigit(text[i]) && (!IsLetterOrDigit(text[i - 1]) || camelCase)))
+                continue;
+            words++;
+            if (std::string_view{ lower }.substr(i).starts_with(word))
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<ed::NodeId> FindByScan(const Editor& editor, std::string_view query)
+    {
+        std::vector<std::string> words;
+        for (size_t start = 0; start < query.size();) {
+            size_t end = std::min(query.find_first_of(" \t", start), query.size());
+            if (end > start)
+                words.push_back(ToLower(query.substr(start, end - start)));
+            start = end + 1;
+        }
+
+        std::vector<ed::NodeId> results;
+        if (words.empty())
+            return results;
+
+        for (auto& node : editor.m_Nodes) {
+            bool matchesAll = std::all_of(words.begin(), words.end(), [&](const std::string& word) {
+                if (TextMatches(node.def->typeName, word) || TextMatches(node.def->name, word))
+                    return true;
+                return std::any_of(node.inputs.begin(), node.inputs.end(), [&](const Pin& input) {
+                    return input.type == PinType::CustomString && TextMatches(std::get<NodeStringCustomValueConnection>(input.connected).value, word);
+                });
+            });
+            if (matchesAll)
+                results.push_back(node.id);
+        }
+        std::sort(results.begin(), results.end(), NodeIdLess{});
+        return results;
+    }
+
+    // A query made of a piece of some node's text, so most queries find something.
+    std::string RandomQuery(const Editor& editor, std::mt19937& random)
+    {
+        if (editor.m_Nodes.empty())
+            return "anim";
+
+        auto& node = editor.m_Nodes[random() % editor.m_Nodes.size()];
+        std::string_view text = node.def->name;
+        for (auto& input : node.inputs) {
+            if (input.type == PinType::CustomString && random() % 2)
+                text = std::get<NodeStringCustomValueConnection>(input.connected).value;
+        }
+        if (text.empty())
+            return std::string{ node.def->typeName };
+
+        size_t start = random() % text.size();
+        return std::string{ text.substr(start, 1 + random() % 6) };
+    }
+
+    void CheckQuery(SearchIndex& index, const Editor& editor, std::string_view query, std::vector<ed::NodeId>& results)
+    {
+        index.Find(query, results);
+        if (!CHECK(results == FindByScan(editor, query)))
+            std::fprintf(stderr, "  query \"%.*s\"\n", static_cast<int>(query.size()), query.data());
+    }
+}
+
+int main()
+{
+    Headless::CreateContext();
+    Editor editor;
+    ed::SetCurrentEditor(editor.m_Editor);
+    SyntheticGraph::Options options;
+    options.nodeCount = kNodeCount;
+    auto document = SyntheticGraph::Generate(options);
+    GraphFile::Load(editor, document);
+
+    SearchIndex index{ editor };
+    std::vector<ed::NodeId> results;
+    const char* fixedQueries[] = { "anim", "ANIM", "full anim", "glb", "bone_2", "runfast", "fast_1", "Run F", "zzz", "a", "" };
+    for (auto query : fixedQueries)
+        CheckQuery(index, editor, query, results);
+
+    std::mt19937 random{ 7 };
+    auto defs = NodeDefinitions::GetDefs();
+    for (int round = 0; round < kRounds; round++) {
+        switch (random() % 4) {
+        case 0:
+            editor.SpawnNode(&defs[random() % defs.size()], ImVec2(0.0f, 0.0f));
+            break;
+        case 1:
+        {
+            std::vector<ed::NodeId> ids;
+            for (size_t i = random() % 40 + 1; i > 0 && !editor.m_Nodes.empty(); i--)
+                ids.push_back(editor.m_Nodes[random() % editor.m_Nodes.size()].id);
+            std::sort(ids.begin(), ids.end(), NodeIdLess{});
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            editor.DeleteNodes(ids);
+            break;
+        }
+        default:
+        {
+            // Every string value of a random node. One edited again before the next check still has its old keys
+            // removed only once.
+            auto& node = editor.m_Nodes[random() % editor.m_Nodes.size()];
+            for (auto& input : node.inputs) {
+                if (input.type != PinType::CustomString)
+                    continue;
+                auto value = input.connected;
+                auto text = (random() % 2 ? "Anims/RunFast_" : "bone_zz ") + std::to_string(random() % 100);
+                std::get<NodeStringCustomValueConnection>(value).value = StringPool::Get().Intern(text);
+                editor.SetPinValue(input, value);
+            }
+            break;
+        }
+        }
+
+        if (round % kRoundsPerCheck == 0) {
+            for (auto query : fixedQueries)
+                CheckQuery(index, editor, query, results);
+            for (int i = 0; i < 10; i++)
+                CheckQuery(index, editor, RandomQuery(editor, random), results);
+        }
+    }
+
+    // Replacing the graph rebuilds the index.
+    editor.InitNew();
+    for (auto query : fixedQueries)
+        CheckQuery(index, editor, query, results);
+
+    ed::SetCurrentEditor(nullptr);
+    Headless::DestroyContext();
+    return TestCheck::Result();
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdio>
+
+// Checks for the test executables that CTest runs. A failed CHECK prints its file, line and condition and
+// the test carries on, so one run reports every failure; main returns TestCheck::Result().
+namespace TestCheck
+{
+    inline int failures = 0;
+
+    inline bool Report(bool passed, const char* file, int line, const char* condition)
+    {
+        if (!passed) {
+            failures++;
+            std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, condition);
+        }
+        return passed;
+    }
+
+    inline int Result()
+    {
+        if (failures)
+            std::fprintf(stderr, "%d checks failed.\n", failures);
+        return failures ? 1 : 0;
+    }
+}
+
+// Evaluates to whether condition held, so a test can skip what depends on it.
+#define CHECK(condition) TestCheck::Report(static_cast<bool>(condition), __FILE__, __LINE__, #condition)
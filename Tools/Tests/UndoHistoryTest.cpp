@@ -0,0 +1,184 @@
+#include "BlendSpaceEditor/UndoHistory.h"
+#include "BlendSpaceEditor/GraphFile.h"
+#include "Common/Headless.h"
+#include "Common/SyntheticGraph.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Pastes a large selection, undoes and redoes it and compares the saved document with what it was before
+// and after. Then checks that continued edits of a value undo as one step, and that the oldest steps are
+// dropped to stay within the memory budget.
+
+namespace
+{
+    constexpr size_t kNodeCount = 1000;
+
+    // The document as the editor would save it.
+    std::string Save(Editor& editor)
+    {
+        nlohmann::json doc;
+        ed::SetCurrentEditor(editor.m_Editor);
+        GraphFile::Save(editor, doc);
+        ed::SetCurrentEditor(nullptr);
+        return doc.dump();
+    }
+
+    void Load(Editor& editor, size_t nodeCount)
+    {
+        SyntheticGraph::Options options;
+        options.nodeCount = nodeCount;
+        auto document = SyntheticGraph::Generate(options);
+        ed::SetCurrentEditor(editor.m_Editor);
+        GraphFile::Load(editor, document);
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    void TestPasteUndoRedo()
+    {
+        Editor editor;
+        Load(editor, kNodeCount);
+        UndoHistory history{ editor };
+        auto before = Save(editor);
+
+        // Every node and the links between them, pasted below the original in one frame.
+        std::vector<ed::NodeId> ids;
+        for (auto& node : editor.m_Nodes)
+            ids.push_back(node.id);
+        GraphFile::Graph clipboard;
+        ed::SetCurrentEditor(editor.m_Editor);
+        editor.CopyNodes(ids, clipboard);
+        editor.PasteNodes(clipboard, ImVec2(0.0f, 100000.0f));
+        ed::SetCurrentEditor(nullptr);
+        history.CommitStep();
+
+        auto pasted = Save(editor);
+        CHECK(editor.m_Nodes.size() == 2 * kNodeCount);
+        CHECK(pasted != before);
+
+        CHECK(history.CanUndo());
+        history.Undo();
+        CHECK(editor.m_Nodes.size() == kNodeCount);
+        CHECK(Save(editor) == before);
+
+        CHECK(history.CanRedo());
+        history.Redo();
+        CHECK(Save(editor) == pasted);
+
+        // Twice over, since undone steps are moved between the stacks rather than copied.
+        history.Undo();
+        CHECK(Save(editor) == before);
+        history.Redo();
+        CHECK(Save(editor) == pasted);
+    }
+
+    void TestValueAndMoveSteps()
+    {
+        Editor editor;
+        Load(editor, 50);
+        UndoHistory history{ editor };
+        auto before = Save(editor);
+
+        Pin* pin = nullptr;
+        for (auto& node : editor.m_Nodes) {
+            for (auto& input : node.inputs) {
+                if (!pin && input.type == PinType::CustomFloat)
+                    pin = &input;
+            }
+        }
+        if (!CHECK(pin))
+            return;
+
+        // A drag of a value widget over several frames, reported as a value widget reports it.
+        for (int frame = 1; frame <= 5; frame++) {
+            auto previous = pin->connected;
+            std::get<NodeFloatCustomValueConnection>(pin->connected).value = static_cast<float>(frame);
+            history.OnValueChanged(*pin, previous, frame > 1);
+            history.CommitStep();
+        }
+        auto edited = Save(editor);
+
+        auto id = editor.m_Nodes.front().id;
+        ed::SetCurrentEditor(editor.m_Editor);
+        auto position = ed::GetNodePosition(id);
+        NodeMove move[] = { { id, position, ImVec2(position.x + 300.0f, position.y - 20.0f) } };
+        editor.MoveNodes(move);
+        ed::SetCurrentEditor(nullptr);
+        history.CommitStep();
+        auto moved = Save(editor);
+        CHECK(moved != edited);
+
+        history.Undo();
+        CHECK(Save(editor) == edited);
+        // The whole drag is one step.
+        history.Undo();
+        CHECK(Save(editor) == before);
+        CHECK(!history.CanUndo());
+
+        history.Redo();
+        CHECK(Save(editor) == edited);
+        history.Redo();
+        CHECK(Save(editor) == moved);
+    }
+
+    void TestMemoryBudget()
+    {
+        constexpr int kSteps = 20;
+        Editor editor;
+        UndoHistory history{ editor };
+
+        // Steps of the same size, a few nodes each.
+        ed::SetCurrentEditor(editor.m_Editor);
+        auto def = NodeDefinitions::FindDef("anim");
+        auto initialNodes = editor.m_Nodes.size();
+        std::vector<size_t> usage;
+        for (int step = 0; step < kSteps; step++) {
+            for (int i = 0; i < 4; i++)
+                editor.SpawnNode(def, ImVec2(static_cast<float>(step), static_cast<float>(i)));
+            history.CommitStep();
+            usage.push_back(history.GetMemoryUsage());
+        }
+        ed::SetCurrentEditor(nullptr);
+        size_t stepBytes = usage.front();
+        CHECK(stepBytes > 0 && usage.back() == stepBytes * kSteps);
+
+        // Room for five steps keeps the newest five.
+        size_t budget = stepBytes * 5 + stepBytes / 2;
+        history.SetMemoryBudget(budget);
+        CHECK(history.GetMemoryUsage() <= budget);
+        int undone = 0;
+        while (history.CanUndo()) {
+            history.Undo();
+            undone++;
+        }
+        CHECK(undone == 5);
+        CHECK(editor.m_Nodes.size() == initialNodes + (kSteps - 5) * 4);
+
+        // New steps keep to it as they're committed, and redo steps count too until a new step drops them.
+        ed::SetCurrentEditor(editor.m_Editor);
+        for (int step = 0; step < kSteps; step++) {
+            editor.SpawnNode(def, ImVec2(0.0f, 0.0f));
+            history.CommitStep();
+            CHECK(history.GetMemoryUsage() <= budget);
+        }
+        ed::SetCurrentEditor(nullptr);
+
+        // The newest step is kept even when it alone is over budget.
+        history.SetMemoryBudget(1);
+        CHECK(history.CanUndo());
+        history.Undo();
+        CHECK(!history.CanUndo());
+    }
+}
+
+int main()
+{
+    Headless::CreateContext();
+    TestPasteUndoRedo();
+    TestValueAndMoveSteps();
+    TestMemoryBudget();
+    Headless::DestroyContext();
+    return TestCheck::Result();
+}